@@ -30,6 +30,7 @@ private:
   void handle_connect_command(const std::string& connection_string);
   void handle_delete_command(const std::string& filename);
   void handle_help_command();
+  void handle_ciphers_command();
   void log_and_display_error(const std::string& message, const std::string& error);
 };
 
@@ -0,0 +1,71 @@
+#ifndef DFS_CRYPTO_CIPHER_BENCHMARK_HPP
+#define DFS_CRYPTO_CIPHER_BENCHMARK_HPP
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+#include "crypto_stream.hpp"
+
+namespace dfs::crypto {
+
+// Measured single-thread throughput of one cipher suite
+struct SuiteSpeed {
+  CryptoStream::Cipher cipher;
+  uint32_t megabytes_per_second;
+};
+
+// Short calibration run that measures how fast this machine seals records
+// with each authenticated cipher suite. Peers exchange their results in the
+// handshake and pick the shared suite whose slower end is fastest, so a node
+// without AES instructions settles on ChaCha20-Poly1305 while two nodes with
+// them keep AES-256-GCM.
+class CipherBenchmark {
+public:
+  // Suites measured and offered, CBC is never negotiated
+  static constexpr std::array<CryptoStream::Cipher, 2> SUITES = {
+    CryptoStream::Cipher::Aes256Gcm, CryptoStream::Cipher::ChaCha20Poly1305};
+  // Plaintext sealed per measured message, whole records so no short tail skews the result
+  static constexpr size_t SAMPLE_SIZE = 16 * CryptoStream::RECORD_SIZE;
+  // Time spent measuring each suite
+  static constexpr std::chrono::milliseconds DURATION{20};
+
+
+  // ---- CONSTRUCTOR ----
+  // Measures every suite for duration each, on the calling thread
+  explicit CipherBenchmark(std::chrono::milliseconds duration = DURATION);
+
+  // Results of this process, measured on first use
+  static const CipherBenchmark& shared();
+
+
+  // ---- GETTERS ----
+  // Suites that could be measured, in SUITES order
+  const std::vector<SuiteSpeed>& get_results() const { return results_; }
+  // Zero for a suite that was not measured
+  uint32_t get_throughput(CryptoStream::Cipher cipher) const;
+  static std::string get_name(CryptoStream::Cipher cipher);
+
+
+  // ---- SELECTION ----
+  // Suite offered by every participant whose slowest participant is fastest,
+  // ties going to the lower cipher id so every participant picks the same
+  // one. nullopt if no suite is offered by all
+  static std::optional<CryptoStream::Cipher> select(const std::vector<std::vector<SuiteSpeed>>& offers);
+
+private:
+  // ---- PARAMETERS ----
+  std::vector<SuiteSpeed> results_;
+
+
+  // ---- MEASUREMENT ----
+  // MB/s of one suite, zero if it is unavailable
+  static uint32_t measure(CryptoStream::Cipher cipher, std::chrono::milliseconds duration);
+};
+
+} // namespace dfs::crypto
+
+#endif // DFS_CRYPTO_CIPHER_BENCHMARK_HPP
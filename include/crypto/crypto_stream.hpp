@@ -2,10 +2,11 @@
 #define DFS_CRYPTO_STREAM_HPP
 
 #include <array>
-#include <functional>
+#include <cstdint>
 #include <istream>
 #include <memory>
 #include <ostream>
+#include <span>
 #include <vector>
 #include "crypto_error.hpp"
 
@@ -22,12 +23,48 @@ public:
     Decrypt
   };
 
+  // Cipher applied by encrypt() and decrypt()
+  enum class Cipher : uint8_t {
+    Aes256Cbc = 0,        // PKCS padded, unauthenticated
+    Aes256Gcm = 1,        // Authenticated records, see below
+    ChaCha20Poly1305 = 2  // Same records, fast without AES instructions
+  };
+
+  // True for the ciphers that seal records
+  static constexpr bool isAuthenticated(Cipher cipher) { return cipher != Cipher::Aes256Cbc; }
+
   static constexpr size_t KEY_SIZE = 32;     // 256 bits for AES-256
   static constexpr size_t IV_SIZE = 16;      // 128 bits for CBC mode
   static constexpr size_t BLOCK_SIZE = 16;   // AES block size
+  // GCM and ChaCha20-Poly1305 split a stream into records of RECORD_SIZE
+  // plaintext bytes, the last one shorter, each followed by its TAG_SIZE
+  // byte authentication tag.
+  // Record n is sealed under the first NONCE_SIZE bytes of the IV with n
+  // XORed into their last eight, and authenticates the associated data plus
+  // a byte marking the final record, so records can be checked one at a time
+  // and a stream cut at a record boundary is still detected. The record
+  // numbers of each direction continue across calls until initialize().
+  // Records are independent, so a batch of them is sealed or opened on the
+  // shared WorkerPool, one cipher context per record, and written in order
+  static constexpr size_t NONCE_SIZE = 12;
+  static constexpr size_t TAG_SIZE = 16;
+  static constexpr size_t RECORD_SIZE = 64 * 1024;
+  // Most GCM records processed in parallel by one stream
+  static constexpr size_t MAX_BATCH_RECORDS = 32;
+  // Keyed cipher contexts each thread keeps for later streams
+  static constexpr size_t POOL_CAPACITY = 16;
+
+  // Counters of the calling thread's context pool
+  struct ContextPoolStats {
+    uint64_t hits = 0;    // Contexts reused with their key schedule
+    uint64_t misses = 0;  // Contexts that had to be keyed
+    size_t pooled = 0;    // Contexts waiting in the pool
+  };
 
   // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  // Initializes OpenSSL on first use in the process
   CryptoStream();
+  // Returns the stream's keyed contexts to the destroying thread's pool
   ~CryptoStream();
 
   // Generate an initialization vector
@@ -39,13 +76,57 @@ public:
 
   
   // ---- ENCRYPTION/DECRYPTION OPERATIONS ----
+  // Process the whole input stream as one message through begin(), update()
+  // and finish(), restoring both stream positions afterwards
   std::ostream& encrypt(std::istream& input, std::ostream& output);
   std::ostream& decrypt(std::istream& input, std::ostream& output);
 
+
+  // ---- BUFFER OPERATIONS ----
+  // Process one whole message between caller-owned buffers without
+  // allocating, returning the bytes written. output needs
+  // getCiphertextSize(input.size()) bytes to encrypt and
+  // getPlaintextSize(input.size()) to decrypt, and must not overlap input.
+  // A failed decryption wipes output
+  size_t encrypt(std::span<const uint8_t> input, std::span<uint8_t> output);
+  size_t decrypt(std::span<const uint8_t> input, std::span<uint8_t> output);
+  // Same within one buffer. encryptInPlace takes length plaintext bytes at
+  // the front of a buffer with room for their ciphertext, decryptInPlace a
+  // buffer holding exactly one ciphertext
+  size_t encryptInPlace(std::span<uint8_t> buffer, size_t length);
+  size_t decryptInPlace(std::span<uint8_t> buffer);
+
+
+  // ---- INCREMENTAL OPERATIONS ----
+  // Process a message that arrives in pieces: begin() starts it, update()
+  // takes the next piece and writes at most getUpdateSize() bytes, finish()
+  // writes the remainder, at most getFinishSize() bytes. GCM holds back up to
+  // one record until it knows whether more input follows. An error ends the
+  // message
+  void begin(Mode mode);
+  size_t update(std::span<const uint8_t> input, std::span<uint8_t> output);
+  size_t finish(std::span<uint8_t> output);
+
   
   // ---- GETTERS/SETTERS ----
   void setMode(Mode mode) { mode_ = mode; }
   Mode getMode() const { return mode_; }
+  void setCipher(Cipher cipher) { cipher_ = cipher; }
+  Cipher getCipher() const { return cipher_; }
+  // Data GCM records authenticate without encrypting, e.g. a frame header
+  void setAssociatedData(const std::vector<uint8_t>& data) { associated_data_ = data; }
+  // Size of the ciphertext encrypt() writes for plaintext_size bytes
+  size_t getCiphertextSize(size_t plaintext_size) const;
+  // Largest plaintext decrypt() writes for ciphertext_size bytes, exact for GCM
+  size_t getPlaintextSize(size_t ciphertext_size) const;
+  // Most bytes the next update() of input_size bytes, or finish(), writes
+  size_t getUpdateSize(size_t input_size) const;
+  size_t getFinishSize() const;
+  // Threads sharing the GCM records of one stream, zero means one per
+  // hardware thread and one disables parallel processing
+  void setThreads(size_t threads) { threads_ = threads; }
+  size_t getThreads() const { return threads_; }
+  static ContextPoolStats getContextPoolStats();
 
 private:
   // ---- PARAMETERS ----
@@ -54,23 +135,38 @@ private:
   std::unique_ptr<CipherContext> context_;
   bool is_initialized_ = false;
   Mode mode_ = Mode::Encrypt;  // Default to encryption mode
-  std::istream* pending_input_ = nullptr;  
+  Cipher cipher_ = Cipher::Aes256Cbc;
+  std::vector<uint8_t> associated_data_;
+  // Next GCM record number of each direction
+  uint64_t encrypt_records_ = 0;
+  uint64_t decrypt_records_ = 0;
+  size_t threads_ = 0;
+  // Contexts of the records of a batch after the first, which uses context_
+  std::vector<std::unique_ptr<CipherContext>> batch_contexts_;
+  // Message in progress between begin() and finish()
+  bool in_message_ = false;
+  bool message_encrypting_ = true;
+  // GCM record held back by update(), allocated on the first begin()
+  std::vector<uint8_t> pending_;
+  size_t pending_length_ = 0;
   static constexpr size_t BUFFER_SIZE = 8192; 
 
   
   // ---- INITIALIZATION ----  
   // Initializes cipher context
   void initializeCipher(bool encrypting);
+  // Makes context one keyed for the current cipher, key and direction,
+  // taking it from the thread's pool and running the key schedule on a miss
+  void prepareContext(std::unique_ptr<CipherContext>& context, bool encrypting);
 
 
   // ---- STREAM PROCESSING - ENCRYPTION/DECRYPTION ----
-  // Process data through OpenSSL cipher context
+  // Process data through OpenSSL cipher context, restoring stream positions afterwards
   void processStream(std::istream& input, std::ostream& output, bool encrypting);
-  // Manages stream positions and handles automatic position restoration on errors
-  void saveStreamPos(std::istream& input, std::ostream& output, 
-                                   const std::function<void()>& operation);
-  // Performs the main encryption/decryption loop on the input stream
-  void processStreamData(std::istream& input, std::ostream& output, bool encrypting);
+  // Feeds the input stream through update() and finish() in chunks
+  void pumpStream(std::istream& input, std::ostream& output);
+  void restoreStreamPos(std::istream& input, std::ostream& output,
+                        std::streampos input_pos, std::streampos output_pos);
   // Encrypts or decrypts a single block of data using the configured cipher
   size_t processDataBlock(const uint8_t* inbuf, size_t bytes_read, uint8_t* outbuf, 
                         bool encrypting);
@@ -78,6 +174,29 @@ private:
   void writeOutputBlock(std::ostream& output, const uint8_t* data, size_t length);
   // Handles the final block with padding in encryption/decryption operations
   void processFinalBlock(uint8_t* outbuf, int& outlen, bool encrypting);
+  [[noreturn]] static void throwBufferTooSmall(bool encrypting);
+
+
+  // ---- STREAM PROCESSING - AUTHENTICATED RECORDS ----
+  // Processes consecutive GCM records in parallel batches, returning the
+  // bytes written. Record i is read from input + i * in_stride, after an
+  // optional full head record, and written to output + i * out_stride. last
+  // marks the final record of the message, without it length must be whole
+  // records
+  size_t processRecordRange(const uint8_t* head, const uint8_t* input, size_t length, size_t in_stride,
+                            uint8_t* output, size_t out_stride, bool encrypting, bool last);
+  // Records processed at once, at most MAX_BATCH_RECORDS
+  size_t batchSize() const;
+  // Seals one record and appends its tag, returns the bytes written to outbuf
+  size_t sealRecord(CipherContext& context, uint64_t record, const uint8_t* inbuf, size_t length,
+                    uint8_t* outbuf, bool final);
+  // Verifies and decrypts one record with its trailing tag, returns the plaintext length
+  size_t openRecord(CipherContext& context, uint64_t record, const uint8_t* inbuf, size_t length,
+                    uint8_t* outbuf, bool final);
+  // Nonce of a record number
+  std::array<uint8_t, NONCE_SIZE> recordNonce(uint64_t record) const;
+  // Authenticates the associated data of a record, the final flag last
+  bool addRecordAad(CipherContext& context, bool final) const;
 };
   
 } // namespace dfs::crypto
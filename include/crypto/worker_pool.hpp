@@ -0,0 +1,58 @@
+#ifndef DFS_CRYPTO_WORKER_POOL_HPP
+#define DFS_CRYPTO_WORKER_POOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dfs::crypto {
+
+// Fixed set of threads that run the independent records of a cipher stream
+// in parallel. The calling thread works on its own job too, so a job always
+// finishes even while every worker is busy with other streams' jobs.
+class WorkerPool {
+public:
+  // Delete copy operations, the pool owns its threads
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  explicit WorkerPool(size_t threads);
+  // Lets queued jobs finish, then joins the workers
+  ~WorkerPool();
+
+  // Pool shared by every CryptoStream, one worker per hardware thread
+  static WorkerPool& shared();
+
+
+  // ---- EXECUTION ----
+  // Runs task(0) to task(count - 1) across the workers and the calling
+  // thread and returns when all have finished. Rethrows the first exception
+  // a task threw, after the others have finished
+  void parallel_for(size_t count, const std::function<void(size_t)>& task);
+
+
+  // ---- GETTERS ----
+  size_t size() const { return workers_.size(); }
+
+private:
+  // ---- PARAMETERS ----
+  std::vector<std::thread> workers_;
+  std::deque<std::function<void()>> queue_;
+  bool running_ = true;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+
+
+  // ---- WORKERS ----
+  void worker_loop();
+};
+
+} // namespace dfs::crypto
+
+#endif // DFS_CRYPTO_WORKER_POOL_HPP
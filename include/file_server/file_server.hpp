@@ -2,7 +2,10 @@
 #define DFS_NETWORK_FILE_SERVER_HPP
 
 #include <atomic>
+#include <chrono>
+#include <condition_variable>
 #include <cstdint>
+#include <map>
 #include <memory>
 #include <mutex>
 #include <optional>
@@ -10,6 +13,7 @@
 #include <string>
 #include <thread>
 #include <vector>
+#include "crypto/cipher_benchmark.hpp"
 #include "crypto/crypto_stream.hpp"
 #include "network/channel.hpp"
 #include "network/codec.hpp"
@@ -39,10 +43,21 @@ public:
   // ---- PROCESSING OF USER REQUESTS ----
   bool store_file(const std::string& filename, std::istream& input);
   bool get_file(const std::string& filename);
+  // Reads part of a file from the local store, or from peers if it is not
+  // stored locally. Returns nullopt if no copy answers in time
+  std::optional<std::string> get_file_range(const std::string& filename, uint64_t offset, uint64_t length);
 
   
-  // ---- GETTERS ----
+  // ---- GETTERS AND SETTERS ----
   dfs::store::Store& get_store() { return *store_; }
+  // Pins the cipher of frames sent to peers instead of the negotiated suites.
+  // An unauthenticated cipher only applies to peers without a negotiated suite
+  void set_cipher(Codec::Cipher cipher) {
+    codec_->set_cipher(cipher);
+    cipher_pinned_ = true;
+  }
+  Codec::Cipher get_cipher() const { return codec_->get_cipher(); }
+  PeerManager& get_peer_manager() { return peer_manager_; }
   
 private:
   // ---- PARAMETERS ----
@@ -50,25 +65,36 @@ private:
   std::vector<uint8_t> key_;
   std::unique_ptr<dfs::store::Store> store_;
   std::unique_ptr<Codec> codec_;
+  std::atomic<bool> cipher_pinned_{false};
   Channel& channel_;
   PeerManager& peer_manager_;  
   TCP_Server& tcp_server_;
-  std::mutex mutex_;
   std::atomic<bool> running_{true};
   std::unique_ptr<std::thread> listener_thread_;
+  // Ranged reads awaiting a RANGE_DATA reply, keyed by request ID
+  static constexpr std::chrono::seconds RANGE_TIMEOUT{5};
+  std::mutex range_mutex_;
+  std::condition_variable range_cv_;
+  std::map<uint64_t, std::optional<std::string>> pending_ranges_;
+  uint64_t next_range_id_ = 1;
 
   
   // ---- PROCESSING OF OUTGOING DATA ----
   // Prepare and send file to peers with specified message type
-  bool prepare_and_send(const std::string& filename, MessageType message_type, std::optional<uint8_t> peer_id = std::nullopt);
+  bool prepare_and_send(const std::string& filename, MessageType message_type, std::optional<uint8_t> peer_id = std::nullopt,
+                        std::optional<ByteRange> range = std::nullopt);
   // Creates MessageFrame with appropriate metadata and IV
   MessageFrame create_message_frame(const std::string& filename, MessageType message_type);
   // Creates producer function to handle file content streaming based on message type
-  std::function<bool(std::stringstream&)> create_producer(const std::string& filename, MessageType message_type);
+  std::function<bool(std::stringstream&)> create_producer(const std::string& filename, MessageType message_type,
+                                                          std::optional<ByteRange> range = std::nullopt);
   // Creates transform function to serialize message frame data
   std::function<bool(std::stringstream&, std::stringstream&)> create_transform(
     MessageFrame& frame, 
-    utils::Pipeliner* pipeline);
+    utils::Pipeliner* pipeline,
+    Codec::Cipher cipher);
+  // Cipher of a frame to one peer or, without a peer ID, to all of them
+  Codec::Cipher select_cipher(std::optional<uint8_t> peer_id);
   // Handles sending pipeline data to specific peer or broadcasting
   bool send_pipeline(dfs::utils::Pipeliner* const& pipeline, std::optional<uint8_t> peer_id);
 
@@ -81,13 +107,22 @@ private:
   // Handle incoming store/get message frames
   bool handle_store(const MessageFrame& frame);
   bool handle_get(const MessageFrame& frame);
+  // Handle incoming ranged get requests and their replies
+  bool handle_get_range(const MessageFrame& frame);
+  bool handle_range_data(const MessageFrame& frame);
   // Extract filename from message frame's payload stream
   std::string extract_filename(const MessageFrame& frame);
+  // Read or write the byte range that follows the filename in a payload
+  static constexpr uint64_t RANGE_SIZE = 3 * sizeof(uint64_t);
+  ByteRange extract_range(const MessageFrame& frame);
+  static void write_range(std::ostream& output, const ByteRange& range);
 
   
   // Called by get_file to retrieve file from store/network
   bool read_from_local_store(const std::string& filename);
   bool retrieve_from_network(const std::string& filename);
+  // Called by get_file_range to request a range from peers and wait for the reply
+  std::optional<std::string> retrieve_range_from_network(const std::string& filename, const ByteRange& range);
 };
 
 } // namespace network
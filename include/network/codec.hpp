@@ -1,32 +1,56 @@
 #ifndef DFS_NETWORK_CODEC_HPP
 #define DFS_NETWORK_CODEC_HPP
 
+#include <array>
+#include <atomic>
 #include <cstdint>
 #include <iostream>
 #include <mutex>
 #include <utility>
 #include "network/message_frame.hpp"
 #include "network/channel.hpp"
+#include "crypto/crypto_stream.hpp"
 
 namespace dfs {
 namespace network {
 
+// Wire format of a frame: IV, cipher, message type, source id and payload
+// size in the clear, then the encrypted filename length and payload. The
+// cipher byte names how the rest was encrypted, so peers using different
+// ciphers can still talk. With GCM or ChaCha20-Poly1305 the clear header is
+// authenticated by every record, so a tampered frame fails at its filename
+// length before any payload is decrypted.
 class Codec {
 public:
+  using Cipher = crypto::CryptoStream::Cipher;
+
   // ---- CONSTRUCTOR AND DESTRUCTOR ----
-  explicit Codec(const std::vector<uint8_t>& key, Channel& channel);
+  explicit Codec(const std::vector<uint8_t>& key, Channel& channel, Cipher cipher = Cipher::Aes256Cbc);
 
   
   // ---- SERIALIZATION AND DESERIALIZATION ----
-  // Serializes a message frame to an output stream
+  // Serializes a message frame to an output stream, returns the bytes written
   std::size_t serialize(const MessageFrame& frame, std::ostream& output);
+  // Same with a cipher chosen for this frame, e.g. the one negotiated with its receiver
+  std::size_t serialize(const MessageFrame& frame, std::ostream& output, Cipher cipher);
   // Deserializes a message frame from input stream and pushes to channel
   MessageFrame deserialize(std::istream& input);
 
+
+  // ---- GETTERS AND SETTERS ----
+  // Selects the cipher of serialized frames. A codec with an authenticated
+  // cipher also refuses to deserialize unauthenticated CBC frames
+  void set_cipher(Cipher cipher) { cipher_ = cipher; }
+  Cipher get_cipher() const { return cipher_; }
+
 private:
   // ---- PARAMETERS ----
+  // Holds the encrypted filename length of any cipher, a CBC block or a record tag and length
+  using FilenameLengthBuffer = std::array<uint8_t, crypto::CryptoStream::BLOCK_SIZE + crypto::CryptoStream::TAG_SIZE>;
+
   std::vector<uint8_t> key_;
   Channel& channel_;
+  std::atomic<Cipher> cipher_;
 
   
   // ---- STREAM OPERATIONS ----
@@ -34,6 +58,8 @@ private:
   void write_bytes(std::ostream& output, const void* data, std::size_t size);
   // Reads bytes from an input stream
   void read_bytes(std::istream& input, void* data, std::size_t size);
+  // Appends bytes to the clear header that sealed records authenticate
+  static void append_header(std::vector<uint8_t>& header, const void* data, std::size_t size);
 
   
   // ---- HOST TO NETWORK BYTE ORDER CONVERSION ----
@@ -55,11 +81,6 @@ private:
   static uint64_t from_network_order(uint64_t network_value) {
     return boost::endian::big_to_native(network_value);
   }
-
-
-  // ---- UTILITY METHODS ----
-  // Returns size of data + padding bytes from encryption
-  static size_t get_padded_size(size_t original_size);
 };
 
 } // namespace network
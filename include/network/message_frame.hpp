@@ -14,7 +14,18 @@ namespace network {
 // Message type used to differentiate between requests
 enum class MessageType : uint8_t {
   STORE_FILE = 0,
-  GET_FILE = 1
+  GET_FILE = 1,
+  GET_RANGE = 2,   // Request for part of a file
+  RANGE_DATA = 3   // Reply to GET_RANGE carrying the requested bytes
+};
+
+// Part of a file, sent in network byte order after the filename of
+// GET_RANGE and RANGE_DATA payloads. RANGE_DATA echoes the request ID of
+// the GET_RANGE it answers
+struct ByteRange {
+  uint64_t offset;
+  uint64_t length;
+  uint64_t request_id = 0;
 };
 
 // Data structure used to represent data locally
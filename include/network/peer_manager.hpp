@@ -5,6 +5,7 @@
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <utility>  
 #include <vector>
@@ -38,7 +39,10 @@ public:
 
   
   // ---- PEER MANAGEMENT ----
-  void create_peer(std::shared_ptr<boost::asio::ip::tcp::socket> socket, uint8_t peer_id);
+  // Starts a peer that uses the cipher suite negotiated in the handshake
+  void create_peer(std::shared_ptr<boost::asio::ip::tcp::socket> socket, uint8_t peer_id,
+                   Codec::Cipher cipher = Codec::Cipher::Aes256Gcm,
+                   std::vector<crypto::SuiteSpeed> remote_suites = {});
   void add_peer(const std::shared_ptr<TCP_Peer> peer);
   void remove_peer(uint8_t peer_id);
   bool has_peer(uint8_t peer_id);
@@ -52,6 +56,14 @@ public:
   bool broadcast_stream(dfs::utils::Pipeliner& pipeline);
 
   
+  // ---- CIPHER NEGOTIATION ----
+  // Suite for a frame broadcast to every peer, the one whose slowest end
+  // among this node and all peers is fastest. nullopt without peers
+  std::optional<Codec::Cipher> get_broadcast_cipher() const;
+  // Suite negotiated with each connected peer
+  std::map<uint8_t, Codec::Cipher> get_negotiated_ciphers() const;
+
+  
   // ---- UTILITY METHODS ----
   std::size_t size() const;
   void shutdown();
@@ -7,11 +7,13 @@
 #include <string>
 #include <thread>
 #include <utility>
+#include <vector>
 #include <boost/asio.hpp>
 #include <boost/log/trivial.hpp>
 #include "peer.hpp"
 #include "channel.hpp"
 #include "codec.hpp"
+#include "crypto/cipher_benchmark.hpp"
 
 namespace dfs {
 namespace network {
@@ -51,6 +53,13 @@ public:
   std::istream* get_input_stream() override;
   uint8_t get_peer_id() const;
   boost::asio::ip::tcp::socket& get_socket();
+  // Codec decoding this connection's frames, e.g. to require authenticated ones
+  Codec& get_codec() { return *codec_; }
+  // Records the suite negotiated in the handshake and the peer's measured
+  // suites. Frames from the peer must then be authenticated
+  void set_cipher_suites(Codec::Cipher negotiated, std::vector<crypto::SuiteSpeed> remote_suites);
+  Codec::Cipher get_negotiated_cipher() const { return negotiated_cipher_; }
+  const std::vector<crypto::SuiteSpeed>& get_remote_suites() const { return remote_suites_; }
   
   // Sets callback function for processing received data streams
   void set_stream_processor(StreamProcessor processor) override;
@@ -77,6 +86,9 @@ private:
 
   // Codec for encryption/decryption
   std::unique_ptr<Codec> codec_;
+  // Cipher suites agreed in the handshake, set before stream processing starts
+  std::atomic<Codec::Cipher> negotiated_cipher_{Codec::Cipher::Aes256Gcm};
+  std::vector<crypto::SuiteSpeed> remote_suites_;
 
 
   // ---- STREAM CONTROL OPERATIONS ----
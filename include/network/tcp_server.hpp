@@ -3,9 +3,11 @@
 #include <memory>
 #include <string>
 #include <thread>
+#include <vector>
 #include <boost/asio.hpp>
 #include <boost/log/trivial.hpp>
 #include "network/peer_manager.hpp"
+#include "crypto/cipher_benchmark.hpp"
 
 
 namespace dfs {
@@ -39,6 +41,9 @@ public:
 private:
 
   // ---- PARAMETERS ----
+  // Most cipher suites accepted from a peer's handshake
+  static constexpr uint8_t MAX_SUITES = 16;
+
   // Local ID
   const uint8_t ID_;
   
@@ -69,18 +74,28 @@ private:
 
   
   // ---- HANDSHAKE INITIATION ----
-  // Sends ID then waits to receive remote ID
+  // Sends ID then waits to receive remote ID, then exchanges cipher suites
   bool initiate_handshake(std::shared_ptr<boost::asio::ip::tcp::socket> socket);
   // Performs ID transmission
   bool send_ID(std::shared_ptr<boost::asio::ip::tcp::socket> socket);
 
   
   // ---- HANDSHAKE RECEPTION ----
-  // Receives remote ID and sends local ID back 
+  // Receives remote ID and sends local ID back, then exchanges cipher suites
   void receive_handshake(std::shared_ptr<boost::asio::ip::tcp::socket> socket);
   // Performs ID reading
   uint8_t read_ID(std::shared_ptr<boost::asio::ip::tcp::socket> socket);
 
+
+  // ---- CIPHER NEGOTIATION ----
+  // Sends this node's measured cipher suites, after the ID exchange
+  void send_suites(std::shared_ptr<boost::asio::ip::tcp::socket> socket);
+  // Reads the peer's suites, dropping those this node does not know
+  std::vector<crypto::SuiteSpeed> read_suites(std::shared_ptr<boost::asio::ip::tcp::socket> socket);
+  // Picks the shared suite whose slower end is fastest, the same on both
+  // ends. Throws if no suite is shared
+  Codec::Cipher negotiate_cipher(uint8_t peer_id, const std::vector<crypto::SuiteSpeed>& remote_suites);
+
 };
 
 } // namespace network
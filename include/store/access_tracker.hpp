@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+
+namespace dfs {
+namespace store {
+
+// Recency and frequency of accesses to one key
+struct AccessStats {
+  uint64_t last_access = 0;  // Access clock value of the latest access
+  uint32_t frequency = 0;    // Accesses, saturating
+};
+
+// Cheap per-key access statistics for eviction decisions. Accesses are
+// stamped with a logical clock that advances once per recorded access, and
+// counted in a map split across independently locked shards so concurrent
+// readers rarely contend. Statistics live in memory only.
+class AccessTracker {
+public:
+  static constexpr size_t SHARD_COUNT = 16;
+  // Accesses elsewhere after which an idle key's frequency counts half
+  static constexpr uint64_t AGING_PERIOD = 4096;
+
+  // Delete copy operations, shards hold mutexes
+  AccessTracker(const AccessTracker&) = delete;
+  AccessTracker& operator=(const AccessTracker&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  AccessTracker() = default;
+
+
+  // ---- TRACKING OPERATIONS ----
+  void record(const std::string& key);
+  std::optional<AccessStats> lookup(const std::string& key) const;
+  void forget(const std::string& key);
+  void clear();
+
+
+  // ---- GETTERS ----
+  uint64_t now() const { return clock_; }
+  // Frequency discounted by how long the key has been idle, keys never
+  // accessed score zero
+  uint32_t score(const std::optional<AccessStats>& stats) const;
+
+private:
+  // ---- PARAMETERS ----
+  struct Shard {
+    mutable std::mutex mutex;
+    std::unordered_map<std::string, AccessStats> entries;
+  };
+
+  std::array<Shard, SHARD_COUNT> shards_;
+  std::atomic<uint64_t> clock_{0};
+
+
+  // ---- UTILITY METHODS ----
+  Shard& shard_for(const std::string& key);
+  const Shard& shard_for(const std::string& key) const;
+};
+
+} // namespace store
+} // namespace dfs
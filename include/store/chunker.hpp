@@ -0,0 +1,48 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+namespace dfs {
+namespace store {
+
+// Content-defined chunker based on a Gear rolling hash. Boundaries depend
+// only on the bytes preceding them, so an insert or delete early in a file
+// only changes the chunks around the edit and the rest still deduplicate.
+class Chunker {
+public:
+  static constexpr size_t MIN_CHUNK_SIZE = 2 * 1024;    // 2KB lower bound
+  static constexpr size_t AVG_CHUNK_SIZE = 8 * 1024;    // 8KB target size (power of two)
+  static constexpr size_t MAX_CHUNK_SIZE = 64 * 1024;   // 64KB upper bound
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  Chunker(size_t min_size = MIN_CHUNK_SIZE, size_t avg_size = AVG_CHUNK_SIZE,
+          size_t max_size = MAX_CHUNK_SIZE);
+
+
+  // ---- CHUNKING OPERATIONS ----
+  // Returns the length of the next chunk starting at data. Callers must pass
+  // at least max_size() bytes unless the input is exhausted
+  size_t next_boundary(const uint8_t* data, size_t length) const;
+
+
+  // ---- GETTERS ----
+  size_t min_size() const { return min_size_; }
+  size_t avg_size() const { return avg_size_; }
+  size_t max_size() const { return max_size_; }
+
+private:
+  // ---- PARAMETERS ----
+  size_t min_size_;
+  size_t avg_size_;
+  size_t max_size_;
+  // Number of leading hash bits that must be zero to cut a chunk
+  unsigned int mask_bits_;
+
+  // Per-byte random values mixed into the rolling hash
+  static const std::array<uint64_t, 256>& gear_table();
+};
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,27 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dfs {
+namespace store {
+
+// CRC-32C (Castagnoli) checksums of stored objects. Uses the SSE 4.2 crc32
+// instruction when the CPU has it and slicing-by-8 tables otherwise. Both
+// produce the same values, so a checksum written on one machine verifies on
+// any other.
+class Crc32c {
+public:
+  // ---- CHECKSUM OPERATIONS ----
+  // Extends crc, the checksum of the preceding bytes or zero, over length bytes
+  static uint32_t update(uint32_t crc, const void* data, size_t length);
+  static uint32_t compute(const void* data, size_t length) { return update(0, data, length); }
+
+
+  // ---- GETTERS ----
+  // True if update() runs on the CPU's crc32 instruction
+  static bool is_hardware_accelerated();
+};
+
+} // namespace store
+} // namespace dfs
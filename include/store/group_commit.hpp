@@ -0,0 +1,99 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace dfs {
+namespace store {
+
+// Makes temp files durable and renames them into place in batches. Writers
+// submit a fully written temp file and wait on the returned future; a single
+// commit thread collects submissions for up to one latency window, syncs the
+// whole batch, publishes every file with an atomic rename and syncs the
+// affected directories once, so concurrent writers share the fsync cost.
+class GroupCommitter {
+public:
+  static constexpr std::chrono::microseconds DEFAULT_WINDOW{2000};  // 2ms
+  static constexpr size_t MAX_BATCH_SIZE = 256;
+  // Batches at least this large are flushed with one syncfs() instead of
+  // one fdatasync() per file
+  static constexpr size_t SYNCFS_THRESHOLD = 16;
+
+  // Delete copy operations, the committer owns a worker thread
+  GroupCommitter(const GroupCommitter&) = delete;
+  GroupCommitter& operator=(const GroupCommitter&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  explicit GroupCommitter(std::chrono::microseconds window = DEFAULT_WINDOW);
+  // Commits everything still queued and stops the commit thread
+  ~GroupCommitter();
+
+
+  // ---- COMMIT OPERATIONS ----
+  // Queues a written temp file for publication at final_path and takes
+  // ownership of fd. on_commit runs on the commit thread once the file is
+  // durable and in place, before the batch sync hook
+  std::future<void> submit(int fd, const std::filesystem::path& temp_path,
+                           const std::filesystem::path& final_path,
+                           std::function<void()> on_commit = {});
+  // Queues a commit without a file, for data the flush hook makes durable.
+  // on_commit runs with the batch's other commit callbacks
+  std::future<void> submit(std::function<void()> on_commit);
+
+
+  // ---- GETTERS AND SETTERS ----
+  void set_window(std::chrono::microseconds window);
+  std::chrono::microseconds get_window() const;
+  // Runs once per batch after file data is synced, before the commit callbacks
+  void set_flush_hook(std::function<void()> hook);
+  // Runs once per batch after the commit callbacks, before waiters are
+  // released. A failure does not fail the already published batch
+  void set_sync_hook(std::function<void()> hook);
+  uint64_t get_batch_count() const { return batches_; }
+  uint64_t get_file_count() const { return files_; }
+  // Batches whose sync hook failed
+  uint64_t get_sync_failure_count() const { return sync_failures_; }
+
+private:
+  // ---- PARAMETERS ----
+  struct Request {
+    int fd;  // -1 for commits without a file
+    std::filesystem::path temp_path;
+    std::filesystem::path final_path;
+    std::function<void()> on_commit;
+    std::promise<void> done;
+  };
+
+  std::chrono::microseconds window_;
+  std::function<void()> flush_hook_;
+  std::function<void()> sync_hook_;
+  std::vector<Request> queue_;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  bool running_ = true;
+  std::atomic<uint64_t> batches_{0};
+  std::atomic<uint64_t> files_{0};
+  std::atomic<uint64_t> sync_failures_{0};
+  std::thread worker_;
+
+
+  // ---- COMMIT PROCESSING ----
+  // Adds a request to the queue and wakes the commit thread
+  std::future<void> enqueue(Request request);
+  // Collects batches until stopped and the queue is drained
+  void commit_loop();
+  // Syncs, renames and publishes one batch
+  void commit_batch(std::vector<Request>& batch);
+};
+
+} // namespace store
+} // namespace dfs
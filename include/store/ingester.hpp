@@ -0,0 +1,126 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <string>
+#include <unordered_set>
+#include "store.hpp"
+
+namespace dfs {
+namespace store {
+
+// How an ingest run walks, stores and checkpoints files
+struct IngestOptions {
+  size_t threads = 0;                   // Worker threads, zero means one per hardware thread
+  std::filesystem::path checkpoint;     // Log of finished files, empty means CHECKPOINT_FILENAME in the store root
+  std::string prefix;                   // Prepended to each relative path to form its key
+  ObjectOrigin origin = ObjectOrigin::Local;
+};
+
+// Counters describing one ingest run
+struct IngestStats {
+  uint64_t files = 0;    // Files stored by this run
+  uint64_t bytes = 0;    // Bytes stored by this run
+  uint64_t skipped = 0;  // Files a previous run already stored
+  uint64_t failed = 0;   // Files that could not be read or stored
+  double seconds = 0;
+};
+
+// Seeds a Store from a directory tree without going through a FileServer.
+// The calling thread walks the source tree and queues regular files, keyed by
+// their path relative to the source root, while worker threads store them
+// through Store::store, so packing, compression and checksums apply as they
+// would for any other write. Workers take per-key locks only, so files are
+// read, hashed and copied in parallel. Every stored file is appended to a
+// checkpoint log; a later run over the same tree skips files the log names if
+// the store still holds them at their source size. Only complete log lines
+// count, so a log torn by a crash loses at most the file being recorded. The
+// default log lives in the store root, which the scanner leaves alone.
+class Ingester {
+public:
+  static constexpr char CHECKPOINT_FILENAME[] = ".dfs_ingest";
+  // Files walked ahead of the workers at most
+  static constexpr size_t QUEUE_CAPACITY = 4096;
+  // Checkpoint records between two fdatasyncs of the log
+  static constexpr size_t SYNC_INTERVAL = 256;
+
+  // Delete copy operations, the ingester owns the checkpoint descriptor
+  Ingester(const Ingester&) = delete;
+  Ingester& operator=(const Ingester&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  // Loads the checkpoint of an earlier run, throws StoreError if source is
+  // not a directory
+  Ingester(Store& store, const std::filesystem::path& source, IngestOptions options = {});
+  // Syncs and closes the checkpoint
+  ~Ingester();
+
+
+  // ---- INGEST OPERATIONS ----
+  // Stores every regular file under the source root not stored already and
+  // returns what this run did. Files that fail are logged and counted
+  IngestStats run();
+
+
+  // ---- GETTERS ----
+  const std::filesystem::path& get_checkpoint_path() const { return checkpoint_path_; }
+  // Keys the checkpoint names, from earlier runs and this one
+  size_t get_checkpointed_count() const;
+
+private:
+  // ---- PARAMETERS ----
+  // A file waiting for a worker
+  struct Task {
+    std::filesystem::path path;
+    std::string key;
+    uint64_t size;
+  };
+
+  Store& store_;
+  std::filesystem::path source_;
+  IngestOptions options_;
+  std::filesystem::path checkpoint_path_;
+
+  // Files queued by the walker
+  std::deque<Task> queue_;
+  bool walking_ = false;
+  std::mutex queue_mutex_;
+  std::condition_variable not_empty_;
+  std::condition_variable not_full_;
+
+  // Keys recorded in the checkpoint and its append-only descriptor
+  std::unordered_set<std::string> done_;
+  int checkpoint_fd_ = -1;
+  size_t unsynced_ = 0;
+  mutable std::mutex checkpoint_mutex_;
+
+  std::atomic<uint64_t> files_{0};
+  std::atomic<uint64_t> bytes_{0};
+  std::atomic<uint64_t> skipped_{0};
+  std::atomic<uint64_t> failed_{0};
+
+
+  // ---- CHECKPOINT ----
+  // Reads the complete records of an existing log and opens it for appending
+  void open_checkpoint();
+  // Appends key to the log, syncing it every SYNC_INTERVAL records
+  void record_done(const std::string& key);
+  // True if an earlier run stored key and the store still holds size bytes under it
+  bool is_done(const std::string& key, uint64_t size) const;
+
+
+  // ---- WORKERS ----
+  // Walks the source tree and queues files, blocking while the queue is full
+  void walk();
+  // Stores queued files until the walk has finished and the queue is empty
+  void worker_loop();
+  void ingest_file(const Task& task);
+};
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,115 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <sys/types.h>
+
+struct io_uring_sqe;
+struct io_uring_cqe;
+struct io_uring_params;
+
+namespace dfs {
+namespace store {
+
+// Asynchronous file I/O through a Linux io_uring. Operations are queued to a
+// shared submission ring and return immediately; a single completion thread
+// reaps results, runs the optional completion callback and fulfils the
+// returned future. Callbacks run on the completion thread and may submit
+// follow-up operations, so a chain such as open, read and close needs no
+// thread of its own. Results follow syscall conventions: a descriptor or
+// byte count on success, a negative errno on failure.
+class IoRing {
+public:
+  static constexpr unsigned QUEUE_DEPTH = 256;
+
+  using Completion = std::function<void(int result)>;
+
+  // Delete copy operations, the ring owns kernel mappings and a thread
+  IoRing(const IoRing&) = delete;
+  IoRing& operator=(const IoRing&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  // Sets up the ring, throws StoreError if io_uring is unavailable
+  explicit IoRing(unsigned entries = QUEUE_DEPTH);
+  // Waits for in-flight operations and stops the completion thread
+  ~IoRing();
+
+
+  // ---- ASYNC OPERATIONS ----
+  // Buffers must stay valid until the operation completes
+  std::future<int> open(const std::string& path, int flags, mode_t mode, Completion on_complete = {});
+  std::future<int> read(int fd, void* data, size_t length, uint64_t offset, Completion on_complete = {});
+  std::future<int> write(int fd, const void* data, size_t length, uint64_t offset,
+                         Completion on_complete = {});
+  std::future<int> fsync(int fd, bool data_only, Completion on_complete = {});
+  std::future<int> close(int fd, Completion on_complete = {});
+
+
+  // ---- GETTERS ----
+  // Returns true if the running kernel permits io_uring and supports every
+  // opcode the ring submits
+  static bool is_supported();
+  uint64_t get_submitted_count() const { return submitted_; }
+  size_t get_in_flight() const;
+
+private:
+  // ---- PARAMETERS ----
+  // One submitted operation, addressed through the SQE user data
+  struct Operation {
+    std::promise<int> promise;
+    Completion on_complete;
+    std::string path;  // Keeps an open() path alive until completion
+  };
+
+  // Submission and completion ring mappings shared with the kernel
+  struct Rings {
+    void* sq_map = nullptr;
+    size_t sq_map_size = 0;
+    void* cq_map = nullptr;
+    size_t cq_map_size = 0;
+    io_uring_sqe* sqes = nullptr;
+    size_t sqes_size = 0;
+    unsigned* sq_head = nullptr;
+    unsigned* sq_tail = nullptr;
+    unsigned* sq_mask = nullptr;
+    unsigned* sq_array = nullptr;
+    unsigned* cq_head = nullptr;
+    unsigned* cq_tail = nullptr;
+    unsigned* cq_mask = nullptr;
+    io_uring_cqe* cqes = nullptr;
+    unsigned cq_entries = 0;
+  };
+
+  int ring_fd_ = -1;
+  Rings rings_;
+  mutable std::mutex submit_mutex_;
+  std::condition_variable slots_cv_;
+  size_t in_flight_ = 0;
+  // Set while a completion callback runs and its operation's slot is unclaimed
+  bool callback_slot_free_ = false;
+  std::atomic<uint64_t> submitted_{0};
+  std::thread reaper_;
+
+
+  // ---- RING MANAGEMENT ----
+  void map_rings(const io_uring_params& params);
+  void unmap_rings();
+  // Fills an SQE through prepare and submits it. Waits for a free slot when
+  // the ring is full, unless called from a completion callback
+  std::future<int> submit(std::function<void(io_uring_sqe&)> prepare, std::unique_ptr<Operation> op);
+
+
+  // ---- COMPLETION HANDLING ----
+  void reap_loop();
+};
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+
+namespace dfs {
+namespace store {
+
+// Priority class of a Store I/O operation, highest priority first
+enum class IoClass : uint8_t {
+  Foreground,   // Client reads and locally stored objects
+  Replication,  // Objects received from peers
+  Background    // Deletion, migration and compaction
+};
+
+// Limits applied to one I/O class
+struct IoBudget {
+  uint64_t bytes_per_second = 0;          // Zero means unlimited
+  uint64_t ops_per_second = 0;            // Zero means unlimited
+  size_t max_in_flight = 0;               // Operations admitted at once, zero means up to the queue depth
+  std::chrono::microseconds deadline{0};  // Waiting this long lets a request overtake higher classes
+};
+
+// Counters describing how one I/O class was served
+struct IoClassStats {
+  uint64_t operations = 0;
+  uint64_t bytes = 0;
+  uint64_t total_wait_us = 0;
+  uint64_t max_wait_us = 0;
+  uint64_t deadline_misses = 0;  // Operations admitted after their deadline
+};
+
+// Admission control for Store I/O. Every disk operation asks for a grant in
+// its priority class and holds it while the operation runs. At most the
+// queue depth of operations run at once. A free slot goes to the highest
+// class with a queued request whose budget allows it, unless a request of
+// any class has waited past its deadline, in which case the earliest
+// deadline wins. Requests of one class are served in arrival order. Byte and
+// operation budgets are token buckets holding one second of their rate; an
+// operation larger than the balance runs and leaves a debt that later
+// requests of the class wait out.
+class IoScheduler {
+public:
+  static constexpr size_t DEFAULT_QUEUE_DEPTH = 64;
+  static constexpr size_t CLASS_COUNT = 3;
+
+  // Holds one admitted operation's slot until destroyed or released
+  class Grant {
+  public:
+    Grant() = default;
+    Grant(Grant&& other) noexcept;
+    Grant& operator=(Grant&& other) noexcept;
+    Grant(const Grant&) = delete;
+    Grant& operator=(const Grant&) = delete;
+    ~Grant() { release(); }
+
+    void release();
+    explicit operator bool() const { return scheduler_ != nullptr; }
+
+  private:
+    friend class IoScheduler;
+    Grant(IoScheduler* scheduler, IoClass io_class) : scheduler_(scheduler), io_class_(io_class) {}
+
+    IoScheduler* scheduler_ = nullptr;
+    IoClass io_class_ = IoClass::Foreground;
+  };
+
+  // Delete copy operations, waiting requests point into the scheduler
+  IoScheduler(const IoScheduler&) = delete;
+  IoScheduler& operator=(const IoScheduler&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  // Replication and background work may each fill only part of the queue by default
+  explicit IoScheduler(size_t queue_depth = DEFAULT_QUEUE_DEPTH);
+
+
+  // ---- SCHEDULING OPERATIONS ----
+  // Blocks until an operation of bytes in io_class may run. A thread must not
+  // hold a grant while waiting for another one
+  Grant acquire(IoClass io_class, uint64_t bytes);
+
+
+  // ---- GETTERS AND SETTERS ----
+  void set_budget(IoClass io_class, const IoBudget& budget);
+  IoBudget get_budget(IoClass io_class) const;
+  IoClassStats get_stats(IoClass io_class) const;
+  size_t get_queue_depth() const { return queue_depth_; }
+  size_t get_in_flight() const;
+  size_t get_queued() const;
+
+private:
+  using Clock = std::chrono::steady_clock;
+
+  // ---- PARAMETERS ----
+  // A caller waiting in acquire()
+  struct Request {
+    uint64_t bytes;
+    Clock::time_point arrival;
+    Clock::time_point deadline;
+    bool granted = false;
+    std::condition_variable cv;
+  };
+
+  struct ClassState {
+    IoBudget budget;
+    double byte_tokens = 0;
+    double op_tokens = 0;
+    Clock::time_point refilled;
+    size_t in_flight = 0;
+    std::deque<Request*> queue;
+    IoClassStats stats;
+  };
+
+  size_t queue_depth_;
+  size_t in_flight_ = 0;
+  std::array<ClassState, CLASS_COUNT> classes_;
+  mutable std::mutex mutex_;
+
+
+  // ---- DISPATCH ----
+  // Frees the slot of a finished operation and admits waiting requests
+  void release(IoClass io_class);
+  // Grants free slots to waiting requests in priority and deadline order
+  void dispatch(Clock::time_point now);
+  // Adds the tokens earned since the last refill, capped at one second's worth
+  void refill(ClassState& state, Clock::time_point now) const;
+  // True if the class budget allows one more operation now
+  bool can_admit(const ClassState& state) const;
+  // Time until a class held back only by its rate budget earns tokens,
+  // Clock::duration::max() if no waiting request is held back by a rate
+  Clock::duration time_until_refill() const;
+};
+
+} // namespace store
+} // namespace dfs
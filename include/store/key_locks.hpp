@@ -0,0 +1,53 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+
+namespace dfs {
+namespace store {
+
+// Striped reader/writer locks keyed by object hash. Hashes map onto a fixed
+// set of stripes, so operations on unrelated keys rarely contend while
+// readers of the same key share their stripe.
+class KeyLockManager {
+public:
+  static constexpr size_t STRIPE_COUNT = 256;
+
+  // Delete copy operations, stripes hold mutexes
+  KeyLockManager(const KeyLockManager&) = delete;
+  KeyLockManager& operator=(const KeyLockManager&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  KeyLockManager() = default;
+
+
+  // ---- LOCK OPERATIONS ----
+  // Locks the stripe of hash for reading
+  std::shared_lock<std::shared_mutex> lock_shared(const std::string& hash) const;
+  // Locks the stripe of hash for writing
+  std::unique_lock<std::shared_mutex> lock_exclusive(const std::string& hash) const;
+
+
+  // ---- GETTERS ----
+  size_t stripe_of(const std::string& hash) const;
+  // Number of lock requests that had to wait for another holder
+  uint64_t get_contention_count() const { return contended_; }
+
+private:
+  // ---- PARAMETERS ----
+  // Padded to a cache line so neighbouring stripes do not false-share
+  struct alignas(64) Stripe {
+    std::shared_mutex mutex;
+  };
+
+  mutable std::array<Stripe, STRIPE_COUNT> stripes_;
+  mutable std::atomic<uint64_t> contended_{0};
+};
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace dfs {
+namespace store {
+
+// Fast byte-oriented LZ77 block codec in the style of LZ4. A block is a run
+// of sequences, each a token byte holding the literal and match lengths,
+// extra length bytes of 255 for long runs, the literals and a two-byte
+// little-endian match offset. The final sequence carries literals only.
+// Matches are found through a hash table of four-byte prefixes without any
+// entropy coding, trading ratio for speed on text, logs and JSON.
+class LzCodec {
+public:
+  // Matches reach at most this far back
+  static constexpr size_t MAX_OFFSET = 65535;
+  static constexpr size_t MIN_MATCH = 4;
+  // A block decodes to at most this many bytes per encoded byte, reached by
+  // long matches whose extra length bytes each add 255 bytes
+  static constexpr size_t MAX_EXPANSION = 255;
+  // log2 of the match finder's hash table size
+  static constexpr unsigned HASH_BITS = 14;
+
+
+  // ---- CODEC OPERATIONS ----
+  // Upper bound of compress() output for length input bytes
+  static size_t max_compressed_size(size_t length);
+  // Compresses length bytes into output, returns the compressed size or zero
+  // if it would exceed capacity
+  static size_t compress(const char* input, size_t length, char* output, size_t capacity);
+  // Decompresses a block into exactly expected bytes, false if it is corrupt
+  static bool decompress(const char* input, size_t length, char* output, size_t expected);
+};
+
+} // namespace store
+} // namespace dfs
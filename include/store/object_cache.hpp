@@ -0,0 +1,101 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "object_view.hpp"
+
+namespace dfs {
+namespace store {
+
+// Counters describing cache effectiveness
+struct CacheStats {
+  uint64_t hits = 0;
+  uint64_t misses = 0;
+  uint64_t evictions = 0;   // Entries dropped to make room for new ones
+  uint64_t rejections = 0;  // Entries refused by the admission filter
+  std::size_t entries = 0;
+  std::size_t bytes = 0;
+};
+
+// Sharded, byte-budgeted cache of recently read object views. Each shard is
+// an LRU list guarded by its own mutex. New entries that would evict others
+// must be accessed more often than the LRU victim, as estimated by a small
+// per-shard count-min sketch, so one-off reads cannot flush hot objects.
+class ObjectCache {
+public:
+  static constexpr std::size_t DEFAULT_CAPACITY = 64 * 1024 * 1024;  // 64MB
+  static constexpr std::size_t SHARD_COUNT = 16;
+  // Frequency sketch dimensions, counters are halved after SKETCH_WIDTH * 8 accesses
+  static constexpr std::size_t SKETCH_DEPTH = 4;
+  static constexpr std::size_t SKETCH_WIDTH = 1024;
+
+  // Delete copy operations, shards hold mutexes
+  ObjectCache(const ObjectCache&) = delete;
+  ObjectCache& operator=(const ObjectCache&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  explicit ObjectCache(std::size_t capacity = DEFAULT_CAPACITY);
+
+
+  // ---- CACHE OPERATIONS ----
+  // Returns the cached view or nullptr. On a miss, ticket receives a value
+  // to pass to insert
+  ObjectViewPtr lookup(const std::string& key, uint64_t& ticket);
+  // Caches a view read after a miss, unless key was invalidated since the
+  // ticket was issued
+  void insert(const std::string& key, ObjectViewPtr view, uint64_t ticket);
+  void invalidate(const std::string& key);
+  void clear();
+
+
+  // ---- GETTERS AND SETTERS ----
+  // Sets the total byte budget, zero disables caching
+  void set_capacity(std::size_t capacity);
+  std::size_t get_capacity() const { return capacity_; }
+  CacheStats stats() const;
+
+private:
+  // ---- PARAMETERS ----
+  struct Entry {
+    std::string key;
+    ObjectViewPtr view;
+  };
+
+  struct Shard {
+    mutable std::mutex mutex;
+    std::list<Entry> lru;  // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> entries;
+    std::size_t bytes = 0;
+    std::size_t capacity = 0;
+    // Bumped by every invalidation so stale fills can be detected
+    uint64_t generation = 0;
+    std::array<std::array<uint8_t, SKETCH_WIDTH>, SKETCH_DEPTH> sketch{};
+    std::size_t sketch_accesses = 0;
+  };
+
+  std::atomic<std::size_t> capacity_;
+  std::array<Shard, SHARD_COUNT> shards_;
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::atomic<uint64_t> rejections_{0};
+
+
+  // ---- UTILITY METHODS ----
+  Shard& shard_for(std::size_t hash);
+  // Records an access in the shard's frequency sketch, shard lock held
+  static void record_access(Shard& shard, std::size_t hash);
+  // Estimates how often a key was accessed recently, shard lock held
+  static uint8_t estimate_frequency(const Shard& shard, std::size_t hash);
+  // Evicts least recently used entries until the shard fits its budget
+  void evict_to_capacity(Shard& shard);
+};
+
+} // namespace store
+} // namespace dfs
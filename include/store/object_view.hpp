@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <ostream>
+#include <span>
+#include <vector>
+#include "store/io_scheduler.hpp"
+
+namespace dfs {
+namespace store {
+
+// Read-only view of a stored object. Small and medium objects are memory
+// mapped so callers read the page cache directly; objects above the mapping
+// limit fall back to positioned reads on the open descriptor. Views are
+// shared and keep their mapping alive after the object is removed. An
+// unmapped view given a scheduler admits each positioned read on its own,
+// so a view held by a cache or a caller never occupies an I/O slot.
+class ObjectView {
+public:
+  // Objects larger than this are served through pread instead of mmap
+  static constexpr std::uintmax_t MMAP_LIMIT = std::uintmax_t{1} << 32;  // 4GB
+  // Chunk size used when streaming unmapped views
+  static constexpr std::size_t READ_CHUNK_SIZE = 1024 * 1024;
+
+  // Delete copy operations, views are shared through shared_ptr
+  ObjectView(const ObjectView&) = delete;
+  ObjectView& operator=(const ObjectView&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  // Opens a file as a view, mapping it lazily unless it exceeds mmap_limit.
+  // Positioned reads of an unmapped view are admitted by scheduler in
+  // io_class, which must outlive the view
+  static std::shared_ptr<const ObjectView> open(const std::filesystem::path& path,
+                                                std::uintmax_t mmap_limit = MMAP_LIMIT,
+                                                IoScheduler* scheduler = nullptr,
+                                                IoClass io_class = IoClass::Foreground);
+  // Wraps an owned buffer, used for objects assembled in memory
+  static std::shared_ptr<const ObjectView> from_buffer(std::vector<char> buffer);
+  ~ObjectView();
+
+
+  // ---- READ OPERATIONS ----
+  // Copies up to length bytes starting at offset, returns bytes copied
+  std::size_t read(std::uintmax_t offset, char* output, std::size_t length) const;
+  // Writes the whole object to the output stream
+  void write_to(std::ostream& output) const;
+  // Writes up to length bytes starting at offset, returns bytes written
+  std::uintmax_t write_range_to(std::ostream& output, std::uintmax_t offset, std::uintmax_t length) const;
+
+
+  // ---- GETTERS ----
+  // Contiguous bytes of the object, empty unless is_contiguous()
+  std::span<const char> bytes() const { return {data_, contiguous_ ? size_ : 0}; }
+  bool is_contiguous() const { return contiguous_; }
+  bool is_mapped() const { return mapped_; }
+  std::uintmax_t size() const { return size_; }
+
+private:
+  // ---- PARAMETERS ----
+  int fd_ = -1;
+  const char* data_ = nullptr;
+  std::uintmax_t size_ = 0;
+  bool mapped_ = false;
+  bool contiguous_ = false;
+  std::vector<char> buffer_;
+  IoScheduler* scheduler_ = nullptr;  // Admits the reads of unmapped views
+  IoClass io_class_ = IoClass::Foreground;
+
+  ObjectView() = default;
+};
+
+using ObjectViewPtr = std::shared_ptr<const ObjectView>;
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <istream>
+#include <string>
+
+namespace dfs {
+namespace store {
+
+class Store;
+enum class ObjectOrigin : uint8_t;
+
+// Streaming sink for one object whose size is known up front, returned by
+// Store::open_writer. Space for the expected size is preallocated so large
+// objects are laid out contiguously, appended buffers go straight to a temp
+// file and commit() publishes the object atomically. A writer destroyed
+// without commit() discards everything written.
+class ObjectWriter {
+public:
+  // Delete copy operations, the writer owns its temp file
+  ObjectWriter(const ObjectWriter&) = delete;
+  ObjectWriter& operator=(const ObjectWriter&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  // Aborts the write unless it was committed
+  ~ObjectWriter();
+
+
+  // ---- WRITE OPERATIONS ----
+  // Appends length bytes to the object
+  void append(const char* data, size_t length);
+  // Appends the rest of the input stream to the object
+  void append(std::istream& input);
+  // Trims unused preallocated space and publishes the object under its key
+  void commit();
+  // Discards the temp file, the key keeps its previous content
+  void abort();
+
+
+  // ---- GETTERS ----
+  uint64_t bytes_written() const { return written_; }
+  uint64_t expected_size() const { return expected_size_; }
+  // False if the filesystem does not support preallocation
+  bool is_preallocated() const { return preallocated_; }
+
+private:
+  friend class Store;
+
+  // ---- PARAMETERS ----
+  Store& store_;
+  std::string key_;
+  std::string hash_;
+  std::filesystem::path temp_path_;
+  int fd_;
+  uint64_t expected_size_;
+  uint32_t volume_;
+  ObjectOrigin origin_;
+  uint64_t written_ = 0;
+  uint32_t checksum_ = 0;  // CRC-32C of the data appended so far
+  bool preallocated_ = false;
+  bool finished_ = false;
+
+
+  // ---- CONSTRUCTOR ----
+  // Created through Store::open_writer, takes ownership of fd
+  ObjectWriter(Store& store, const std::string& key, const std::string& hash,
+               const std::filesystem::path& temp_path, int fd, uint64_t expected_size,
+               uint32_t volume, ObjectOrigin origin);
+
+
+  // ---- UTILITY METHODS ----
+  // Reserves expected_size_ bytes without changing the file size
+  void preallocate();
+  // Throws StoreError once the writer was committed or aborted
+  void check_open() const;
+};
+
+} // namespace store
+} // namespace dfs
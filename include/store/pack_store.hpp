@@ -0,0 +1,135 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "io_scheduler.hpp"
+
+namespace dfs {
+namespace store {
+
+// Log-structured backend for small objects. Objects are appended to large
+// segment files instead of getting a file each, and located through an
+// in-memory map from hash to segment offset that is rebuilt by scanning the
+// segments on startup. Removes append tombstones; segments whose data is
+// mostly dead are rewritten by a background compaction thread, admitted as
+// background I/O when a scheduler is given.
+class PackStore {
+public:
+  // Objects larger than this keep the file-per-object layout
+  static constexpr size_t MAX_OBJECT_SIZE = 64 * 1024;
+  // Active segment size at which a new segment is started
+  static constexpr uint64_t SEGMENT_SIZE = 64 * 1024 * 1024;
+  // Fraction of dead bytes at which a segment is compacted
+  static constexpr double COMPACT_DEAD_RATIO = 0.5;
+  static constexpr std::chrono::seconds COMPACT_INTERVAL{30};
+  // Live bytes read per batch before compaction briefly locks to move them
+  static constexpr size_t COMPACT_BATCH_SIZE = 4 * 1024 * 1024;
+  static constexpr char SEGMENT_EXTENSION[] = ".seg";
+
+  // Delete copy operations, the pack store owns segment descriptors
+  PackStore(const PackStore&) = delete;
+  PackStore& operator=(const PackStore&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  // Scans existing segments in directory and starts the compaction thread
+  explicit PackStore(const std::filesystem::path& directory, IoScheduler* scheduler = nullptr);
+  // Stops the compaction thread and closes all segments
+  ~PackStore();
+
+
+  // ---- PACK OPERATIONS ----
+  // Appends an object, replacing any earlier object with the same hash
+  void put(const std::string& hash, const char* data, size_t length);
+  // Returns the object bytes. Throws StoreError if the hash is not packed
+  std::vector<char> read(const std::string& hash) const;
+  // Appends a tombstone, returns false if the hash is not packed
+  bool remove(const std::string& hash);
+  bool contains(const std::string& hash) const;
+  std::optional<uint64_t> size_of(const std::string& hash) const;
+  // Flushes appended records to stable storage
+  void sync();
+  // Rewrites segments over the dead ratio, returns bytes reclaimed
+  uint64_t compact();
+
+
+  // ---- GETTERS ----
+  size_t object_count() const;
+  // Hashes of all live packed objects
+  std::vector<std::string> hashes() const;
+  size_t segment_count() const;
+  uint64_t dead_bytes() const;
+  // Total size of all segments on disk
+  uint64_t disk_bytes() const;
+
+private:
+  // ---- PARAMETERS ----
+  // Position of an object's data within a segment
+  struct Location {
+    uint32_t segment;
+    uint64_t offset;
+    uint64_t length;
+  };
+
+  struct Segment {
+    int fd = -1;
+    uint64_t size = 0;        // Bytes written, including record headers
+    uint64_t dead_bytes = 0;  // Bytes of superseded records and tombstones
+  };
+
+  std::filesystem::path directory_;
+  IoScheduler* scheduler_;
+  std::unordered_map<std::string, Location> locations_;
+  // Segment holding the latest tombstone of each removed hash. Tombstones
+  // count as dead bytes but are kept while older segments may hold the object
+  std::unordered_map<std::string, uint32_t> tombstones_;
+  std::map<uint32_t, Segment> segments_;
+  uint32_t active_segment_ = 0;
+  mutable std::shared_mutex mutex_;
+
+  // Serializes compactions, which alone close segments outside the destructor
+  std::mutex compact_mutex_;
+
+  std::thread compactor_;
+  std::mutex compactor_mutex_;
+  std::condition_variable compactor_cv_;
+  bool running_ = true;
+  bool compact_requested_ = false;
+
+
+  // ---- SEGMENT MANAGEMENT ----
+  // Rebuilds the location map from one segment, truncating a torn tail
+  void scan_segment(uint32_t id);
+  // Opens a new empty active segment, exclusive lock held
+  void start_segment(uint32_t id);
+  // Appends one record to the active segment, exclusive lock held. Starts a
+  // new segment first if the active one is full. Returns the data offset
+  uint64_t append_record(uint8_t op, const std::string& hash, const char* data, size_t length);
+  // Marks a record's bytes as dead in its segment, exclusive lock held
+  void mark_dead(uint32_t segment, uint64_t record_size);
+  // True if enough of a segment is dead to rewrite it, lock held
+  static bool needs_compaction(const Segment& segment);
+  // Copies the live records of a sealed segment to the active one and
+  // deletes it, compaction lock held. Records are read without the map lock,
+  // which is taken exclusively only to move them. Returns bytes reclaimed
+  uint64_t rewrite_segment(uint32_t id);
+  std::filesystem::path get_segment_path(uint32_t id) const;
+  static uint64_t record_size(size_t hash_length, uint64_t data_length);
+
+
+  // ---- BACKGROUND COMPACTION ----
+  void compaction_loop();
+};
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <sys/types.h>
+#include <unistd.h>
+
+namespace dfs {
+namespace store {
+namespace io {
+
+// Writes the whole buffer, retrying on short writes and EINTR
+inline bool write_all(int fd, const char* data, size_t length) {
+  while (length > 0) {
+    ssize_t n = ::write(fd, data, length);
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n <= 0) {
+      return false;
+    }
+    data += n;
+    length -= static_cast<size_t>(n);
+  }
+  return true;
+}
+
+// Reads up to length bytes at offset, stopping early only at end of file.
+// Returns bytes read or -1 on error
+inline ssize_t pread_all(int fd, char* data, size_t length, uint64_t offset) {
+  size_t total = 0;
+  while (total < length) {
+    ssize_t n = ::pread(fd, data + total, length - total, static_cast<off_t>(offset + total));
+    if (n < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n < 0) {
+      return -1;
+    }
+    if (n == 0) {
+      break;
+    }
+    total += static_cast<size_t>(n);
+  }
+  return static_cast<ssize_t>(total);
+}
+
+} // namespace io
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,90 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <mutex>
+#include <thread>
+#include "io_scheduler.hpp"
+
+namespace dfs {
+namespace store {
+
+// Deletes files in the background. A deletion renames the file or directory
+// into the trash directory, which is its tombstone, and returns at once; a
+// reclaimer thread then unlinks tombstones in throttled batches and prunes
+// fan-out directories a deletion left empty. Trashed directories are taken
+// apart one entry at a time, so even clearing a whole store never stalls the
+// thread for longer than one batch. Tombstones left by a crash or shutdown
+// are queued again when the next reclaimer starts. With a scheduler, each
+// batch is admitted as background I/O.
+class Reclaimer {
+public:
+  static constexpr size_t BATCH_SIZE = 256;
+  static constexpr std::chrono::milliseconds DEFAULT_INTERVAL{10};
+
+  // Delete copy operations, the reclaimer owns a worker thread
+  Reclaimer(const Reclaimer&) = delete;
+  Reclaimer& operator=(const Reclaimer&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  // Creates the trash directory inside root and queues tombstones found there
+  Reclaimer(const std::filesystem::path& root, const std::filesystem::path& trash_directory,
+            std::chrono::milliseconds interval = DEFAULT_INTERVAL, IoScheduler* scheduler = nullptr);
+  // Stops after the current batch, remaining tombstones stay in the trash
+  ~Reclaimer();
+
+
+  // ---- RECLAIM OPERATIONS ----
+  // Moves path into the trash and queues it for deletion. Returns false if
+  // path does not exist
+  bool bury(const std::filesystem::path& path);
+  // Blocks until every queued tombstone has been reclaimed
+  void drain();
+
+
+  // ---- GETTERS AND SETTERS ----
+  // Sets the pause between batches, which bounds the deletion rate
+  void set_interval(std::chrono::milliseconds interval);
+  const std::filesystem::path& get_trash_directory() const { return trash_; }
+  uint64_t get_reclaimed_count() const { return reclaimed_; }
+  size_t get_pending_count() const;
+
+private:
+  // ---- PARAMETERS ----
+  struct Tombstone {
+    std::filesystem::path path;
+    // Directory the entry was deleted from, pruned up to root once empty
+    std::filesystem::path origin;
+  };
+
+  std::filesystem::path root_;
+  std::filesystem::path trash_;
+  std::chrono::milliseconds interval_;
+  IoScheduler* scheduler_;
+  std::deque<Tombstone> queue_;
+  size_t in_progress_ = 0;
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::condition_variable drained_cv_;
+  bool running_ = true;
+  std::atomic<uint64_t> next_id_;
+  std::atomic<uint64_t> reclaimed_{0};
+  std::thread worker_;
+
+
+  // ---- RECLAIM PROCESSING ----
+  // Takes batches off the queue until stopped
+  void reclaim_loop();
+  // Unlinks files and empty directories, and queues the entries of full ones
+  void reclaim_batch(std::deque<Tombstone>& batch);
+  // Removes empty directories from directory up to, excluding, root
+  void prune(std::filesystem::path directory) const;
+};
+
+} // namespace store
+} // namespace dfs
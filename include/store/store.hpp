@@ -1,31 +1,138 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
 #include <filesystem>
 #include <fstream>
+#include <functional>
+#include <future>
 #include <memory>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
 #include <stdexcept>
 #include <string>
 #include <sstream>
+#include <thread>
 #include <vector>
 #include <openssl/evp.h>
 #include <openssl/sha.h>
 #include "../logger/logger.hpp"
+#include "access_tracker.hpp"
+#include "chunker.hpp"
+#include "crc32c.hpp"
+#include "group_commit.hpp"
+#include "io_ring.hpp"
+#include "io_scheduler.hpp"
+#include "key_locks.hpp"
+#include "lz_codec.hpp"
+#include "object_cache.hpp"
+#include "object_view.hpp"
+#include "object_writer.hpp"
+#include "pack_store.hpp"
+#include "reclaimer.hpp"
+#include "store_index.hpp"
+#include "store_scanner.hpp"
 
 namespace dfs {
 namespace store {
 
+// How Store::store publishes new objects
+enum class Durability {
+  Atomic,      // Write to a temp file and rename into place, no fsync
+  GroupCommit  // Additionally fsync in batches shared by concurrent writers
+};
+
+// How Store performs file I/O
+enum class IoBackend {
+  Blocking,  // Synchronous system calls on the calling thread
+  Uring      // Asynchronous submissions through an io_uring
+};
+
+// Where a stored object came from
+enum class ObjectOrigin : uint8_t {
+  Local,   // Stored by this node, never evicted
+  Replica  // Received from a peer, evicted first when over capacity
+};
+
+// Storage class of a volume
+enum class StorageTier : uint8_t {
+  Fast,  // Receives new objects, e.g. NVMe
+  Slow   // Receives cold objects demoted from the fast tier, e.g. HDD
+};
+
+// When the migrator moves objects between fast and slow volumes
+struct TieringPolicy {
+  uint64_t fast_capacity = 0;                // Movable object bytes the fast tier may hold, zero disables migration
+  double low_water = 0.8;                    // Demotion continues until usage falls to this fraction
+  std::chrono::seconds min_age{60};          // Objects stored more recently are never demoted
+  std::chrono::milliseconds interval{1000};  // Pause between background migration passes
+  uint32_t promote_score = 4;                // Aged reads after which a slow object returns to the fast tier, zero disables promotion
+};
+
+// How the scrubber re-reads stored objects to find silent corruption
+struct ScrubPolicy {
+  std::chrono::milliseconds interval{0};     // Pause between background passes, zero disables the scrubber
+  uint64_t bytes_per_second = 64ull << 20;  // Average read rate of a pass, zero means unlimited
+};
+
+// Counters describing what scrubbing and verified reads found
+struct ScrubStats {
+  uint64_t passes = 0;
+  uint64_t objects = 0;  // Objects verified by the scrubber
+  uint64_t bytes = 0;    // Logical bytes verified by the scrubber
+  uint64_t corrupt = 0;  // Checksum mismatches found by the scrubber or verified reads
+};
+
+// Counters describing how new objects compressed
+struct CompressionStats {
+  uint64_t compressed_objects = 0;
+  uint64_t incompressible_objects = 0;  // Stored raw after their first blocks did not compress
+  uint64_t input_bytes = 0;             // Original size of the compressed objects
+  uint64_t stored_bytes = 0;            // Their size on disk
+};
+
 class Store {
 public:
+  friend class ObjectWriter;
+
+  // Default number of names returned by one list() call
+  static constexpr size_t LIST_PAGE_SIZE = 1000;
 
   // ---- CONSTRUCTOR AND DESTRUCTOR ----
-  explicit Store(const std::string& base_path);
+  // Opens the store. With scan_on_open, also runs a repairing scan of its
+  // tree, whose cost grows with the number of objects. Without it the index
+  // keeps the authoritative state persisted by the last such scan, so objects
+  // it has never seen are still found through the filesystem
+  explicit Store(const std::string& base_path, bool scan_on_open = false);
+  // Stops the migrator before the volumes it moves objects between close
+  ~Store();
 
 
   // ---- CORE STORAGE OPERATIONS ----
-  // stores data stream under given key
-  void store(const std::string& key, std::istream& data);
+  // stores data stream under given key. Storing a replica over a local
+  // object keeps it local. May evict replicas to stay within capacity
+  void store(const std::string& key, std::istream& data, ObjectOrigin origin = ObjectOrigin::Local);
+  // Opens a sink that streams an object of about expected_size bytes to a
+  // preallocated file, published under key when the writer is committed.
+  // Streamed objects always use the file-per-object layout
+  std::unique_ptr<ObjectWriter> open_writer(const std::string& key, uint64_t expected_size,
+                                            ObjectOrigin origin = ObjectOrigin::Local);
   // Retrieves data stream using given key
   void get(const std::string& key, std::stringstream& output);
+  // Opens a shared read-only view of the data stored under given key
+  ObjectViewPtr open_view(const std::string& key) const;
+  // Writes up to length bytes starting at offset, reading only that range
+  // from disk. Returns bytes written, throws StoreError past the object end
+  std::uintmax_t get_range(const std::string& key, std::uintmax_t offset, std::uintmax_t length,
+                           std::ostream& output) const;
+  // Reads the object under key without blocking the caller. With the
+  // io_uring backend raw objects are opened and read on the ring, other
+  // layouts are read before returning
+  std::future<ObjectViewPtr> read_async(const std::string& key) const;
   // Removes data associated with given key
   void remove(const std::string& key);
   // Removes all stored data and reset store
@@ -37,6 +144,111 @@ public:
   bool has(const std::string& key) const;
   // Returns the size of the stored file in bytes
   std::uintmax_t get_file_size(const std::string& key) const;
+  // Lists stored filenames with their sizes and store times from the sorted
+  // catalog, one page of at most limit names after cursor. Objects unknown to
+  // a non-authoritative index are not listed
+  ListPage list(const std::string& prefix, const std::string& cursor = "",
+                size_t limit = LIST_PAGE_SIZE) const;
+
+
+  // ---- CONFIGURATION ----
+  // Enables content-defined chunking with chunk-level deduplication for new objects
+  void set_chunking(bool enabled) { chunking_enabled_ = enabled; }
+  bool is_chunking_enabled() const { return chunking_enabled_; }
+  // Compresses new object files block by block. Objects whose first blocks
+  // do not compress are stored raw. Chunked and packed objects stay raw
+  void set_compression(bool enabled) { compression_enabled_ = enabled; }
+  bool is_compression_enabled() const { return compression_enabled_; }
+  CompressionStats get_compression_stats() const;
+  // Checks whole-object reads against the checksum recorded at store time.
+  // A mismatch throws StoreError instead of serving the data
+  void set_verify_reads(bool enabled) { verify_reads_ = enabled; }
+  bool is_verify_reads_enabled() const { return verify_reads_; }
+  // Selects whether store() returns before or after its data is durable
+  void set_durability(Durability mode);
+  Durability get_durability() const { return durability_; }
+  // Sets how long the group committer waits to batch concurrent writes
+  void set_commit_window(std::chrono::microseconds window);
+  // Enables appending small objects to pack segments for new writes
+  void set_packing(bool enabled);
+  bool is_packing_enabled() const { return packing_enabled_; }
+  // Returns the group committer, or nullptr outside GroupCommit mode
+  const GroupCommitter* get_group_committer() const { return committer_.get(); }
+  // Returns the pack backend, or nullptr if no segments exist
+  const PackStore* get_pack_store() const { return pack_.get(); }
+  // Sets the byte budget of the read cache, zero disables it
+  void set_cache_capacity(std::size_t bytes) { cache_.set_capacity(bytes); }
+  CacheStats get_cache_stats() const { return cache_.stats(); }
+  // Selects the I/O backend, falling back to Blocking if io_uring is unavailable
+  void set_io_backend(IoBackend backend);
+  IoBackend get_io_backend() const { return ring_ ? IoBackend::Uring : IoBackend::Blocking; }
+  // Returns the I/O ring, or nullptr with the Blocking backend
+  const IoRing* get_io_ring() const { return ring_.get(); }
+  // Sets the bandwidth, IOPS, concurrency and deadline of an I/O priority class
+  void set_io_budget(IoClass io_class, const IoBudget& budget) { scheduler_.set_budget(io_class, budget); }
+  // Returns the scheduler admitting disk I/O. Reads and local writes are
+  // Foreground, replica writes Replication and maintenance work Background
+  const IoScheduler& get_io_scheduler() const { return scheduler_; }
+  // Sets the byte budget for stored objects, zero means unlimited. Replicas
+  // are evicted, least valuable first, while the budget is exceeded
+  void set_capacity(uint64_t bytes);
+  uint64_t get_capacity() const { return capacity_; }
+  // Logical bytes of all stored objects
+  uint64_t get_used_bytes() const { return index_->total_bytes(); }
+  uint64_t get_eviction_count() const { return evictions_; }
+  // Number of key lock acquisitions that waited on another operation
+  uint64_t get_lock_contention() const { return locks_.get_contention_count(); }
+  // Adds a directory, normally on another disk, that object files are spread
+  // across. New objects go to fast volumes, slow volumes only receive objects
+  // demoted by the migrator. Volumes are recorded under the base path and
+  // reopened with the store. Must not run concurrently with other operations
+  void add_volume(const std::string& path, StorageTier tier = StorageTier::Fast);
+  // Roots of all volumes, the base path first
+  std::vector<std::filesystem::path> get_volumes() const;
+  StorageTier get_volume_tier(uint32_t volume) const { return volumes_.at(volume)->tier; }
+  // Sets when cold objects move to slow volumes and starts the background
+  // migrator. A zero fast capacity stops it
+  void set_tiering(const TieringPolicy& policy);
+  TieringPolicy get_tiering() const;
+  // Tier holding the object under key, nullopt if it is not stored
+  std::optional<StorageTier> get_tier(const std::string& key) const;
+  // Logical bytes of objects stored on volumes of tier
+  uint64_t get_tier_bytes(StorageTier tier) const;
+  uint64_t get_demotion_count() const { return demotions_; }
+  uint64_t get_promotion_count() const { return promotions_; }
+  // Sets how often and how fast the background scrubber verifies stored
+  // objects and starts it. A zero interval stops it
+  void set_scrubbing(const ScrubPolicy& policy);
+  ScrubPolicy get_scrubbing() const;
+  ScrubStats get_scrub_stats() const;
+  // Keys whose content did not match its checksum, until they are rewritten
+  std::vector<std::string> get_corrupt_objects() const;
+  // CRC-32C of the content stored under key, nullopt if it was not recorded
+  std::optional<uint32_t> get_checksum(const std::string& key) const;
+
+
+  // ---- MAINTENANCE ----
+  // Deletes chunks no longer referenced by any manifest, returns bytes reclaimed.
+  // Waits for pending background deletions first
+  std::uintmax_t collect_garbage();
+  // Rewrites pack segments that are mostly dead and returns bytes reclaimed
+  std::uintmax_t compact_packs();
+  // Walks the tree in parallel and checks it against the index. With repair,
+  // removes orphaned temp files, empty fan-out directories and dangling index
+  // entries, and marks whether the index covers every object on disk
+  ScanReport scan(bool repair);
+  // Blocks until files deleted so far have been unlinked in the background
+  void flush_deletes();
+  // Number of tombstones, including trashed directories and their entries, not yet reclaimed
+  size_t get_pending_deletes() const;
+  // Sets the pause between background deletion batches
+  void set_reclaim_interval(std::chrono::milliseconds interval);
+  // Runs one migration pass now, promoting slow objects read often enough
+  // and then demoting cold ones. Returns the number of objects demoted
+  size_t migrate_cold_objects();
+  // Runs one scrub pass now at the policy's rate, returns the number of
+  // corrupt objects found. Corrupt replicas are dropped
+  size_t scrub_objects();
 
 
   // ---- CLI COMMAND SUPPORT ----
@@ -50,28 +262,352 @@ private:
   // ---- PARAMETERS ----
   // Root path for all stored files
   std::filesystem::path base_path_;
+  // Admits disk I/O by priority class, declared before the volumes and pack
+  // store whose background threads use it
+  mutable IoScheduler scheduler_;
+  // Persistent filename index answering has()/get_file_size() from memory
+  std::unique_ptr<StoreIndex> index_;
+  // Durability settings, the committer is declared after the index it syncs
+  Durability durability_ = Durability::Atomic;
+  std::chrono::microseconds commit_window_ = GroupCommitter::DEFAULT_WINDOW;
+  std::unique_ptr<GroupCommitter> committer_;
+  // Marks in-progress temp files, which are renamed over their final path
+  static constexpr char TEMP_SUFFIX[] = ".tmp.";
+  // Small objects are appended to segments in this directory when packing is enabled
+  static constexpr char PACK_DIRECTORY[] = ".packs";
+  bool packing_enabled_ = false;
+  std::unique_ptr<PackStore> pack_;
+  // Deleted files are renamed into this directory of their volume and unlinked in the background
+  static constexpr char TRASH_DIRECTORY[] = ".trash";
+  // Object file volumes, the base path first. Index entries record the
+  // position of their volume, additional volumes are listed in VOLUMES_FILENAME
+  struct Volume {
+    std::filesystem::path root;
+    StorageTier tier = StorageTier::Fast;
+    std::unique_ptr<Reclaimer> reclaimer;
+    std::atomic<uint64_t> free_bytes{0};
+  };
+  static constexpr char VOLUMES_FILENAME[] = ".dfs_volumes";
+  static constexpr size_t MAX_VOLUMES = (INDEX_VOLUME_MASK >> INDEX_VOLUME_SHIFT) + 1;
+  // Free space, which weights placement, is re-read after this many placements
+  static constexpr uint64_t VOLUME_REFRESH_INTERVAL = 256;
+  std::vector<std::unique_ptr<Volume>> volumes_;
+  std::atomic<uint64_t> placements_{0};
+  // Suffix of slow volume lines in VOLUMES_FILENAME
+  static constexpr char SLOW_TIER_TAG[] = "\tslow";
+  // Tiering policy and the thread applying it. A migration pass holds
+  // migration_mutex_, which add_volume(), clear() and move_dir() take too
+  TieringPolicy tiering_;
+  std::mutex migration_mutex_;
+  std::thread migrator_;
+  mutable std::mutex migrator_mutex_;
+  std::condition_variable migrator_cv_;
+  bool migrator_running_ = false;
+  std::atomic<uint64_t> demotions_{0};
+  std::atomic<uint64_t> promotions_{0};
+  // Demotion candidates ranked by the last index walk, coldest first, and
+  // consumed by later passes. The walk is repeated once they run out, but
+  // not before the youngest object it skipped is old enough to move.
+  // Guarded by migration_mutex_
+  struct DemotionCandidate {
+    std::string key;
+    std::string hash;
+    uint32_t score;
+  };
+  std::deque<DemotionCandidate> demotion_queue_;
+  std::chrono::system_clock::time_point next_ranking_{};
+  // Slow objects read often enough to be promoted by the next pass, guarded
+  // by migrator_mutex_
+  mutable std::set<std::string> promotion_queue_;
+  // Object files are copied between tiers in blocks of this size
+  static constexpr size_t MIGRATION_BUFFER_SIZE = 1024 * 1024;
+  // Scrub policy and the thread applying it. migration_mutex_ is held only
+  // while a key is re-checked, never while its object is read
+  bool verify_reads_ = false;
+  ScrubPolicy scrubbing_;
+  std::thread scrubber_;
+  mutable std::mutex scrubber_mutex_;
+  std::condition_variable scrubber_cv_;
+  bool scrubber_running_ = false;
+  // Set while the store shuts down so a paced pass stops waiting
+  bool scrub_cancelled_ = false;
+  std::atomic<uint64_t> scrub_passes_{0};
+  std::atomic<uint64_t> scrubbed_objects_{0};
+  std::atomic<uint64_t> scrubbed_bytes_{0};
+  mutable std::atomic<uint64_t> corruptions_{0};
+  mutable std::mutex corrupt_mutex_;
+  mutable std::set<std::string> corrupt_keys_;
+  // Recently read objects, invalidated whenever a key is written or removed
+  mutable ObjectCache cache_;
+  // Per-key reader/writer locks. Reads share a key, writes and removes own it.
+  // clear() and move_dir() replace the whole store and must not run concurrently
+  mutable KeyLockManager locks_;
+  // Capacity budget and the access statistics that rank replicas for eviction
+  std::atomic<uint64_t> capacity_{0};
+  std::atomic<uint64_t> evictions_{0};
+  std::mutex eviction_mutex_;
+  // Replicas ranked by the last eviction scan, least valuable first. Later
+  // evictions consume it and only rescan the index once it runs dry
+  std::deque<std::string> eviction_queue_;
+  // Replicas indexed since the last scan, starting at one so the first
+  // eviction ranks what is already on disk. A scan that found nothing is
+  // not repeated until a new replica arrives
+  std::atomic<uint64_t> replica_writes_{1};
+  mutable AccessTracker access_;
+  // Eviction continues until usage falls to this fraction of the capacity
+  static constexpr double EVICTION_TARGET = 0.9;
+  // Asynchronous I/O ring, declared last so it drains before the members its
+  // completion callbacks use are destroyed
+  std::unique_ptr<IoRing> ring_;
+  // Streamed writes keep this many buffers in flight on the ring
+  static constexpr size_t RING_WRITE_DEPTH = 4;
+  static constexpr size_t RING_BUFFER_SIZE = 256 * 1024;
+  // Chunked storage settings
+  bool chunking_enabled_ = false;
+  Chunker chunker_;
+  // Header identifying a file as a chunk manifest rather than raw content
+  static constexpr char MANIFEST_MAGIC[] = "\0DFS-MANIFEST 1\n";
+  static constexpr size_t MANIFEST_MAGIC_SIZE = sizeof(MANIFEST_MAGIC) - 1;
+  // Chunk files carry this extension so they can be told apart from objects.
+  // Chunks and pack segments always live on the base path volume
+  static constexpr char CHUNK_EXTENSION[] = ".chunk";
+  // Chunked writes share this from their first chunk until their manifest is
+  // published, garbage collection owns it so it never sweeps a reused chunk
+  std::shared_mutex chunk_mutex_;
+  // Compressed storage settings. A compressed object file is its header,
+  // the blocks, one stored length per block and a fixed size footer
+  bool compression_enabled_ = false;
+  static constexpr char COMPRESSED_MAGIC[] = "\0DFS-COMPRESS 1\n";
+  static constexpr size_t COMPRESSED_MAGIC_SIZE = sizeof(COMPRESSED_MAGIC) - 1;
+  static constexpr size_t COMPRESSION_BLOCK_SIZE = 64 * 1024;
+  // Blocks compressed before deciding whether an object is worth compressing
+  static constexpr size_t COMPRESSION_SAMPLE_BLOCKS = 4;
+  // The sample must shrink below this fraction of its size
+  static constexpr double COMPRESSION_MIN_RATIO = 0.9;
+  // Set in a block length when the block is stored uncompressed
+  static constexpr uint32_t RAW_BLOCK_FLAG = 1u << 31;
+  // Footer fields: original size, block index offset, block size, block count
+  static constexpr size_t COMPRESSED_FOOTER_SIZE = 2 * sizeof(uint64_t) + 2 * sizeof(uint32_t);
+  std::atomic<uint64_t> compressed_objects_{0};
+  std::atomic<uint64_t> incompressible_objects_{0};
+  std::atomic<uint64_t> compressed_input_bytes_{0};
+  std::atomic<uint64_t> compressed_stored_bytes_{0};
+
+  // Ordered list of content chunks making up a chunked object
+  struct Manifest {
+    std::uintmax_t total_size = 0;
+    std::vector<std::pair<std::string, std::size_t>> chunks;
+  };
+
+  // Block layout of a compressed object file, read from its index and footer
+  struct BlockIndex {
+    std::uintmax_t original_size = 0;
+    size_t block_size = 0;
+    std::vector<uint64_t> offsets;  // File offset of each block followed by the end of the last
+    std::vector<bool> raw;          // Blocks stored uncompressed
+  };
 
   
   // ---- CLI COMMAND SUPPORT ----
-  bool display_file_contents(std::ifstream& file, const std::string& key, 
+  bool display_file_contents(std::istream& file, const std::string& key, 
     size_t lines_per_page) const;
 
   
   // ---- CAS STORAGE SUPPORT ----
   // Generate SHA-256 hash from key using OpenSSL EVP
   std::string hash_key(const std::string& key) const;
+  // Generate SHA-256 hex digest of an arbitrary byte range
+  std::string hash_bytes(const void* data, size_t length) const;
   // Creates a directory structure using parts of the hash:
-  // {base_path}/{hash[0:2]}/{hash[2:4]}/{hash[4:6]}/{remaining_hash}
-  std::filesystem::path get_path_for_hash(const std::string& hash) const;
+  // {volume_root}/{hash[0:2]}/{hash[2:4]}/{hash[4:6]}/{remaining_hash}
+  std::filesystem::path get_path_for_hash(const std::string& hash, uint32_t volume = 0) const;
+
+
+  // ---- VOLUME MANAGEMENT ----
+  // Opens the base path volume and the volumes listed beside the index
+  void open_volumes();
+  // Adds a volume rooted at root with its own reclaimer
+  void attach_volume(const std::filesystem::path& root, StorageTier tier);
+  // Picks the volume of tier for an object file by rendezvous hashing of its
+  // hash, weighted by each volume's free space. Falls back to every volume if
+  // none belongs to tier
+  uint32_t place_object(const std::string& hash, StorageTier tier = StorageTier::Fast);
+  // Picks the volume for writing hash over previous, keeping overwrites in place
+  // unless the previous copy is packed or was demoted to a slow volume
+  uint32_t volume_for_write(const std::string& hash, const std::optional<IndexEntry>& previous);
+  // Re-reads the free space of every volume
+  void refresh_free_space();
+  // Hands path to the reclaimer of its volume, false if it does not exist
+  bool bury(const std::filesystem::path& path, uint32_t volume);
+  // Finds the volume holding the object file of hash by probing each one
+  std::optional<uint32_t> find_volume(const std::string& hash) const;
+
+
+  // ---- TIERED STORAGE ----
+  // Runs a migration pass every policy interval until stopped
+  void migrate_loop();
+  // Stops and joins the migrator thread if it runs
+  void stop_migrator();
+  // Copies the object file under key to a volume of tier, repoints its index
+  // entry and buries the old copy. Returns false if the object changed, is
+  // not movable or already lives on tier
+  bool move_object(const std::string& key, const std::string& hash, StorageTier tier);
+  // Refills demotion_queue_ with old enough movable objects on the fast tier
+  void rank_demotion_candidates(const TieringPolicy& policy);
+  // Promotes queued slow objects while the fast tier has room, returns the number moved
+  size_t promote_hot_objects(const TieringPolicy& policy);
+  // Queues a slow object for promotion once its access score reaches the policy's
+  void consider_promotion(const std::string& key) const;
+  // Movable object bytes on fast volumes
+  uint64_t fast_file_bytes() const;
+  // Copies the file at source into fd, returns bytes copied
+  uint64_t copy_file_contents(const std::filesystem::path& source, int fd) const;
+
+
+  // ---- INTEGRITY CHECKING ----
+  // Scrubber thread body, runs a pass every policy interval
+  void scrub_loop();
+  // Stops and joins the scrubber if it runs
+  void stop_scrubber();
+  // Verifies one object against its checksum under a shared key lock and
+  // drops it if it is a corrupt replica. Returns false if it was corrupt or
+  // could not be read
+  bool scrub_object(const std::string& key);
+  // Throws StoreError and records the key if view does not match entry's checksum
+  void verify_view(const std::string& key, const IndexEntry& entry, const ObjectView& view) const;
+  // Records a checksum mismatch of key
+  void record_corruption(const std::string& key) const;
+  // CRC-32C of a view's content, reading unmapped views in blocks
+  static uint32_t checksum_view(const ObjectView& view);
+
+
+  // ---- CHUNKED STORAGE SUPPORT ----
+  // Splits data into content-defined chunks and writes their manifest to fd.
+  // Like the other write paths it extends checksum over the bytes consumed
+  size_t store_chunked(int fd, std::istream& data, IoClass io_class, uint32_t& checksum);
+  // Writes a chunk unless an identical one exists, returns true if written.
+  // The chunk's pending commit is appended to pending
+  bool write_chunk(const std::string& hash, const uint8_t* data, size_t length, IoClass io_class,
+                   std::vector<std::future<void>>& pending);
+  // Parses a manifest from file, rewinds and returns false for raw content
+  bool read_manifest(std::istream& file, Manifest& manifest) const;
+  // Parses the manifest of an object indexed as chunked, throws StoreError if it is not one
+  Manifest open_manifest(const std::filesystem::path& path) const;
+  // Reassembles a chunked object into the output stream
+  void stream_chunks(const Manifest& manifest, std::ostream& output) const;
+  // Returns the fan-out path of the chunk with the given content hash
+  std::filesystem::path get_chunk_path(const std::string& hash) const;
+
+
+  // ---- COMPRESSED STORAGE SUPPORT ----
+  // Writes data to fd as compressed blocks, or raw when its first blocks do
+  // not compress. Sets compressed accordingly and returns the bytes consumed
+  size_t store_compressed(int fd, std::istream& data, IoClass io_class, bool& compressed, uint32_t& checksum);
+  // Reads and validates the block index of an open compressed object file
+  BlockIndex read_block_index(int fd, const std::filesystem::path& path) const;
+  // Decompresses blocks [first, last] into output
+  void read_blocks(int fd, const std::filesystem::path& path, const BlockIndex& index, size_t first, size_t last,
+                   std::vector<char>& output) const;
+  // Decompresses a whole compressed object
+  std::vector<char> read_compressed(const std::filesystem::path& path) const;
+  // Writes a byte range of a compressed object to output, decompressing only
+  // the blocks it overlaps. Returns the bytes written
+  std::uintmax_t read_compressed_range(const std::string& key, const std::filesystem::path& path,
+                                       std::uintmax_t offset, std::uintmax_t length, std::ostream& output) const;
 
   
+  // ---- CACHED READ SUPPORT ----
+  // Opens a view of key from disk, bypassing the cache. Key lock held
+  ObjectViewPtr load_view(const std::string& key, IoClass io_class = IoClass::Foreground) const;
+
+
+  // ---- CAPACITY MANAGEMENT ----
+  // Writes the object under key, the key lock is taken and released inside
+  void store_object(const std::string& key, std::istream& data, ObjectOrigin origin);
+  // Returns the index flag for an object of origin replacing previous
+  static uint32_t origin_flags(const std::optional<IndexEntry>& previous, ObjectOrigin origin);
+  // Returns the I/O class writes of an object of origin are scheduled in
+  static IoClass io_class_for(ObjectOrigin origin);
+  // Evicts replicas with the lowest access scores until usage is under the
+  // eviction target. No key lock may be held by the caller
+  void enforce_capacity();
+  // Removes key if it is still a replica, returns false otherwise
+  bool evict_replica(const std::string& key);
+  // Fills eviction_queue_ with every replica ranked by aged access frequency,
+  // then by recency. eviction_mutex_ must be held
+  void rank_replicas();
+
+
+  // ---- ASYNC I/O SUPPORT ----
+  // State of one read_async call while it moves through the ring
+  struct AsyncRead {
+    std::string key;
+    uint64_t ticket = 0;
+    int fd = -1;
+    std::vector<char> buffer;
+    size_t filled = 0;
+    IoScheduler::Grant grant;
+    std::optional<uint32_t> checksum;  // Verified on completion when reads are verified
+    std::promise<ObjectViewPtr> promise;
+  };
+  // Submits the next read of request, or completes it once the buffer is full
+  void continue_async_read(const std::shared_ptr<AsyncRead>& request) const;
+  // Closes the request's file and fails its future with message
+  void fail_async_read(const std::shared_ptr<AsyncRead>& request, const std::string& message) const;
+  // Copies the input stream into fd through the ring with several writes in flight
+  size_t write_stream_async(int fd, std::istream& data, IoClass io_class, uint32_t& checksum);
+
+
+  // ---- PACKED STORAGE SUPPORT ----
+  // Reads the whole stream if it fits a pack record, rewinding it otherwise
+  bool read_small_object(std::istream& data, std::vector<char>& buffer) const;
+  // Opens the pack backend if packing is enabled or segments already exist
+  void open_pack_store();
+  // Deletes the object stored under hash with the layout given by flags,
+  // returns false if it did not exist. Object files are handed to the reclaimer
+  bool remove_object(const std::string& hash, uint32_t flags);
+
+
+  // ---- DURABLE WRITE SUPPORT ----
+  // Copies the input stream into fd extending checksum over it, returns bytes written
+  size_t write_stream(int fd, std::istream& data, IoClass io_class, uint32_t& checksum);
+  // Publishes a written temp file as the object under key and drops any
+  // previous copy in another layout. Key lock held
+  void publish_temp_file(const std::string& key, const std::string& hash, int fd,
+                         const std::filesystem::path& temp_path, size_t size, uint32_t flags,
+                         ObjectOrigin origin, uint32_t checksum);
+  // Locks the key and publishes a committed ObjectWriter's temp file
+  void publish_written_object(const std::string& key, const std::string& hash, int fd,
+                              const std::filesystem::path& temp_path, size_t size, uint32_t volume,
+                              ObjectOrigin origin, uint32_t checksum);
+  // Creates a uniquely named temp file beside final_path and returns its descriptor
+  int open_temp_file(const std::filesystem::path& final_path, std::filesystem::path& temp_path) const;
+  // Publishes a written temp file at final_path, taking ownership of fd. In
+  // GroupCommit mode the returned future completes once the file is durable
+  std::future<void> commit_temp_file(int fd, const std::filesystem::path& temp_path,
+                                     const std::filesystem::path& final_path,
+                                     std::function<void()> on_commit = {});
+
+
   // ---- QUERY OPERATIONS ----
   // Ensures directory exists, create if needed
   void check_directory_exists(const std::filesystem::path& path) const;
-  // Resolves a key to its corresponding filesystem path by generating hash and converting to path
-  std::filesystem::path resolve_key_path(const std::string& key) const;
+  // Returns the key's hash from the index, hashing the key only on a miss
+  std::string lookup_hash(const std::string& key) const;
+  // Returns the index entry of key, learning unindexed objects from disk.
+  // Throws StoreError if the object does not exist
+  IndexEntry lookup_entry(const std::string& key) const;
+  // Records an object in the index after it has been written
+  void index_object(const std::string& key, const std::string& hash, std::uintmax_t size, uint32_t flags,
+                    uint32_t checksum);
+  // Indexes an object found on disk but missing from a non-authoritative index
+  std::optional<IndexEntry> learn_object(const std::string& key) const;
   // Verifies if a file exists at the given path, throws StoreError if not found
   void verify_file_exists(const std::filesystem::path& file_path) const;
+  // True if a temp file's writing process no longer exists
+  bool is_orphaned_temp_file(const std::filesystem::path& path) const;
+  // Throws StoreError if offset lies past the end of an object of size bytes
+  void check_range(const std::string& key, std::uintmax_t offset, std::uintmax_t size) const;
 };
 
 class StoreError : public std::runtime_error {
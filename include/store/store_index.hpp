@@ -0,0 +1,163 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <shared_mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace dfs {
+namespace store {
+
+// Flags describing how an indexed object is laid out on disk
+enum IndexFlag : uint32_t {
+  INDEX_FLAG_CHUNKED = 1u << 0,  // Object file is a chunk manifest
+  INDEX_FLAG_PACKED = 1u << 1,   // Object lives in a pack segment
+  INDEX_FLAG_REPLICA = 1u << 2,  // Copy received from a peer, may be evicted
+  INDEX_FLAG_COMPRESSED = 1u << 3,  // Object file holds compressed blocks
+  INDEX_FLAG_CHECKSUM = 1u << 4     // Entry carries a checksum of the object's content
+};
+
+// The top flag bits hold the volume an object file was placed on. Entries
+// written before volumes existed read as volume zero, the store's base path
+constexpr uint32_t INDEX_VOLUME_SHIFT = 24;
+constexpr uint32_t INDEX_VOLUME_MASK = 0xFFu << INDEX_VOLUME_SHIFT;
+constexpr uint32_t INDEX_LAYOUT_MASK = INDEX_FLAG_CHUNKED | INDEX_FLAG_PACKED | INDEX_FLAG_COMPRESSED;
+
+// Metadata kept for every stored filename
+struct IndexEntry {
+  std::string hash;          // SHA-256 of the filename, locates the object
+  std::uintmax_t size = 0;   // Logical object size in bytes
+  int64_t mtime = 0;         // Store time in nanoseconds since epoch
+  uint32_t flags = 0;        // Combination of IndexFlag values and the volume
+  uint32_t checksum = 0;     // CRC-32C of the logical content, valid with INDEX_FLAG_CHECKSUM
+
+  uint32_t volume() const { return flags >> INDEX_VOLUME_SHIFT; }
+};
+
+// One filename returned by a catalog listing
+struct ListEntry {
+  std::string name;
+  std::uintmax_t size = 0;
+  int64_t mtime = 0;
+};
+
+// A page of a catalog listing. Passing next_cursor to the following call
+// continues after the last returned name, it is empty on the final page
+struct ListPage {
+  std::vector<ListEntry> entries;
+  std::string next_cursor;
+};
+
+// Concurrent in-memory map of filename to object metadata. The map is
+// persisted as a snapshot file, loaded through mmap on startup, plus an
+// append-only journal of changes made since that snapshot was written.
+// Filenames are also kept in a sorted catalog, so listing a prefix costs a
+// tree descent plus the page size, independent of the number of objects.
+class StoreIndex {
+public:
+  static constexpr char SNAPSHOT_FILENAME[] = ".dfs_index";
+  static constexpr char JOURNAL_FILENAME[] = ".dfs_journal";
+  // Journal records written before the snapshot is rewritten, at least
+  static constexpr size_t COMPACT_THRESHOLD = 4096;
+  // Larger snapshots are rewritten once the journal reaches 1/COMPACT_RATIO
+  // of their entries, keeping the rewrite cost per append constant
+  static constexpr size_t COMPACT_RATIO = 2;
+  static constexpr size_t SHARD_COUNT = 16;
+  static constexpr size_t VOLUME_COUNT = (INDEX_VOLUME_MASK >> INDEX_VOLUME_SHIFT) + 1;
+
+  // Delete copy operations, the index owns the journal descriptor
+  StoreIndex(const StoreIndex&) = delete;
+  StoreIndex& operator=(const StoreIndex&) = delete;
+
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  // Loads snapshot and journal from directory, creating them if absent
+  explicit StoreIndex(const std::filesystem::path& directory);
+  ~StoreIndex();
+
+
+  // ---- INDEX OPERATIONS ----
+  std::optional<IndexEntry> lookup(const std::string& key) const;
+  void put(const std::string& key, const IndexEntry& entry);
+  void erase(const std::string& key);
+  // Drops all entries and persisted state
+  void clear();
+  // Rewrites the snapshot and truncates the journal
+  void compact();
+  // Flushes journal records to stable storage
+  void sync();
+  // Calls visit for every entry, one shard locked at a time
+  void for_each(const std::function<void(const std::string&, const IndexEntry&)>& visit) const;
+  // Returns up to limit filenames starting with prefix in sorted order,
+  // beginning after cursor
+  ListPage list(const std::string& prefix, const std::string& cursor, size_t limit) const;
+
+
+  // ---- GETTERS ----
+  std::size_t size() const;
+  // Sum of the logical sizes of all indexed objects
+  uint64_t total_bytes() const { return total_bytes_; }
+  // Sum of the logical sizes of objects on volume that have a file of their
+  // own, so neither chunked nor packed
+  uint64_t file_bytes(uint32_t volume) const { return file_bytes_[volume]; }
+  // True when every object in the directory is known to the index, so a
+  // lookup miss means the object does not exist
+  bool is_authoritative() const { return authoritative_; }
+  // Set after a full scan shows whether the index covers every object on
+  // disk. A change is persisted in the snapshot header
+  void set_authoritative(bool authoritative);
+
+private:
+  // ---- PARAMETERS ----
+  struct Shard {
+    mutable std::shared_mutex mutex;
+    std::unordered_map<std::string, IndexEntry> entries;
+  };
+
+  std::filesystem::path directory_;
+  std::array<Shard, SHARD_COUNT> shards_;
+  std::mutex journal_mutex_;
+  int journal_fd_ = -1;
+  size_t journal_records_ = 0;
+  size_t snapshot_records_ = 0;
+  std::atomic<bool> authoritative_{false};
+  std::atomic<uint64_t> total_bytes_{0};
+  std::array<std::atomic<uint64_t>, VOLUME_COUNT> file_bytes_{};
+  // Sorted filenames, updated after the shard so the two locks never nest
+  mutable std::shared_mutex catalog_mutex_;
+  std::set<std::string> catalog_;
+
+
+  // ---- PERSISTENCE ----
+  // Writes all entries to the snapshot and truncates the journal, journal lock held
+  void write_snapshot();
+  // Maps the snapshot file and loads its entries
+  void load_snapshot();
+  // Replays journal records on top of the snapshot
+  void replay_journal();
+  // Opens the journal for appending, optionally truncating it
+  void open_journal(bool truncate);
+  // Appends one put or erase record to the journal
+  void append_journal(uint8_t op, const std::string& key, const IndexEntry& entry);
+  // Decodes one record, returns bytes consumed or 0 if truncated
+  static size_t decode_record(const char* data, size_t length, std::string& key, IndexEntry& entry);
+  static void encode_record(std::string& out, const std::string& key, const IndexEntry& entry);
+
+
+  // ---- UTILITY METHODS ----
+  // Adds or removes entry in the per-volume file byte totals
+  void count_file_bytes(const IndexEntry& entry, bool add);
+  Shard& shard_for(const std::string& key);
+  const Shard& shard_for(const std::string& key) const;
+};
+
+} // namespace store
+} // namespace dfs
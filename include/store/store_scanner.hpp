@@ -0,0 +1,105 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace dfs {
+namespace store {
+
+// Inventory of a Store tree produced by StoreScanner and completed by Store::scan
+struct ScanReport {
+  uint64_t directories = 0;
+  uint64_t objects = 0;
+  uint64_t object_bytes = 0;
+  uint64_t chunks = 0;
+  uint64_t chunk_bytes = 0;
+  std::vector<std::string> object_hashes;
+  // Index into the scanned roots of each entry in object_hashes
+  std::vector<uint32_t> object_volumes;
+  // Every temp file found, and those whose writing process no longer exists
+  std::vector<std::filesystem::path> temp_files;
+  std::vector<std::filesystem::path> orphaned_temp_files;
+  // Fan-out directories without any entries
+  std::vector<std::filesystem::path> empty_directories;
+  // Index entries whose object is missing, and objects no entry points to
+  uint64_t dangling_entries = 0;
+  uint64_t unindexed_objects = 0;
+  double seconds = 0;
+
+  double objects_per_second() const { return seconds > 0 ? objects / seconds : 0; }
+};
+
+// Parallel walker of the hash fan-out tree. Each worker owns a deque of
+// directories, pushing subdirectories it discovers onto its own end and
+// stealing from the other end of its peers' deques when it runs dry, so
+// the walk spreads across threads however unevenly the tree is filled.
+// Several roots, one per volume of a Store, are walked by the same workers,
+// so the directories of all devices are read in parallel.
+class StoreScanner {
+public:
+  // Objects sit below three levels of fan-out directories
+  static constexpr size_t OBJECT_DEPTH = 4;
+
+  // ---- CONSTRUCTOR AND DESTRUCTOR ----
+  // Files containing temp_marker are reported as temp files, files ending in
+  // chunk_extension as chunks. skip_directories are ignored at each root
+  StoreScanner(const std::vector<std::filesystem::path>& roots, const std::string& temp_marker,
+               const std::string& chunk_extension, const std::vector<std::string>& skip_directories,
+               size_t thread_count = 0);
+
+
+  // ---- SCAN OPERATIONS ----
+  // Walks the whole tree and returns what was found
+  ScanReport scan();
+
+private:
+  // ---- PARAMETERS ----
+  struct Task {
+    std::filesystem::path directory;
+    size_t depth;
+    uint32_t volume;  // Index of the root the directory belongs to
+    std::string hash_prefix;  // Fan-out directory names above this directory
+  };
+
+  struct Worker {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+    ScanReport report;
+  };
+
+  std::vector<std::filesystem::path> roots_;
+  std::string temp_marker_;
+  std::string chunk_extension_;
+  std::vector<std::string> skip_directories_;
+  size_t thread_count_;
+  std::vector<std::unique_ptr<Worker>> workers_;
+  // Directories queued or being processed, the walk ends when it reaches zero
+  std::atomic<size_t> pending_{0};
+  // Directories waiting in a deque, idle workers sleep until one is queued
+  std::atomic<size_t> queued_{0};
+  std::mutex idle_mutex_;
+  std::condition_variable idle_cv_;
+
+
+  // ---- WORK DISTRIBUTION ----
+  void run_worker(size_t id);
+  // Wakes idle workers after a task is queued or the walk ends
+  void notify_idle(bool all);
+  void push_task(size_t id, Task task);
+  bool pop_task(size_t id, Task& task);
+  bool steal_task(size_t id, Task& task);
+
+
+  // ---- DIRECTORY PROCESSING ----
+  void process_directory(size_t id, const Task& task);
+};
+
+} // namespace store
+} // namespace dfs
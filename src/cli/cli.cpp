@@ -2,6 +2,7 @@
 #include <sstream>
 #include <boost/log/trivial.hpp>
 #include "cli/cli.hpp"
+#include "network/peer_manager.hpp"
 
 namespace dfs {
 namespace cli {
@@ -38,7 +39,7 @@ void CLI::run() {
   std::string command, filename;
 
   iss >> command;
-  if (command == "pwd" || command == "ls" || command == "help") {
+  if (command == "pwd" || command == "ls" || command == "help" || command == "ciphers") {
   process_command(command, "");
   } else if (iss >> filename) {
   process_command(command, filename);
@@ -74,6 +75,9 @@ void CLI::process_command(const std::string& command, const std::string& filenam
   else if (command == "help" && filename.empty()) {
     handle_help_command();
   }
+  else if (command == "ciphers" && filename.empty()) {
+    handle_ciphers_command();
+  }
   else if (command == "store") {
     handle_store_command(filename);
   }
@@ -140,6 +144,32 @@ void CLI::handle_delete_command(const std::string& filename) {
   }
 }
 
+void CLI::handle_ciphers_command() {
+  const auto& benchmark = crypto::CipherBenchmark::shared();
+  std::cout << "Measured cipher suites:" << std::endl;
+  for (const auto& suite : benchmark.get_results()) {
+    std::cout << "  " << crypto::CipherBenchmark::get_name(suite.cipher) << ": "
+              << suite.megabytes_per_second << " MB/s" << std::endl;
+  }
+
+  auto& peer_manager = file_server_.get_peer_manager();
+  std::cout << "Negotiated with peers:" << std::endl;
+  for (const auto& [peer_id, cipher] : peer_manager.get_negotiated_ciphers()) {
+    std::cout << "  Peer " << static_cast<int>(peer_id) << ": " << crypto::CipherBenchmark::get_name(cipher);
+    if (auto peer = peer_manager.get_peer(peer_id)) {
+      for (const auto& suite : peer->get_remote_suites()) {
+        if (suite.cipher == cipher) {
+          std::cout << " (peer runs it at " << suite.megabytes_per_second << " MB/s)";
+        }
+      }
+    }
+    std::cout << std::endl;
+  }
+  if (auto broadcast = peer_manager.get_broadcast_cipher()) {
+    std::cout << "Broadcasts use " << crypto::CipherBenchmark::get_name(*broadcast) << std::endl;
+  }
+}
+
 void CLI::handle_help_command() {
   std::cout << "Available commands:" << std::endl;
   std::cout << "  help              Display this help message" << std::endl;
@@ -150,6 +180,7 @@ void CLI::handle_help_command() {
   std::cout << "  store <file>      Store local <file> in DFS" << std::endl;
   std::cout << "  delete <file>     Delete <file> from DFS" << std::endl;
   std::cout << "  connect <ip:port> Connect to DFS server at <ip:port>" << std::endl;
+  std::cout << "  ciphers           Show measured and negotiated cipher suites" << std::endl;
   std::cout << "  quit              Exit the DFS shell" << std::endl << std::endl;
 }
 
@@ -0,0 +1,125 @@
+#include "crypto/cipher_benchmark.hpp"
+#include <algorithm>
+#include <limits>
+#include <boost/log/trivial.hpp>
+
+namespace dfs::crypto {
+
+//==============================================
+// CONSTRUCTOR
+//==============================================
+
+CipherBenchmark::CipherBenchmark(std::chrono::milliseconds duration) {
+  for (auto cipher : SUITES) {
+    uint32_t throughput = measure(cipher, duration);
+    if (throughput > 0) {
+      results_.push_back({cipher, throughput});
+    }
+    BOOST_LOG_TRIVIAL(info) << "Cipher benchmark: " << get_name(cipher) << " runs at " << throughput << " MB/s";
+  }
+}
+
+const CipherBenchmark& CipherBenchmark::shared() {
+  static const CipherBenchmark benchmark;
+  return benchmark;
+}
+
+
+//==============================================
+// GETTERS
+//==============================================
+
+uint32_t CipherBenchmark::get_throughput(CryptoStream::Cipher cipher) const {
+  for (const auto& result : results_) {
+    if (result.cipher == cipher) {
+      return result.megabytes_per_second;
+    }
+  }
+  return 0;
+}
+
+std::string CipherBenchmark::get_name(CryptoStream::Cipher cipher) {
+  switch (cipher) {
+    case CryptoStream::Cipher::Aes256Cbc:
+      return "AES-256-CBC";
+    case CryptoStream::Cipher::Aes256Gcm:
+      return "AES-256-GCM";
+    case CryptoStream::Cipher::ChaCha20Poly1305:
+      return "ChaCha20-Poly1305";
+  }
+  return "Unknown";
+}
+
+
+//==============================================
+// SELECTION
+//==============================================
+
+std::optional<CryptoStream::Cipher> CipherBenchmark::select(const std::vector<std::vector<SuiteSpeed>>& offers) {
+  if (offers.empty()) {
+    return std::nullopt;
+  }
+
+  std::optional<CryptoStream::Cipher> best;
+  uint32_t best_throughput = 0;
+  for (const auto& candidate : offers.front()) {
+    // A suite is as fast as its slowest participant, and unusable if one lacks it
+    uint32_t slowest = std::numeric_limits<uint32_t>::max();
+    for (const auto& offer : offers) {
+      auto it = std::find_if(offer.begin(), offer.end(),
+                             [&](const SuiteSpeed& speed) { return speed.cipher == candidate.cipher; });
+      slowest = it == offer.end() ? 0 : std::min(slowest, it->megabytes_per_second);
+      if (slowest == 0) {
+        break;
+      }
+    }
+    if (slowest == 0) {
+      continue;
+    }
+    if (!best || slowest > best_throughput || (slowest == best_throughput && candidate.cipher < *best)) {
+      best = candidate.cipher;
+      best_throughput = slowest;
+    }
+  }
+  return best;
+}
+
+
+//==============================================
+// MEASUREMENT
+//==============================================
+
+uint32_t CipherBenchmark::measure(CryptoStream::Cipher cipher, std::chrono::milliseconds duration) {
+  try {
+    // One thread, so the result compares the cipher and not the core count
+    CryptoStream stream;
+    stream.setCipher(cipher);
+    stream.setThreads(1);
+    stream.initialize(std::vector<uint8_t>(CryptoStream::KEY_SIZE, 0x5A),
+                      std::vector<uint8_t>(CryptoStream::IV_SIZE, 0xA5));
+    std::vector<uint8_t> plaintext(SAMPLE_SIZE, 0x3C);
+    std::vector<uint8_t> ciphertext(stream.getCiphertextSize(SAMPLE_SIZE));
+
+    // The first message pays for keying and page faults
+    stream.encrypt(plaintext, ciphertext);
+
+    uint64_t bytes = 0;
+    auto started = std::chrono::steady_clock::now();
+    auto elapsed = std::chrono::steady_clock::duration::zero();
+    do {
+      stream.encrypt(plaintext, ciphertext);
+      bytes += SAMPLE_SIZE;
+      elapsed = std::chrono::steady_clock::now() - started;
+    } while (elapsed < duration);
+
+    double seconds = std::chrono::duration<double>(elapsed).count();
+    double megabytes_per_second = static_cast<double>(bytes) / (1024.0 * 1024.0) / seconds;
+    return static_cast<uint32_t>(std::clamp(megabytes_per_second, 1.0,
+                                            static_cast<double>(std::numeric_limits<uint32_t>::max())));
+  } catch (const std::exception& e) {
+    BOOST_LOG_TRIVIAL(warning) << "Cipher benchmark: " << get_name(cipher) << " is unavailable: " << e.what();
+    return 0;
+  }
+}
+
+} // namespace dfs::crypto
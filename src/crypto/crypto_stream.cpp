@@ -1,8 +1,15 @@
+#include <algorithm>
 #include <array>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include <span>
 #include <stdexcept>
 #include "crypto/crypto_stream.hpp"
+#include "crypto/worker_pool.hpp"
 #include <openssl/evp.h>
 #include <openssl/aes.h>
+#include <openssl/crypto.h>
 #include <openssl/err.h>
 #include <openssl/rand.h>
 #include <boost/log/trivial.hpp>
@@ -15,6 +22,11 @@ namespace dfs::crypto {
 
 struct CipherContext {
   EVP_CIPHER_CTX* ctx = nullptr;
+  // What the context was keyed for, so a pooled context is only reused with the same key
+  bool keyed = false;
+  CryptoStream::Cipher cipher = CryptoStream::Cipher::Aes256Cbc;
+  bool encrypting = false;
+  std::vector<uint8_t> key;
 
    // Initialize new cipher context
   CipherContext() {
@@ -29,26 +41,140 @@ struct CipherContext {
     if (ctx) {
       EVP_CIPHER_CTX_free(ctx);
     }
+    if (!key.empty()) {
+      OPENSSL_cleanse(key.data(), key.size());
+    }
   }
 
   // Access the underlying context  
   EVP_CIPHER_CTX* get() { return ctx; }
+
+  bool matches(CryptoStream::Cipher wanted_cipher, const std::vector<uint8_t>& wanted_key, bool wanted_encrypting) const {
+    return keyed && cipher == wanted_cipher && encrypting == wanted_encrypting && key == wanted_key;
+  }
+};
+
+
+//=================================================
+// PROCESS-WIDE INITIALIZATION AND CONTEXT POOL
+//=================================================
+
+namespace {
+
+// Fetched ciphers are reference counted, contexts keyed with one keep their own reference
+struct CipherFree {
+  void operator()(EVP_CIPHER* cipher) const { EVP_CIPHER_free(cipher); }
+};
+using CipherPtr = std::unique_ptr<EVP_CIPHER, CipherFree>;
+
+// Ciphers fetched from the provider once, instead of implicitly on every key setup
+struct CipherTable {
+  CipherPtr cbc;
+  CipherPtr gcm;
+  CipherPtr chacha;
+};
+
+CipherPtr fetchCipher(const char* name) {
+  CipherPtr cipher(EVP_CIPHER_fetch(nullptr, name, nullptr));
+  if (!cipher) {
+    BOOST_LOG_TRIVIAL(error) << "Crypto stream: Failed to fetch cipher " << name;
+    throw InitializationError(std::string("Crypto stream: Failed to fetch cipher ") + name);
+  }
+  return cipher;
+}
+
+// A failed fetch throws and leaves the table to be fetched again by the next stream
+const CipherTable& cipherTable() {
+  static std::once_flag once;
+  static CipherTable table;
+  std::call_once(once, [] {
+    OPENSSL_init_crypto(OPENSSL_INIT_ADD_ALL_CIPHERS | OPENSSL_INIT_LOAD_CRYPTO_STRINGS, nullptr);
+    CipherTable fetched;
+    fetched.cbc = fetchCipher("AES-256-CBC");
+    fetched.gcm = fetchCipher("AES-256-GCM");
+    fetched.chacha = fetchCipher("ChaCha20-Poly1305");
+    table = std::move(fetched);
+    BOOST_LOG_TRIVIAL(debug) << "Crypto stream: OpenSSL initialized";
+  });
+  return table;
+}
+
+// Keyed contexts of finished streams on one thread, most recently returned
+// last. A stream asking for a key it finds here skips the allocation and
+// key schedule and only sets its IV
+class ContextPool {
+public:
+  ~ContextPool() { destroyed_ = true; }
+
+  std::unique_ptr<CipherContext> acquire(CryptoStream::Cipher cipher, const std::vector<uint8_t>& key,
+                                         bool encrypting) {
+    for (size_t i = contexts_.size(); i-- > 0;) {
+      if (contexts_[i]->matches(cipher, key, encrypting)) {
+        std::unique_ptr<CipherContext> context = std::move(contexts_[i]);
+        contexts_.erase(contexts_.begin() + static_cast<std::ptrdiff_t>(i));
+        stats_.hits++;
+        return context;
+      }
+    }
+    stats_.misses++;
+    // Reuse the allocation of the least recently returned context for the new key
+    if (contexts_.size() == CryptoStream::POOL_CAPACITY) {
+      std::unique_ptr<CipherContext> context = std::move(contexts_.front());
+      contexts_.erase(contexts_.begin());
+      return context;
+    }
+    return std::make_unique<CipherContext>();
+  }
+
+  void release(std::unique_ptr<CipherContext> context) {
+    if (!context || !context->keyed) {
+      return;
+    }
+    if (contexts_.size() == CryptoStream::POOL_CAPACITY) {
+      contexts_.erase(contexts_.begin());
+    }
+    contexts_.push_back(std::move(context));
+  }
+
+  CryptoStream::ContextPoolStats stats() const {
+    CryptoStream::ContextPoolStats stats = stats_;
+    stats.pooled = contexts_.size();
+    return stats;
+  }
+
+  // Streams destroyed after their thread's pool drop their contexts instead
+  static bool isDestroyed() { return destroyed_; }
+
+private:
+  std::vector<std::unique_ptr<CipherContext>> contexts_;
+  CryptoStream::ContextPoolStats stats_;
+  static thread_local bool destroyed_;
 };
 
+thread_local bool ContextPool::destroyed_ = false;
+thread_local ContextPool context_pool;
+
+} // namespace
+
 //==============================================
 // CONSTRUCTOR AND DESTRUCTOR
 //==============================================
 
 CryptoStream::CryptoStream() {
-  BOOST_LOG_TRIVIAL(info) << "Crypto stream: Initializing CryptoStream";
-  OpenSSL_add_all_algorithms();
-  context_ = std::make_unique<CipherContext>();
-  BOOST_LOG_TRIVIAL(debug) << "Crypto stream: initialization complete";
+  BOOST_LOG_TRIVIAL(debug) << "Crypto stream: Initializing CryptoStream";
+  // OpenSSL is set up once per process, contexts are taken from the pool when first used
+  cipherTable();
 }
 
 CryptoStream::~CryptoStream() {
-  BOOST_LOG_TRIVIAL(debug) << "Crypto stream: Cleaning up CryptoStream resources";
-  EVP_cleanup();
+  BOOST_LOG_TRIVIAL(debug) << "Crypto stream: Returning cipher contexts to the pool";
+  if (ContextPool::isDestroyed()) {
+    return;
+  }
+  context_pool.release(std::move(context_));
+  for (auto& context : batch_contexts_) {
+    context_pool.release(std::move(context));
+  }
 }
 
 //==============================================
@@ -66,6 +192,8 @@ void CryptoStream::initialize(const std::vector<uint8_t>& key, const std::vector
   // Initialize parameters
   key_ = key;
   iv_ = iv;
+  encrypt_records_ = 0;
+  decrypt_records_ = 0;
   is_initialized_ = true;
   BOOST_LOG_TRIVIAL(debug) << "Crypto stream: Crypto parameters initialized successfully";
 }
@@ -77,22 +205,57 @@ void CryptoStream::initializeCipher(bool encrypting) {
     throw InitializationError("Crypto stream: CryptoStream not initialized");
   }
 
-  // Reset the context state
-  EVP_CIPHER_CTX_reset(context_->get());
+  if (isAuthenticated(cipher_) && iv_.size() < NONCE_SIZE) {
+    throw InitializationError("Crypto stream: IV too short for record nonces");
+  }
+
+  prepareContext(context_, encrypting);
+
+  // A keyed context only needs the IV reset. Record ciphers take each record's nonce later
+  if (cipher_ == Cipher::Aes256Cbc) {
+    bool ok = encrypting ? EVP_EncryptInit_ex(context_->get(), nullptr, nullptr, nullptr, iv_.data())
+                         : EVP_DecryptInit_ex(context_->get(), nullptr, nullptr, nullptr, iv_.data());
+    if (!ok && encrypting) {
+      throw EncryptionError("Crypto stream: Failed to initialize encryption context");
+    } else if (!ok) {
+      throw DecryptionError("Crypto stream: Failed to initialize decryption context");
+    }
+  }
+
+  BOOST_LOG_TRIVIAL(debug) << "Crypto stream: Cipher initialization complete";
+}
+
+void CryptoStream::prepareContext(std::unique_ptr<CipherContext>& context, bool encrypting) {
+  if (context && context->matches(cipher_, key_, encrypting)) {
+    return;
+  }
+  if (context) {
+    context_pool.release(std::move(context));
+  }
+  context = context_pool.acquire(cipher_, key_, encrypting);
+  if (context->matches(cipher_, key_, encrypting)) {
+    return;
+  }
 
-  // Initialize cipher context
-  const EVP_CIPHER* cipher = EVP_aes_256_cbc();
+  // Run the key schedule, the IV is set by each use
+  context->keyed = false;
+  EVP_CIPHER_CTX_reset(context->get());
+  const CipherTable& table = cipherTable();
+  const EVP_CIPHER* cipher = cipher_ == Cipher::Aes256Gcm ? table.gcm.get()
+                           : cipher_ == Cipher::ChaCha20Poly1305 ? table.chacha.get() : table.cbc.get();
   if (encrypting) {
-    if (!EVP_EncryptInit_ex(context_->get(), cipher, nullptr, key_.data(), iv_.data())) {
+    if (!EVP_EncryptInit_ex(context->get(), cipher, nullptr, key_.data(), nullptr)) {
       throw EncryptionError("Crypto stream: Failed to initialize encryption context");
     }
   } else {
-    if (!EVP_DecryptInit_ex(context_->get(), cipher, nullptr, key_.data(), iv_.data())) {
+    if (!EVP_DecryptInit_ex(context->get(), cipher, nullptr, key_.data(), nullptr)) {
       throw DecryptionError("Crypto stream: Failed to initialize decryption context");
     }
   }
-
-  BOOST_LOG_TRIVIAL(debug) << "Crypto stream: Cipher initialization complete";
+  context->keyed = true;
+  context->cipher = cipher_;
+  context->encrypting = encrypting;
+  context->key = key_;
 }
 
 //==============================================
@@ -106,79 +269,77 @@ void CryptoStream::processStream(std::istream& input, std::ostream& output, bool
     throw std::runtime_error("Crypto stream: Invalid stream state");
   }  
   
-  initializeCipher(encrypting);
-
-    saveStreamPos(input, output, [&]() {
-    processStreamData(input, output, encrypting);
-  });
-}
+  begin(encrypting ? Mode::Encrypt : Mode::Decrypt);
 
-void CryptoStream::saveStreamPos(std::istream& input, std::ostream& output, 
-                                             const std::function<void()>& operation) {
   auto input_pos = input.tellg();
   auto output_pos = output.tellp();
-
   try {
-      operation();
+    pumpStream(input, output);
   }
   catch (const std::exception& e) {
     BOOST_LOG_TRIVIAL(error) << "Crypto stream: Stream processing failed: " << e.what();
     // Restore stream positions on error
-    input.clear();
-    input.seekg(input_pos);
-    output.clear();
-    output.seekp(output_pos);
+    restoreStreamPos(input, output, input_pos, output_pos);
     throw;
   }
 
   // Reset stream positions
-  input.clear();
-  input.seekg(input_pos);
-  output.clear();
-  output.seekp(output_pos);
+  restoreStreamPos(input, output, input_pos, output_pos);
   output.flush();
 }
 
-void CryptoStream::processStreamData(std::istream& input, std::ostream& output, bool encrypting) {
-  std::array<uint8_t, BUFFER_SIZE> inbuf;
-  std::array<uint8_t, BUFFER_SIZE + EVP_MAX_BLOCK_LENGTH> outbuf;
-  size_t block_count = 0;
+void CryptoStream::pumpStream(std::istream& input, std::ostream& output) {
+  // Record ciphers read a batch of records at a time so update() can process them in parallel
+  size_t chunk_size = BUFFER_SIZE;
+  if (isAuthenticated(cipher_)) {
+    chunk_size = batchSize() * (message_encrypting_ ? RECORD_SIZE : RECORD_SIZE + TAG_SIZE);
+  }
+  std::vector<uint8_t> inbuf(chunk_size);
+  std::vector<uint8_t> outbuf;
+  size_t chunk_count = 0;
   size_t total_bytes_processed = 0;
 
   // Process the input stream in chunks
-  while (input.good() && !input.eof()) {
+  while (true) {
     input.read(reinterpret_cast<char*>(inbuf.data()), inbuf.size());
-    auto bytes_read = input.gcount();
+    auto bytes_read = static_cast<size_t>(input.gcount());
+    if (input.bad()) {
+      throw std::runtime_error("Crypto stream: Failed to read from input stream");
+    }
 
-    BOOST_LOG_TRIVIAL(debug) << "Crypto stream: Processing block " << block_count 
+    BOOST_LOG_TRIVIAL(debug) << "Crypto stream: Processing chunk " << chunk_count 
                              << ": Read " << bytes_read << " bytes"
                              << " (total processed so far: " << total_bytes_processed << ")";
 
-    if (bytes_read <= 0) {
-      if (!input.eof()) {
-        throw std::runtime_error("Crypto stream: Failed to read from input stream");
-      }
+    if (bytes_read > 0) {
+      outbuf.resize(std::max(outbuf.size(), getUpdateSize(bytes_read)));
+      size_t outlen = update({inbuf.data(), bytes_read}, outbuf);
+      writeOutputBlock(output, outbuf.data(), outlen);
+      total_bytes_processed += outlen;
+      chunk_count++;
+    }
+    if (input.eof()) {
       break;
     }
-
-    // Process the chunk
-    auto outlen = processDataBlock(inbuf.data(), bytes_read, outbuf.data(), encrypting);
-
-    // Write processed data
-    writeOutputBlock(output, outbuf.data(), outlen);
-    total_bytes_processed += outlen;
-    block_count++;
   }
 
-  // Process final block with padding
-  int final_outlen = 0;
-  processFinalBlock(outbuf.data(), final_outlen, encrypting);
+  // Process final block with padding, or the final record
+  outbuf.resize(std::max(outbuf.size(), getFinishSize()));
+  size_t final_outlen = finish(outbuf);
   writeOutputBlock(output, outbuf.data(), final_outlen);
   total_bytes_processed += final_outlen;
 
-  BOOST_LOG_TRIVIAL(info) << "Crypto stream: Completed " << (encrypting ? "encryption" : "decryption")
+  BOOST_LOG_TRIVIAL(info) << "Crypto stream: Completed " << (message_encrypting_ ? "encryption" : "decryption")
                           << ": Processed " << total_bytes_processed 
-                          << " bytes in " << block_count << " blocks";
+                          << " bytes in " << chunk_count << " chunks";
+}
+
+void CryptoStream::restoreStreamPos(std::istream& input, std::ostream& output,
+                                    std::streampos input_pos, std::streampos output_pos) {
+  input.clear();
+  input.seekg(input_pos);
+  output.clear();
+  output.seekp(output_pos);
 }
 
 size_t CryptoStream::processDataBlock(const uint8_t* inbuf, size_t bytes_read, uint8_t* outbuf, 
@@ -228,6 +389,139 @@ void CryptoStream::processFinalBlock(uint8_t* outbuf, int& outlen, bool encrypti
   }
 }
 
+//==============================================
+// STREAM PROCESSING - AUTHENTICATED RECORDS
+//==============================================
+
+size_t CryptoStream::processRecordRange(const uint8_t* head, const uint8_t* input, size_t length, size_t in_stride,
+                                        uint8_t* output, size_t out_stride, bool encrypting, bool last) {
+  // Ciphertext records carry their tag
+  const size_t in_record = encrypting ? RECORD_SIZE : RECORD_SIZE + TAG_SIZE;
+  const size_t out_record = encrypting ? RECORD_SIZE + TAG_SIZE : RECORD_SIZE;
+  const size_t head_count = head ? 1 : 0;
+  // Every message has at least one record, the final one may be empty
+  size_t input_count = (length + in_record - 1) / in_record;
+  if (last && head_count + input_count == 0) {
+    input_count = 1;
+  }
+  const size_t count = head_count + input_count;
+  const size_t batch_size = std::min(batchSize(), count);
+  uint64_t& next_record = encrypting ? encrypt_records_ : decrypt_records_;
+
+  // Each record of a batch gets a context of its own, keyed for this direction
+  if (batch_contexts_.size() + 1 < batch_size) {
+    batch_contexts_.resize(batch_size - 1);
+  }
+  for (size_t i = 0; i + 1 < batch_size; ++i) {
+    prepareContext(batch_contexts_[i], encrypting);
+  }
+
+  // Only the final record can be short, so its output length is all that needs keeping
+  size_t final_outlen = 0;
+  for (size_t first = 0; first < count; first += batch_size) {
+    size_t batch_count = std::min(batch_size, count - first);
+    auto process = [&](size_t index) {
+      size_t record = first + index;
+      const uint8_t* inbuf = head;
+      size_t record_length = in_record;
+      if (record >= head_count) {
+        size_t offset = (record - head_count) * in_record;
+        inbuf = input + (record - head_count) * in_stride;
+        record_length = std::min(in_record, length - offset);
+      }
+      uint8_t* outbuf = output + record * out_stride;
+      bool final = last && record + 1 == count;
+      CipherContext& context = index == 0 ? *context_ : *batch_contexts_[index - 1];
+      size_t outlen = encrypting
+        ? sealRecord(context, next_record + record, inbuf, record_length, outbuf, final)
+        : openRecord(context, next_record + record, inbuf, record_length, outbuf, final);
+      if (record + 1 == count) {
+        final_outlen = outlen;
+      }
+    };
+    if (batch_count == 1) {
+      process(0);
+    } else {
+      WorkerPool::shared().parallel_for(batch_count, process);
+    }
+  }
+  next_record += count;
+
+  BOOST_LOG_TRIVIAL(debug) << "Crypto stream: Processed " << count << " authenticated records";
+  return (count - 1) * out_record + final_outlen;
+}
+
+size_t CryptoStream::batchSize() const {
+  size_t threads = threads_ ? threads_ : WorkerPool::shared().size() + 1;
+  return std::clamp<size_t>(threads, 1, MAX_BATCH_RECORDS);
+}
+
+size_t CryptoStream::sealRecord(CipherContext& context, uint64_t record, const uint8_t* inbuf, size_t length,
+                                uint8_t* outbuf, bool final) {
+  EVP_CIPHER_CTX* ctx = context.get();
+  auto nonce = recordNonce(record);
+  int outlen = 0;
+  int finallen = 0;
+
+  if (!EVP_EncryptInit_ex(ctx, nullptr, nullptr, nullptr, nonce.data()) ||
+      !addRecordAad(context, final) ||
+      !EVP_EncryptUpdate(ctx, outbuf, &outlen, inbuf, static_cast<int>(length)) ||
+      !EVP_EncryptFinal_ex(ctx, outbuf + outlen, &finallen) ||
+      !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_GET_TAG, static_cast<int>(TAG_SIZE), outbuf + outlen + finallen)) {
+    throw EncryptionError("Crypto stream: Failed to seal record");
+  }
+  return static_cast<size_t>(outlen + finallen) + TAG_SIZE;
+}
+
+size_t CryptoStream::openRecord(CipherContext& context, uint64_t record, const uint8_t* inbuf, size_t length,
+                                uint8_t* outbuf, bool final) {
+  if (length < TAG_SIZE) {
+    throw DecryptionError("Crypto stream: Truncated record");
+  }
+  EVP_CIPHER_CTX* ctx = context.get();
+  size_t ciphertext_length = length - TAG_SIZE;
+  auto nonce = recordNonce(record);
+  int outlen = 0;
+  int finallen = 0;
+
+  // OpenSSL takes the expected tag as non-const input, and an in-place record overwrites it
+  uint8_t tag[TAG_SIZE];
+  std::memcpy(tag, inbuf + ciphertext_length, TAG_SIZE);
+
+  if (!EVP_DecryptInit_ex(ctx, nullptr, nullptr, nullptr, nonce.data()) ||
+      !addRecordAad(context, final) ||
+      !EVP_DecryptUpdate(ctx, outbuf, &outlen, inbuf, static_cast<int>(ciphertext_length)) ||
+      !EVP_CIPHER_CTX_ctrl(ctx, EVP_CTRL_AEAD_SET_TAG, static_cast<int>(TAG_SIZE), tag)) {
+    throw DecryptionError("Crypto stream: Failed to decrypt record");
+  }
+  // The caller wipes the plaintext of a record that fails verification
+  if (EVP_DecryptFinal_ex(ctx, outbuf + outlen, &finallen) <= 0) {
+    BOOST_LOG_TRIVIAL(warning) << "Crypto stream: Record " << record << " failed authentication";
+    throw DecryptionError("Crypto stream: Record failed authentication");
+  }
+  return static_cast<size_t>(outlen + finallen);
+}
+
+std::array<uint8_t, CryptoStream::NONCE_SIZE> CryptoStream::recordNonce(uint64_t record) const {
+  std::array<uint8_t, NONCE_SIZE> nonce;
+  std::memcpy(nonce.data(), iv_.data(), NONCE_SIZE);
+  for (size_t i = 0; i < sizeof(record); ++i) {
+    nonce[NONCE_SIZE - 1 - i] ^= static_cast<uint8_t>(record >> (8 * i));
+  }
+  return nonce;
+}
+
+bool CryptoStream::addRecordAad(CipherContext& context, bool final) const {
+  EVP_CIPHER_CTX* ctx = context.get();
+  int outlen = 0;
+  const uint8_t flag = final ? 1 : 0;
+  if (!associated_data_.empty() &&
+      !EVP_CipherUpdate(ctx, nullptr, &outlen, associated_data_.data(), static_cast<int>(associated_data_.size()))) {
+    return false;
+  }
+  return EVP_CipherUpdate(ctx, nullptr, &outlen, &flag, sizeof(flag)) == 1;
+}
+
 //==============================================
 // ENCRYPTION/DECRYPTION OPERATIONS
 //==============================================
@@ -242,6 +536,252 @@ std::ostream& CryptoStream::decrypt(std::istream& input, std::ostream& output) {
   return output;
 }
 
+//==============================================
+// BUFFER OPERATIONS
+//==============================================
+
+size_t CryptoStream::encrypt(std::span<const uint8_t> input, std::span<uint8_t> output) {
+  if (output.size() < getCiphertextSize(input.size())) {
+    throwBufferTooSmall(true);
+  }
+  initializeCipher(true);
+  in_message_ = false;
+
+  if (isAuthenticated(cipher_)) {
+    return processRecordRange(nullptr, input.data(), input.size(), RECORD_SIZE,
+                              output.data(), RECORD_SIZE + TAG_SIZE, true, true);
+  }
+  size_t outlen = processDataBlock(input.data(), input.size(), output.data(), true);
+  int final_outlen = 0;
+  processFinalBlock(output.data() + outlen, final_outlen, true);
+  return outlen + static_cast<size_t>(final_outlen);
+}
+
+size_t CryptoStream::decrypt(std::span<const uint8_t> input, std::span<uint8_t> output) {
+  if (output.size() < getPlaintextSize(input.size())) {
+    throwBufferTooSmall(false);
+  }
+  initializeCipher(false);
+  in_message_ = false;
+
+  try {
+    if (isAuthenticated(cipher_)) {
+      return processRecordRange(nullptr, input.data(), input.size(), RECORD_SIZE + TAG_SIZE,
+                                output.data(), RECORD_SIZE, false, true);
+    }
+    size_t outlen = processDataBlock(input.data(), input.size(), output.data(), false);
+    int final_outlen = 0;
+    processFinalBlock(output.data() + outlen, final_outlen, false);
+    return outlen + static_cast<size_t>(final_outlen);
+  } catch (const CryptoError&) {
+    // Never leave plaintext that failed verification in the caller's buffer
+    OPENSSL_cleanse(output.data(), output.size());
+    throw;
+  }
+}
+
+size_t CryptoStream::encryptInPlace(std::span<uint8_t> buffer, size_t length) {
+  if (length > buffer.size() || buffer.size() < getCiphertextSize(length)) {
+    throwBufferTooSmall(true);
+  }
+  initializeCipher(true);
+  in_message_ = false;
+
+  if (cipher_ == Cipher::Aes256Cbc) {
+    // OpenSSL reads each block before writing it, so a CBC buffer is processed where it is
+    size_t outlen = processDataBlock(buffer.data(), length, buffer.data(), true);
+    int final_outlen = 0;
+    processFinalBlock(buffer.data() + outlen, final_outlen, true);
+    return outlen + static_cast<size_t>(final_outlen);
+  }
+
+  // Each record moves up by the tags of the records before it, the last one first
+  const size_t stride = RECORD_SIZE + TAG_SIZE;
+  for (size_t record = length / RECORD_SIZE; record > 0; --record) {
+    size_t offset = record * RECORD_SIZE;
+    if (offset < length) {
+      std::memmove(buffer.data() + record * stride, buffer.data() + offset,
+                   std::min(RECORD_SIZE, length - offset));
+    }
+  }
+  return processRecordRange(nullptr, buffer.data(), length, stride, buffer.data(), stride, true, true);
+}
+
+size_t CryptoStream::decryptInPlace(std::span<uint8_t> buffer) {
+  initializeCipher(false);
+  in_message_ = false;
+
+  try {
+    if (cipher_ == Cipher::Aes256Cbc) {
+      size_t outlen = processDataBlock(buffer.data(), buffer.size(), buffer.data(), false);
+      int final_outlen = 0;
+      processFinalBlock(buffer.data() + outlen, final_outlen, false);
+      return outlen + static_cast<size_t>(final_outlen);
+    }
+
+    // Records are opened where they are, then each moves down over the tags before it
+    const size_t stride = RECORD_SIZE + TAG_SIZE;
+    size_t plaintext_size = processRecordRange(nullptr, buffer.data(), buffer.size(), stride,
+                                               buffer.data(), stride, false, true);
+    for (size_t record = 1; record * RECORD_SIZE < plaintext_size; ++record) {
+      std::memmove(buffer.data() + record * RECORD_SIZE, buffer.data() + record * stride,
+                   std::min(RECORD_SIZE, plaintext_size - record * RECORD_SIZE));
+    }
+    return plaintext_size;
+  } catch (const CryptoError&) {
+    OPENSSL_cleanse(buffer.data(), buffer.size());
+    throw;
+  }
+}
+
+void CryptoStream::throwBufferTooSmall(bool encrypting) {
+  BOOST_LOG_TRIVIAL(error) << "Crypto stream: Output buffer too small for " << (encrypting ? "encryption" : "decryption");
+  if (encrypting) {
+    throw EncryptionError("Crypto stream: Output buffer too small");
+  }
+  throw DecryptionError("Crypto stream: Output buffer too small");
+}
+
+//==============================================
+// INCREMENTAL OPERATIONS
+//==============================================
+
+void CryptoStream::begin(Mode mode) {
+  bool encrypting = mode == Mode::Encrypt;
+  initializeCipher(encrypting);
+  message_encrypting_ = encrypting;
+  pending_length_ = 0;
+  // Allocated once per stream, it holds back the record that may turn out to be the final one
+  if (isAuthenticated(cipher_) && pending_.size() < RECORD_SIZE + TAG_SIZE) {
+    pending_.resize(RECORD_SIZE + TAG_SIZE);
+  }
+  in_message_ = true;
+}
+
+size_t CryptoStream::update(std::span<const uint8_t> input, std::span<uint8_t> output) {
+  if (!in_message_) {
+    throw InitializationError("Crypto stream: update() without begin()");
+  }
+  if (output.size() < getUpdateSize(input.size())) {
+    in_message_ = false;
+    throwBufferTooSmall(message_encrypting_);
+  }
+
+  try {
+    if (cipher_ == Cipher::Aes256Cbc) {
+      return processDataBlock(input.data(), input.size(), output.data(), message_encrypting_);
+    }
+
+    const size_t in_record = message_encrypting_ ? RECORD_SIZE : RECORD_SIZE + TAG_SIZE;
+    const size_t out_record = message_encrypting_ ? RECORD_SIZE + TAG_SIZE : RECORD_SIZE;
+    const uint8_t* data = input.data();
+    size_t length = input.size();
+
+    // Top up the held back record, it can only be processed once more input follows it
+    if (pending_length_ > 0) {
+      size_t take = std::min(length, in_record - pending_length_);
+      std::memcpy(pending_.data() + pending_length_, data, take);
+      pending_length_ += take;
+      data += take;
+      length -= take;
+    }
+    if (length == 0) {
+      return 0;
+    }
+
+    // The held back record and every complete record but the last are processed as one range
+    size_t direct = (length - 1) / in_record * in_record;
+    const uint8_t* head = pending_length_ > 0 ? pending_.data() : nullptr;
+    size_t outlen = 0;
+    if (head || direct > 0) {
+      outlen = processRecordRange(head, data, direct, in_record, output.data(), out_record,
+                                  message_encrypting_, false);
+    }
+    pending_length_ = length - direct;
+    std::memcpy(pending_.data(), data + direct, pending_length_);
+    return outlen;
+  } catch (...) {
+    in_message_ = false;
+    if (!message_encrypting_) {
+      OPENSSL_cleanse(output.data(), output.size());
+    }
+    throw;
+  }
+}
+
+size_t CryptoStream::finish(std::span<uint8_t> output) {
+  if (!in_message_) {
+    throw InitializationError("Crypto stream: finish() without begin()");
+  }
+  in_message_ = false;
+  if (output.size() < getFinishSize()) {
+    throwBufferTooSmall(message_encrypting_);
+  }
+
+  try {
+    if (cipher_ == Cipher::Aes256Cbc) {
+      int final_outlen = 0;
+      processFinalBlock(output.data(), final_outlen, message_encrypting_);
+      return static_cast<size_t>(final_outlen);
+    }
+    const size_t in_record = message_encrypting_ ? RECORD_SIZE : RECORD_SIZE + TAG_SIZE;
+    const size_t out_record = message_encrypting_ ? RECORD_SIZE + TAG_SIZE : RECORD_SIZE;
+    size_t outlen = processRecordRange(nullptr, pending_.data(), pending_length_, in_record,
+                                       output.data(), out_record, message_encrypting_, true);
+    pending_length_ = 0;
+    return outlen;
+  } catch (...) {
+    if (!message_encrypting_) {
+      OPENSSL_cleanse(output.data(), output.size());
+    }
+    throw;
+  }
+}
+
+//==============================================
+// GETTERS/SETTERS
+//==============================================
+
+size_t CryptoStream::getCiphertextSize(size_t plaintext_size) const {
+  if (isAuthenticated(cipher_)) {
+    size_t records = plaintext_size == 0 ? 1 : (plaintext_size + RECORD_SIZE - 1) / RECORD_SIZE;
+    return plaintext_size + records * TAG_SIZE;
+  }
+  // PKCS padding always adds between one and a full block
+  return (plaintext_size / BLOCK_SIZE + 1) * BLOCK_SIZE;
+}
+
+size_t CryptoStream::getPlaintextSize(size_t ciphertext_size) const {
+  if (isAuthenticated(cipher_)) {
+    size_t records = ciphertext_size == 0 ? 1 : (ciphertext_size + RECORD_SIZE + TAG_SIZE - 1) / (RECORD_SIZE + TAG_SIZE);
+    return ciphertext_size > records * TAG_SIZE ? ciphertext_size - records * TAG_SIZE : 0;
+  }
+  // Padding is only known once decrypted, it is at least one byte
+  return ciphertext_size;
+}
+
+size_t CryptoStream::getUpdateSize(size_t input_size) const {
+  if (cipher_ == Cipher::Aes256Cbc) {
+    return input_size + BLOCK_SIZE;
+  }
+  // Every record completed by this input except the last, which is held back
+  const size_t in_record = message_encrypting_ ? RECORD_SIZE : RECORD_SIZE + TAG_SIZE;
+  const size_t out_record = message_encrypting_ ? RECORD_SIZE + TAG_SIZE : RECORD_SIZE;
+  size_t total = pending_length_ + input_size;
+  return total == 0 ? 0 : (total - 1) / in_record * out_record;
+}
+
+size_t CryptoStream::getFinishSize() const {
+  if (cipher_ == Cipher::Aes256Cbc) {
+    return BLOCK_SIZE;
+  }
+  return message_encrypting_ ? pending_length_ + TAG_SIZE : pending_length_;
+}
+
+CryptoStream::ContextPoolStats CryptoStream::getContextPoolStats() {
+  return context_pool.stats();
+}
+
 //==============================================
 // PUBLIC IV GENERATION METHOD
 //==============================================
@@ -0,0 +1,125 @@
+#include "crypto/worker_pool.hpp"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+#include <memory>
+#include <boost/log/trivial.hpp>
+
+namespace dfs::crypto {
+
+namespace {
+
+// State of one parallel_for call, kept alive by helpers that start late
+struct Job {
+  const std::function<void(size_t)>* task;
+  size_t count;
+  std::atomic<size_t> next{0};
+  size_t finished = 0;
+  std::exception_ptr error;
+  std::mutex mutex;
+  std::condition_variable done;
+
+  // Claims and runs tasks until none are left
+  void run() {
+    for (size_t index = next++; index < count; index = next++) {
+      std::exception_ptr task_error;
+      try {
+        (*task)(index);
+      } catch (...) {
+        task_error = std::current_exception();
+      }
+      std::lock_guard<std::mutex> lock(mutex);
+      if (task_error && !error) {
+        error = task_error;
+      }
+      if (++finished == count) {
+        done.notify_all();
+      }
+    }
+  }
+};
+
+} // namespace
+
+//==============================================
+// CONSTRUCTOR AND DESTRUCTOR
+//==============================================
+
+WorkerPool::WorkerPool(size_t threads) {
+  for (size_t i = 0; i < threads; ++i) {
+    workers_.emplace_back(&WorkerPool::worker_loop, this);
+  }
+  BOOST_LOG_TRIVIAL(debug) << "Worker pool: Started " << threads << " workers";
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  cv_.notify_all();
+  for (auto& worker : workers_) {
+    worker.join();
+  }
+}
+
+WorkerPool& WorkerPool::shared() {
+  // The caller of each job is a worker too
+  static WorkerPool pool(std::max(std::thread::hardware_concurrency(), 2u) - 1);
+  return pool;
+}
+
+
+//==============================================
+// EXECUTION
+//==============================================
+
+void WorkerPool::parallel_for(size_t count, const std::function<void(size_t)>& task) {
+  if (count == 0) {
+    return;
+  }
+  auto job = std::make_shared<Job>();
+  job->task = &task;
+  job->count = count;
+
+  // One helper per task beyond the caller's, each exits once nothing is left to claim
+  size_t helpers = std::min(count - 1, workers_.size());
+  if (helpers > 0) {
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      for (size_t i = 0; i < helpers; ++i) {
+        queue_.push_back([job] { job->run(); });
+      }
+    }
+    cv_.notify_all();
+  }
+
+  job->run();
+  std::unique_lock<std::mutex> lock(job->mutex);
+  job->done.wait(lock, [&job] { return job->finished == job->count; });
+  if (job->error) {
+    std::rethrow_exception(job->error);
+  }
+}
+
+
+//==============================================
+// WORKERS
+//==============================================
+
+void WorkerPool::worker_loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return !running_ || !queue_.empty(); });
+    if (queue_.empty()) {
+      return;
+    }
+    auto work = std::move(queue_.front());
+    queue_.pop_front();
+    lock.unlock();
+    work();
+    lock.lock();
+  }
+}
+
+} // namespace dfs::crypto
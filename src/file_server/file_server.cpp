@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <filesystem>
 #include <optional>
 #include <thread>
@@ -38,9 +39,14 @@ FileServer::FileServer(uint32_t ID, const std::vector<uint8_t>& key, PeerManager
     // Initialize store with the server-specific directory
     store_ = std::make_unique<dfs::store::Store>(store_path);
 
-    // Initialize codec with the provided cryptographic key and channel reference
+    // Initialize codec with the provided cryptographic key and channel reference.
+    // Frames to peers use the suites negotiated in the handshake unless a cipher
+    // is pinned, CBC only applies to peers that negotiated none
     codec_ = std::make_unique<Codec>(key_, channel);
 
+    // Calibrate the cipher suites now rather than during the first handshake
+    crypto::CipherBenchmark::shared();
+
     // Start the channel listener thread
     listener_thread_ = std::make_unique<std::thread>(&FileServer::channel_listener, this);
 
@@ -83,7 +89,7 @@ bool FileServer::connect(const std::string& remote_address, uint16_t remote_port
 //==============================================
 
 bool FileServer::prepare_and_send(const std::string& filename, MessageType message_type, 
-                                  std::optional<uint8_t> peer_id) {
+                                  std::optional<uint8_t> peer_id, std::optional<ByteRange> range) {
   try {
       BOOST_LOG_TRIVIAL(info) << "File server: Preparing file: " << filename 
                               << " for " << (peer_id ? "peer " + std::to_string(*peer_id) : "broadcast")
@@ -91,9 +97,9 @@ bool FileServer::prepare_and_send(const std::string& filename, MessageType messa
 
       // Create pipeline and components
       auto frame = create_message_frame(filename, message_type);
-      auto producer = create_producer(filename, message_type);
+      auto producer = create_producer(filename, message_type, range);
       auto pipeline = utils::Pipeliner::create(producer);
-      auto transform = create_transform(frame, pipeline.get());
+      auto transform = create_transform(frame, pipeline.get(), select_cipher(peer_id));
 
       // Configure pipeline with 1MB buffer
       pipeline->transform(transform);
@@ -131,7 +137,7 @@ MessageFrame FileServer::create_message_frame(const std::string& filename, Messa
 }
 
 std::function<bool(std::stringstream&)> FileServer::create_producer(
-  const std::string& filename, MessageType message_type) {
+  const std::string& filename, MessageType message_type, std::optional<ByteRange> range) {
 
   if (message_type == MessageType::GET_FILE) {
     // For GET_FILE, producer only writes filename (no file content needed)
@@ -143,11 +149,40 @@ std::function<bool(std::stringstream&)> FileServer::create_producer(
     };
   }
 
+  if (message_type == MessageType::GET_RANGE) {
+    // For GET_RANGE, producer writes the filename followed by the requested range
+    return [filename, range = range.value(), first_read = true](std::stringstream& output) mutable -> bool {
+      if (!first_read) return false;
+      output.write(filename.c_str(), filename.length());
+      write_range(output, range);
+      first_read = false;
+      return output.good();
+    };
+  }
+
+  if (message_type == MessageType::RANGE_DATA) {
+    // For RANGE_DATA, producer writes the filename, the range actually
+    // available and then only those bytes of the file
+    return [this, filename, range = range.value(), first_read = true](std::stringstream& output) mutable -> bool {
+      if (!first_read) return false;
+      std::uintmax_t size = store_->get_file_size(filename);
+      ByteRange available{range.offset, range.offset < size ? std::min<uint64_t>(range.length, size - range.offset) : 0,
+                          range.request_id};
+      output.write(filename.c_str(), filename.length());
+      write_range(output, available);
+      if (available.length > 0) {
+        store_->get_range(filename, available.offset, available.length, output);
+      }
+      first_read = false;
+      return output.good();
+    };
+  }
+
   // For other types (e.g., STORE_FILE), producer writes both filename and file content
   return [this, filename, first_read = true](std::stringstream& output) mutable -> bool {
     if (!first_read) return false; 
     output.write(filename.c_str(), filename.length());  // Write filename first
-    store_->get(filename, output);   // Then append file content
+    store_->open_view(filename)->write_to(output);   // Then append file content from its mapped pages
     first_read = false;
     return output.good();
   };
@@ -155,9 +190,10 @@ std::function<bool(std::stringstream&)> FileServer::create_producer(
 
 std::function<bool(std::stringstream&, std::stringstream&)> FileServer::create_transform(
   MessageFrame& frame,
-  utils::Pipeliner* pipeline) {
+  utils::Pipeliner* pipeline,
+  Codec::Cipher cipher) {
   // Capture pipeline by value since it's a pointer
-  return [this, &frame, pipeline](std::stringstream& input, std::stringstream& output) -> bool {
+  return [this, &frame, pipeline, cipher](std::stringstream& input, std::stringstream& output) -> bool {
     frame.payload_stream = std::make_shared<std::stringstream>();
     *frame.payload_stream << input.rdbuf();
 
@@ -167,13 +203,29 @@ std::function<bool(std::stringstream&, std::stringstream&)> FileServer::create_t
     frame.payload_stream->seekg(0);
 
     // Serialize frame and update pipeline size
-    std::size_t total_serialized_size = codec_->serialize(frame, output);
+    std::size_t total_serialized_size = codec_->serialize(frame, output, cipher);
     pipeline->set_total_size(total_serialized_size);
 
     return true;
   };
 }
   
+Codec::Cipher FileServer::select_cipher(std::optional<uint8_t> peer_id) {
+  // Every codec accepts authenticated frames, but peers that negotiated a suite
+  // reject unauthenticated ones, so a pinned CBC cipher never overrides them
+  if (cipher_pinned_ && crypto::CryptoStream::isAuthenticated(codec_->get_cipher())) {
+    return codec_->get_cipher();
+  }
+  // A single peer gets the suite agreed with it, a broadcast the one every peer handles fastest
+  if (peer_id) {
+    if (auto peer = peer_manager_.get_peer(*peer_id)) {
+      return peer->get_negotiated_cipher();
+    }
+    return codec_->get_cipher();
+  }
+  return peer_manager_.get_broadcast_cipher().value_or(codec_->get_cipher());
+}
+
 bool FileServer::send_pipeline(dfs::utils::Pipeliner* const& pipeline, std::optional<uint8_t> peer_id) {
   // Send to single peer or broadcast to all depending on presence of peer ID
   if (peer_id) {
@@ -190,7 +242,6 @@ bool FileServer::send_pipeline(dfs::utils::Pipeliner* const& pipeline, std::opti
 //==============================================
 
 bool FileServer::store_file(const std::string& filename, std::istream& input) {
-  std::lock_guard<std::mutex> lock(mutex_);
   try {
     BOOST_LOG_TRIVIAL(info) << "File server: Storing file with filename: " << filename;
     // Validate input stream
@@ -227,7 +278,6 @@ bool FileServer::store_file(const std::string& filename, std::istream& input) {
 }
 
 bool FileServer::get_file(const std::string& filename) {
-  std::lock_guard<std::mutex> lock(mutex_);
   BOOST_LOG_TRIVIAL(info) << "File server: Attempting to get file: " << filename;
 
   // Try reading from local store first
@@ -239,6 +289,26 @@ bool FileServer::get_file(const std::string& filename) {
   return retrieve_from_network(filename);
 }
 
+std::optional<std::string> FileServer::get_file_range(const std::string& filename, uint64_t offset, uint64_t length) {
+  BOOST_LOG_TRIVIAL(info) << "File server: Attempting to get range [" << offset << ", +" << length
+                          << ") of file: " << filename;
+
+  // Try reading the range from local store first
+  try {
+    if (store_->has(filename)) {
+      std::stringstream output;
+      store_->get_range(filename, offset, length, output);
+      return output.str();
+    }
+  } catch (const std::exception& e) {
+    BOOST_LOG_TRIVIAL(error) << "File server: Error reading range from local store: " << e.what();
+    return std::nullopt;
+  }
+
+  // If the file is not stored locally, ask peers for just the range
+  return retrieve_range_from_network(filename, ByteRange{offset, length});
+}
+
 bool FileServer::read_from_local_store(const std::string& filename) {
   try {
     // Check if file exists locally
@@ -283,6 +353,40 @@ bool FileServer::retrieve_from_network(const std::string& filename) {
   return false;
 }
 
+std::optional<std::string> FileServer::retrieve_range_from_network(const std::string& filename,
+                                                                   const ByteRange& range) {
+  // Replies are matched by request ID, so concurrent reads of one range never share an answer
+  ByteRange request = range;
+  {
+    std::lock_guard<std::mutex> lock(range_mutex_);
+    request.request_id = next_range_id_++;
+    pending_ranges_[request.request_id] = std::nullopt;
+  }
+
+  // Send GET_RANGE request to network peers
+  if (!prepare_and_send(filename, MessageType::GET_RANGE, std::nullopt, request)) {
+    BOOST_LOG_TRIVIAL(error) << "File server: Failed to send GET_RANGE request for: " << filename;
+    std::lock_guard<std::mutex> lock(range_mutex_);
+    pending_ranges_.erase(request.request_id);
+    return std::nullopt;
+  }
+
+  // Wait for the first peer to answer
+  std::unique_lock<std::mutex> lock(range_mutex_);
+  range_cv_.wait_for(lock, RANGE_TIMEOUT, [this, &request] {
+    return pending_ranges_[request.request_id].has_value();
+  });
+  std::optional<std::string> result = std::move(pending_ranges_[request.request_id]);
+  pending_ranges_.erase(request.request_id);
+
+  if (result) {
+    BOOST_LOG_TRIVIAL(info) << "File server: Range of " << result->size() << " bytes retrieved from network: " << filename;
+  } else {
+    BOOST_LOG_TRIVIAL(info) << "File server: Range not found: " << filename;
+  }
+  return result;
+}
+
 //==============================================
 // Handling of incoming frames
 //==============================================
@@ -331,6 +435,20 @@ void FileServer::message_handler(const MessageFrame& frame) {
         }
         break;
 
+      case MessageType::GET_RANGE:
+        BOOST_LOG_TRIVIAL(debug) << "File server: Forwarding to handle_get_range";
+        if (!handle_get_range(frame)) {
+          BOOST_LOG_TRIVIAL(error) << "File server: Failed to handle get range message";
+        }
+        break;
+
+      case MessageType::RANGE_DATA:
+        BOOST_LOG_TRIVIAL(debug) << "File server: Forwarding to handle_range_data";
+        if (!handle_range_data(frame)) {
+          BOOST_LOG_TRIVIAL(error) << "File server: Failed to handle range data message";
+        }
+        break;
+
       default:
         BOOST_LOG_TRIVIAL(warning) << "File server: Unknown message type: " << static_cast<int>(frame.message_type);
         break;
@@ -360,9 +478,19 @@ bool FileServer::handle_store(const MessageFrame& frame) {
       return false;
     }
 
-    // Store the file using the Store class
+    // Store the file as an evictable replica. Chunked, packed and compressed
+    // objects go through the store's layout path; large plain objects stream
+    // into a file preallocated from the payload size, which bounds the decrypted size
     try {
-      store_->store(filename, *frame.payload_stream);
+      uint64_t expected_size = frame.payload_size > frame.filename_length ? frame.payload_size - frame.filename_length : 0;
+      bool packable = store_->is_packing_enabled() && expected_size <= dfs::store::PackStore::MAX_OBJECT_SIZE;
+      if (store_->is_chunking_enabled() || store_->is_compression_enabled() || packable) {
+        store_->store(filename, *frame.payload_stream, dfs::store::ObjectOrigin::Replica);
+      } else {
+        auto writer = store_->open_writer(filename, expected_size, dfs::store::ObjectOrigin::Replica);
+        writer->append(*frame.payload_stream);
+        writer->commit();
+      }
       BOOST_LOG_TRIVIAL(info) << "File server: Successfully stored file: " << filename;
       return true;
     } catch (const std::exception& e) {
@@ -408,6 +536,76 @@ bool FileServer::handle_get(const MessageFrame& frame) {
   }
 }
 
+bool FileServer::handle_get_range(const MessageFrame& frame) {
+  try {
+    BOOST_LOG_TRIVIAL(info) << "File server: Handling get range message frame";
+
+    // Extract filename and requested range from frame
+    std::string filename = extract_filename(frame);
+    ByteRange range = extract_range(frame);
+
+    // Check if file exists locally
+    if (!store_->has(filename)) {
+      BOOST_LOG_TRIVIAL(info) << "File server: File not found locally: " << filename;
+      return false;
+    }
+
+    // A range starting past the end is answered at once with no bytes
+    if (range.offset >= store_->get_file_size(filename)) {
+      BOOST_LOG_TRIVIAL(info) << "File server: Range starts past end of file, sending empty reply: " << filename;
+      range.length = 0;
+    }
+
+    // Send only the requested bytes back to the requesting peer
+    if (!prepare_and_send(filename, MessageType::RANGE_DATA, frame.source_id, range)) {
+      BOOST_LOG_TRIVIAL(error) << "File server: Failed to send range of file: " << filename;
+      return false;
+    }
+
+    BOOST_LOG_TRIVIAL(info) << "File server: Successfully handled get range request for file: " << filename;
+    return true;
+  } catch (const std::exception& e) {
+    BOOST_LOG_TRIVIAL(error) << "File server: Error in handle_get_range: " << e.what();
+    return false;
+  }
+}
+
+bool FileServer::handle_range_data(const MessageFrame& frame) {
+  try {
+    BOOST_LOG_TRIVIAL(info) << "File server: Handling range data message frame";
+
+    std::string filename = extract_filename(frame);
+    ByteRange range = extract_range(frame);
+
+    // Check the claimed length against the payload before allocating for it
+    uint64_t header_size = frame.filename_length + RANGE_SIZE;
+    if (frame.payload_size < header_size || range.length > frame.payload_size - header_size) {
+      BOOST_LOG_TRIVIAL(error) << "File server: Range length " << range.length
+                               << " exceeds payload of range data for file: " << filename;
+      return false;
+    }
+    std::string data(range.length, '\0');
+    if (range.length > 0 && !frame.payload_stream->read(data.data(), range.length)) {
+      BOOST_LOG_TRIVIAL(error) << "File server: Truncated range data for file: " << filename;
+      return false;
+    }
+
+    // Hand the bytes to the waiting request, the first reply wins
+    std::lock_guard<std::mutex> lock(range_mutex_);
+    auto pending = pending_ranges_.find(range.request_id);
+    if (pending == pending_ranges_.end() || pending->second) {
+      BOOST_LOG_TRIVIAL(debug) << "File server: Ignoring unrequested range of file: " << filename;
+      return true;
+    }
+    pending->second = std::move(data);
+    range_cv_.notify_all();
+    return true;
+  } catch (const std::exception& e) {
+    BOOST_LOG_TRIVIAL(error) << "File server: Error in handle_range_data: " << e.what();
+    return false;
+  }
+}
+
 std::string FileServer::extract_filename(const MessageFrame& frame) {
   if (!frame.payload_stream) {
     throw std::runtime_error("File server: Invalid payload stream");
@@ -438,5 +636,23 @@ std::string FileServer::extract_filename(const MessageFrame& frame) {
   }
 }
 
+ByteRange FileServer::extract_range(const MessageFrame& frame) {
+  // The range directly follows the filename read by extract_filename
+  uint64_t network_range[3];
+  if (!frame.payload_stream->read(reinterpret_cast<char*>(network_range), sizeof(network_range))) {
+    throw std::runtime_error("File server: Failed to read byte range");
+  }
+  return ByteRange{boost::endian::big_to_native(network_range[0]),
+                   boost::endian::big_to_native(network_range[1]),
+                   boost::endian::big_to_native(network_range[2])};
+}
+
+void FileServer::write_range(std::ostream& output, const ByteRange& range) {
+  uint64_t network_range[3] = {boost::endian::native_to_big(range.offset),
+                               boost::endian::native_to_big(range.length),
+                               boost::endian::native_to_big(range.request_id)};
+  output.write(reinterpret_cast<const char*>(network_range), sizeof(network_range));
+}
+
 } // namespace network
 } // namespace dfs
\ No newline at end of file
@@ -0,0 +1,137 @@
+#include "store/ingester.hpp"
+#include <boost/log/core.hpp>
+#include <boost/log/expressions.hpp>
+#include <boost/log/trivial.hpp>
+#include <iostream>
+#include <string>
+#include <unordered_map>
+
+struct IngestProgramOptions {
+  std::string source;
+  std::string store;
+  dfs::store::IngestOptions ingest;
+  bool pack{false};
+  bool compress{false};
+  bool verbose{false};
+  bool valid{false};
+};
+
+void print_usage(const std::string& program_name) {
+  std::cerr << "Usage: " << program_name << " -s <source> -d <store> [options]\n"
+        << "Required arguments:\n"
+        << "  -s, --source      Directory tree to ingest\n"
+        << "  -d, --store       Store directory of the node to seed\n"
+        << "Options:\n"
+        << "  -t, --threads     Worker threads (default: one per core)\n"
+        << "  -c, --checkpoint  Checkpoint log (default: <store>/" << dfs::store::Ingester::CHECKPOINT_FILENAME << ")\n"
+        << "  -x, --prefix      Prefix added to every key\n"
+        << "  --pack            Append small files to pack segments\n"
+        << "  --compress        Compress file contents\n"
+        << "  --verbose         Log every stored file\n"
+        << "Example: " << program_name << " -s ./dataset -d \"File server: fileserver_1\" -t 8\n";
+}
+
+IngestProgramOptions parse_command_line(int argc, char* argv[]) {
+  const std::unordered_map<std::string, std::string*> flag_map = {
+    {"-s", nullptr},
+    {"--source", nullptr},
+    {"-d", nullptr},
+    {"--store", nullptr},
+    {"-t", nullptr},
+    {"--threads", nullptr},
+    {"-c", nullptr},
+    {"--checkpoint", nullptr},
+    {"-x", nullptr},
+    {"--prefix", nullptr}
+  };
+
+  IngestProgramOptions options;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string flag(argv[i]);
+
+    // Switches take no value
+    if (flag == "--pack") {
+      options.pack = true;
+      continue;
+    } else if (flag == "--compress") {
+      options.compress = true;
+      continue;
+    } else if (flag == "--verbose") {
+      options.verbose = true;
+      continue;
+    }
+
+    if (flag_map.count(flag) == 0 || i + 1 >= argc) {
+      std::cerr << "Error: Unknown or incomplete argument: " << flag << '\n';
+      print_usage(argv[0]);
+      return options;
+    }
+    const std::string value(argv[++i]);
+
+    if (flag == "-s" || flag == "--source") {
+      options.source = value;
+    } else if (flag == "-d" || flag == "--store") {
+      options.store = value;
+    } else if (flag == "-t" || flag == "--threads") {
+      try {
+        options.ingest.threads = static_cast<size_t>(std::stoul(value));
+      } catch (...) {
+        std::cerr << "Error: Invalid thread count\n";
+        print_usage(argv[0]);
+        return options;
+      }
+    } else if (flag == "-c" || flag == "--checkpoint") {
+      options.ingest.checkpoint = value;
+    } else if (flag == "-x" || flag == "--prefix") {
+      options.ingest.prefix = value;
+    }
+  }
+
+  if (options.source.empty() || options.store.empty()) {
+    std::cerr << "Error: Both source and store are required\n";
+    print_usage(argv[0]);
+    return options;
+  }
+
+  options.valid = true;
+  return options;
+}
+
+bool run_ingest(const IngestProgramOptions& options) {
+  // Per-file store messages would cost more than the copies themselves
+  if (!options.verbose) {
+    boost::log::core::get()->set_filter(boost::log::trivial::severity >= boost::log::trivial::warning);
+  }
+
+  try {
+    dfs::store::Store store(options.store);
+    // Every checkpointed file must survive a crash, concurrent workers share the fsyncs
+    store.set_durability(dfs::store::Durability::GroupCommit);
+    store.set_packing(options.pack);
+    store.set_compression(options.compress);
+
+    dfs::store::Ingester ingester(store, options.source, options.ingest);
+    dfs::store::IngestStats stats = ingester.run();
+
+    double megabytes = static_cast<double>(stats.bytes) / (1024.0 * 1024.0);
+    std::cout << "Stored " << stats.files << " files (" << megabytes << " MB) in " << stats.seconds << " s";
+    if (stats.seconds > 0) {
+      std::cout << ", " << megabytes / stats.seconds << " MB/s";
+    }
+    std::cout << "\nSkipped " << stats.skipped << " files already ingested, " << stats.failed << " failed\n";
+    return stats.failed == 0;
+  } catch (const std::exception& e) {
+    std::cerr << "Error: Ingest failed: " << e.what() << '\n';
+    return false;
+  }
+}
+
+int main(int argc, char* argv[]) {
+  if (const auto options = parse_command_line(argc, argv); !options.valid) {
+    return 1;
+  } else if (!run_ingest(options)) {
+    return 1;
+  }
+  return 0;
+}
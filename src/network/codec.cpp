@@ -1,3 +1,4 @@
+#include <cstring>
 #include <sstream>
 #include <stdexcept>
 #include "network/codec.hpp"
@@ -11,9 +12,10 @@ namespace network {
 // CONSTRUCTOR AND DESTRUCTOR
 //==============================================
   
-Codec::Codec(const std::vector<uint8_t>& key, Channel& channel) 
+Codec::Codec(const std::vector<uint8_t>& key, Channel& channel, Cipher cipher) 
   : key_(key)
-  , channel_(channel) {
+  , channel_(channel)
+  , cipher_(cipher) {
   BOOST_LOG_TRIVIAL(info) << "Codec: Initializing Codec with key of size: " << key_.size();
 }
 
@@ -23,6 +25,10 @@ Codec::Codec(const std::vector<uint8_t>& key, Channel& channel)
 //==============================================
 
 std::size_t Codec::serialize(const MessageFrame& frame, std::ostream& output) {
+  return serialize(frame, output, cipher_);
+}
+
+std::size_t Codec::serialize(const MessageFrame& frame, std::ostream& output, Cipher cipher) {
   if (!output.good()) {
     BOOST_LOG_TRIVIAL(error) << "Codec: Invalid output stream state";
     throw std::runtime_error("Codec: Invalid output stream");
@@ -30,59 +36,63 @@ std::size_t Codec::serialize(const MessageFrame& frame, std::ostream& output) {
 
   std::size_t total_bytes = 0;
 
-  // Create and itialize crypto stream with key and IV
-  crypto::CryptoStream filename_crypto;
-  crypto::CryptoStream payload_crypto;
-
-  filename_crypto.initialize(key_, frame.iv_);
-  payload_crypto.initialize(key_, frame.iv_);
+  // Create and itialize crypto stream with key and IV. One stream encrypts
+  // the filename length and payload so a record nonce is never reused
+  crypto::CryptoStream crypto;
+  crypto.setCipher(cipher);
+  crypto.initialize(key_, frame.iv_);
 
   BOOST_LOG_TRIVIAL(info) << "Codec: Starting message frame serialization";
 
   try {
+    std::vector<uint8_t> header;
+
     // Write IV as first header
     BOOST_LOG_TRIVIAL(debug) << "Codec: Writing IV of size: " << frame.iv_.size();
-    write_bytes(output, frame.iv_.data(), frame.iv_.size());
-    total_bytes += frame.iv_.size();
+    append_header(header, frame.iv_.data(), frame.iv_.size());
+
+    // Write cipher
+    uint8_t cipher_id = static_cast<uint8_t>(cipher);
+    BOOST_LOG_TRIVIAL(debug) << "Codec: Writing cipher: " << static_cast<int>(cipher_id);
+    append_header(header, &cipher_id, sizeof(cipher_id));
 
     // Write message type
     uint8_t msg_type = static_cast<uint8_t>(frame.message_type);
     BOOST_LOG_TRIVIAL(debug) << "Codec: Writing message type: " << static_cast<int>(msg_type);
-    write_bytes(output, &msg_type, sizeof(msg_type));
-    total_bytes += sizeof(msg_type);
+    append_header(header, &msg_type, sizeof(msg_type));
 
     // Write source id 
     BOOST_LOG_TRIVIAL(debug) << "Codec: Writing source id: " << static_cast<int>(frame.source_id);
-    write_bytes(output, &frame.source_id, sizeof(frame.source_id));
-    total_bytes += sizeof(frame.source_id);
+    append_header(header, &frame.source_id, sizeof(frame.source_id));
 
     // Write payload size in network byte order
     uint64_t network_payload_size = boost::endian::native_to_big(frame.payload_size);
     BOOST_LOG_TRIVIAL(debug) << "Codec: Writing payload size: " << frame.payload_size;
-    write_bytes(output, &network_payload_size, sizeof(network_payload_size));
-    total_bytes += sizeof(network_payload_size);
+    append_header(header, &network_payload_size, sizeof(network_payload_size));
+
+    write_bytes(output, header.data(), header.size());
+    total_bytes += header.size();
+    crypto.setAssociatedData(header);
 
     // Encrypt filename length
     BOOST_LOG_TRIVIAL(debug) << "Codec: Writing filename length: " << frame.filename_length;
     // Convert to network byte order
     uint32_t network_filename_length = boost::endian::native_to_big(frame.filename_length);
-    // Create stream for raw data
-    std::stringstream filename_length_stream;
-    filename_length_stream.write(reinterpret_cast<char*>(&network_filename_length), sizeof(network_filename_length));
-    // Encrypt the filename length
-    std::stringstream encrypted_filename_length;
-    filename_crypto.encrypt(filename_length_stream, encrypted_filename_length);
+    // Encrypt the filename length in place
+    FilenameLengthBuffer filename_length_buffer;
+    std::memcpy(filename_length_buffer.data(), &network_filename_length, sizeof(network_filename_length));
+    std::size_t encrypted_size = crypto.encryptInPlace(filename_length_buffer, sizeof(network_filename_length));
     // Write filename length
     BOOST_LOG_TRIVIAL(debug) << "Codec: Writing encrypted filename length";
-    write_bytes(output, encrypted_filename_length.str().data(), encrypted_filename_length.str().size());
-    total_bytes += encrypted_filename_length.str().size();
+    write_bytes(output, filename_length_buffer.data(), encrypted_size);
+    total_bytes += encrypted_size;
 
     // Encrypt and write payload if present
     if (frame.payload_size > 0 && frame.payload_stream) {
       BOOST_LOG_TRIVIAL(debug) << "Codec: Encrypting and writing payload of size: " << frame.payload_size;
       frame.payload_stream->seekg(0);
-      payload_crypto.encrypt(*frame.payload_stream, output);
-      total_bytes += get_padded_size(frame.payload_size);
+      crypto.encrypt(*frame.payload_stream, output);
+      total_bytes += crypto.getCiphertextSize(frame.payload_size);
     } 
 
     output.flush();
@@ -105,69 +115,86 @@ MessageFrame Codec::deserialize(std::istream& input) {
   std::size_t total_bytes = 0;
 
   // Create CryptoStream instance
-  crypto::CryptoStream filename_crypto;
-  crypto::CryptoStream payload_crypto;
+  crypto::CryptoStream crypto;
 
   BOOST_LOG_TRIVIAL(info) << "Codec: Starting message frame deserialization";
 
   try {
+    std::vector<uint8_t> header;
+
     // Read IV first
     frame.iv_.resize(crypto::CryptoStream::IV_SIZE);
     BOOST_LOG_TRIVIAL(debug) << "Codec: Reading IV";
     read_bytes(input, frame.iv_.data(), frame.iv_.size());
-    total_bytes += frame.iv_.size();
+    append_header(header, frame.iv_.data(), frame.iv_.size());
+
+    // Read cipher, never weaker than our own
+    uint8_t cipher_id;
+    read_bytes(input, &cipher_id, sizeof(cipher_id));
+    append_header(header, &cipher_id, sizeof(cipher_id));
+    if (cipher_id > static_cast<uint8_t>(Cipher::ChaCha20Poly1305)) {
+      BOOST_LOG_TRIVIAL(error) << "Codec: Unknown cipher: " << static_cast<int>(cipher_id);
+      throw std::runtime_error("Codec: Unknown cipher");
+    }
+    Cipher cipher = static_cast<Cipher>(cipher_id);
+    if (crypto::CryptoStream::isAuthenticated(cipher_) && !crypto::CryptoStream::isAuthenticated(cipher)) {
+      BOOST_LOG_TRIVIAL(error) << "Codec: Rejecting unauthenticated frame";
+      throw std::runtime_error("Codec: Unauthenticated frame");
+    }
+    BOOST_LOG_TRIVIAL(debug) << "Codec: Read cipher: " << static_cast<int>(cipher_id);
 
     // Initialize crypto stream with key and IV
-    filename_crypto.initialize(key_, frame.iv_);
-    payload_crypto.initialize(key_, frame.iv_);
-
+    crypto.setCipher(cipher);
+    crypto.initialize(key_, frame.iv_);
 
     // Read message type
     uint8_t msg_type;
     read_bytes(input, &msg_type, sizeof(msg_type));
+    append_header(header, &msg_type, sizeof(msg_type));
     frame.message_type = static_cast<MessageType>(msg_type);
     BOOST_LOG_TRIVIAL(debug) << "Codec: Read message type: " << static_cast<int>(msg_type);
-    total_bytes += sizeof(msg_type);
 
     // Read source id
     uint8_t source_id;
     read_bytes(input, &source_id, sizeof(source_id));
+    append_header(header, &source_id, sizeof(source_id));
     frame.source_id = source_id;
     BOOST_LOG_TRIVIAL(debug) << "Codec: Read source id: " << static_cast<int>(source_id);
-    total_bytes += sizeof(source_id);
 
     // Read payload size
     uint64_t network_payload_size;
     read_bytes(input, &network_payload_size, sizeof(network_payload_size));
+    append_header(header, &network_payload_size, sizeof(network_payload_size));
     frame.payload_size = boost::endian::big_to_native(network_payload_size);
     BOOST_LOG_TRIVIAL(debug) << "Codec: Read payload size: " << frame.payload_size;
-    total_bytes += sizeof(network_payload_size);
+    total_bytes += header.size();
+    crypto.setAssociatedData(header);
 
     // Decrypt filename length
-    // create buffer and read 1 block of encrypted data into it
-    std::vector<char> encrypted_filename_length(crypto::CryptoStream::BLOCK_SIZE);
-    read_bytes(input, encrypted_filename_length.data(), encrypted_filename_length.size());
-    // Create stream for encrypted data and copy encrypted data into it
-    std::stringstream encrypted_filename_length_stream;
-    encrypted_filename_length_stream.write(encrypted_filename_length.data(), encrypted_filename_length.size());
-    // Create stream for decrypted data and decrypt filename_length into it
-    std::stringstream decrypted_filename_length_stream;
-    filename_crypto.decrypt(encrypted_filename_length_stream, decrypted_filename_length_stream);
-    // Create variable for network ordered filename_length and read decrypted data into it
+    // read the encrypted filename length into a buffer and decrypt it in place
     uint32_t network_filename_length;
-    decrypted_filename_length_stream.read(reinterpret_cast<char*>(&network_filename_length), sizeof(network_filename_length));
+    FilenameLengthBuffer filename_length_buffer;
+    std::size_t encrypted_size = crypto.getCiphertextSize(sizeof(network_filename_length));
+    read_bytes(input, filename_length_buffer.data(), encrypted_size);
+    std::size_t decrypted_size = crypto.decryptInPlace({filename_length_buffer.data(), encrypted_size});
+    if (decrypted_size != sizeof(network_filename_length)) {
+      BOOST_LOG_TRIVIAL(error) << "Codec: Invalid filename length of " << decrypted_size << " bytes";
+      throw std::runtime_error("Codec: Invalid filename length");
+    }
+    // Read the network ordered filename_length from the decrypted data
+    std::memcpy(&network_filename_length, filename_length_buffer.data(), sizeof(network_filename_length));
     // Convert to host byte order
     frame.filename_length = boost::endian::big_to_native(network_filename_length);
     BOOST_LOG_TRIVIAL(debug) << "Codec: Read decrypted filename length: " << frame.filename_length;
-    total_bytes += encrypted_filename_length.size();
+    total_bytes += encrypted_size;
 
     frame.payload_stream = std::make_shared<std::stringstream>(); 
 
     // Decrypt payload if present
     if (frame.payload_size > 0) {
       BOOST_LOG_TRIVIAL(debug) << "Codec: Decrypting payload of size: " << frame.payload_size;
-      payload_crypto.decrypt(input, *frame.payload_stream);
-      total_bytes += frame.payload_size;
+      crypto.decrypt(input, *frame.payload_stream);
+      total_bytes += crypto.getCiphertextSize(frame.payload_size);
       frame.payload_stream->seekg(0);
     }
 
@@ -202,13 +229,9 @@ void Codec::read_bytes(std::istream& input, void* data, std::size_t size) {
   }
 }
 
-
-//==============================================
-// UTILITY METHODS
-//==============================================
-
-size_t Codec::get_padded_size(size_t original_size) {
-    return ((original_size + crypto::CryptoStream::BLOCK_SIZE -1) / crypto::CryptoStream::BLOCK_SIZE) * crypto::CryptoStream::BLOCK_SIZE;
+void Codec::append_header(std::vector<uint8_t>& header, const void* data, std::size_t size) {
+  const uint8_t* bytes = static_cast<const uint8_t*>(data);
+  header.insert(header.end(), bytes, bytes + size);
 }
 
 } // namespace network
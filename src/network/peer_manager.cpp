@@ -29,7 +29,8 @@ PeerManager::~PeerManager() {
 // PEER CREATION AND MANAGEMENT
 //==============================================
   
-void PeerManager::create_peer(std::shared_ptr<boost::asio::ip::tcp::socket> socket, uint8_t peer_id) {
+void PeerManager::create_peer(std::shared_ptr<boost::asio::ip::tcp::socket> socket, uint8_t peer_id,
+                              Codec::Cipher cipher, std::vector<crypto::SuiteSpeed> remote_suites) {
   try {
 
     // Create new TCP peer with channel and default key
@@ -37,6 +38,7 @@ void PeerManager::create_peer(std::shared_ptr<boost::asio::ip::tcp::socket> sock
 
     // Move the accepted socket to the peer
     peer->get_socket() = std::move(*socket);
+    peer->set_cipher_suites(cipher, std::move(remote_suites));
 
     // Add peer to map
     add_peer(peer);
@@ -237,6 +239,34 @@ bool PeerManager::broadcast_stream(dfs::utils::Pipeliner& pipeline) {
   return all_success;
 }
 
+//==============================================
+// CIPHER NEGOTIATION
+//==============================================
+
+std::optional<Codec::Cipher> PeerManager::get_broadcast_cipher() const {
+  std::vector<std::vector<crypto::SuiteSpeed>> offers{crypto::CipherBenchmark::shared().get_results()};
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (peers_.empty()) {
+      return std::nullopt;
+    }
+    for (const auto& peer_pair : peers_) {
+      offers.push_back(peer_pair.second->get_remote_suites());
+    }
+  }
+  return crypto::CipherBenchmark::select(offers);
+}
+
+std::map<uint8_t, Codec::Cipher> PeerManager::get_negotiated_ciphers() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  std::map<uint8_t, Codec::Cipher> ciphers;
+  for (const auto& peer_pair : peers_) {
+    ciphers[peer_pair.first] = peer_pair.second->get_negotiated_cipher();
+  }
+  return ciphers;
+}
+
+
 //==============================================
 // UTILITY METHODS
 //==============================================
@@ -354,5 +354,11 @@ boost::asio::ip::tcp::socket& TCP_Peer::get_socket() {
   return *socket_;
 }
 
+void TCP_Peer::set_cipher_suites(Codec::Cipher negotiated, std::vector<crypto::SuiteSpeed> remote_suites) {
+  negotiated_cipher_ = negotiated;
+  remote_suites_ = std::move(remote_suites);
+  codec_->set_cipher(negotiated);
+}
+
 } // namespace network
 } // namespace dfs
\ No newline at end of file
@@ -1,7 +1,9 @@
 #include <thread>
 #include "network/tcp_server.hpp"
 #include "network/tcp_peer.hpp"
+#include "crypto/cipher_benchmark.hpp"
 #include <boost/bind/bind.hpp>
+#include <boost/endian/conversion.hpp>
 
 namespace dfs {
 namespace network {
@@ -142,8 +144,11 @@ bool TCP_Server::initiate_handshake(std::shared_ptr<boost::asio::ip::tcp::socket
     uint8_t peer_id = read_ID(socket);
     // Create peer only after full ID exchange
     if (peer_manager_ && !peer_manager_->has_peer(peer_id)) {
+      send_suites(socket);
+      auto remote_suites = read_suites(socket);
+      Codec::Cipher cipher = negotiate_cipher(peer_id, remote_suites);
       BOOST_LOG_TRIVIAL(debug) << "TCP server: Creating new peer with ID: " << static_cast<int>(peer_id);
-      peer_manager_->create_peer(socket, peer_id);
+      peer_manager_->create_peer(socket, peer_id, cipher, std::move(remote_suites));
       return true;
     }
     BOOST_LOG_TRIVIAL(warning) << "TCP server: Peer with ID " << static_cast<int>(peer_id) << " already exists";
@@ -197,9 +202,14 @@ void TCP_Server::receive_handshake(std::shared_ptr<boost::asio::ip::tcp::socket>
     }
     BOOST_LOG_TRIVIAL(debug) << "TCP server: Successfully sent ID back to peer";
 
+    // Both ends send their suites before reading, then pick the same one
+    send_suites(socket);
+    auto remote_suites = read_suites(socket);
+    Codec::Cipher cipher = negotiate_cipher(peer_id, remote_suites);
+
     BOOST_LOG_TRIVIAL(debug) << "TCP server: Creating new peer with ID: " << static_cast<int>(peer_id);
     // Create peer only after full ID exchange
-    peer_manager_->create_peer(socket, peer_id);
+    peer_manager_->create_peer(socket, peer_id, cipher, std::move(remote_suites));
     BOOST_LOG_TRIVIAL(debug) << "TCP server: Handshake complete for peer: " << static_cast<int>(peer_id);
   }
   catch (const std::exception& e) {
@@ -224,6 +234,68 @@ uint8_t TCP_Server::read_ID(std::shared_ptr<boost::asio::ip::tcp::socket> socket
 }
 
   
+//==============================================
+// CIPHER NEGOTIATION
+//==============================================
+
+void TCP_Server::send_suites(std::shared_ptr<boost::asio::ip::tcp::socket> socket) {
+  // Suite count, then each suite's cipher id and MB/s in network byte order
+  const auto& suites = crypto::CipherBenchmark::shared().get_results();
+  std::vector<uint8_t> offer{static_cast<uint8_t>(suites.size())};
+  for (const auto& suite : suites) {
+    offer.push_back(static_cast<uint8_t>(suite.cipher));
+    uint32_t network_speed = boost::endian::native_to_big(suite.megabytes_per_second);
+    const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&network_speed);
+    offer.insert(offer.end(), bytes, bytes + sizeof(network_speed));
+  }
+  boost::asio::write(*socket, boost::asio::buffer(offer));
+  BOOST_LOG_TRIVIAL(debug) << "TCP server: Sent " << suites.size() << " cipher suites";
+}
+
+std::vector<crypto::SuiteSpeed> TCP_Server::read_suites(std::shared_ptr<boost::asio::ip::tcp::socket> socket) {
+  uint8_t count;
+  boost::asio::read(*socket, boost::asio::buffer(&count, sizeof(count)));
+  if (count > MAX_SUITES) {
+    throw std::runtime_error("TCP server: Too many cipher suites offered");
+  }
+
+  std::vector<crypto::SuiteSpeed> suites;
+  for (uint8_t i = 0; i < count; ++i) {
+    uint8_t cipher_id;
+    uint32_t network_speed;
+    boost::asio::read(*socket, boost::asio::buffer(&cipher_id, sizeof(cipher_id)));
+    boost::asio::read(*socket, boost::asio::buffer(&network_speed, sizeof(network_speed)));
+    // Suites this node does not know are skipped, they can never be shared
+    auto cipher = static_cast<Codec::Cipher>(cipher_id);
+    if (cipher_id <= static_cast<uint8_t>(Codec::Cipher::ChaCha20Poly1305) &&
+        crypto::CryptoStream::isAuthenticated(cipher)) {
+      suites.push_back({cipher, boost::endian::big_to_native(network_speed)});
+    }
+  }
+  return suites;
+}
+
+Codec::Cipher TCP_Server::negotiate_cipher(uint8_t peer_id, const std::vector<crypto::SuiteSpeed>& remote_suites) {
+  const auto& benchmark = crypto::CipherBenchmark::shared();
+  auto cipher = crypto::CipherBenchmark::select({benchmark.get_results(), remote_suites});
+  if (!cipher) {
+    BOOST_LOG_TRIVIAL(error) << "TCP server: No cipher suite shared with peer " << static_cast<int>(peer_id);
+    throw std::runtime_error("TCP server: No shared cipher suite");
+  }
+
+  uint32_t remote_speed = 0;
+  for (const auto& suite : remote_suites) {
+    if (suite.cipher == *cipher) {
+      remote_speed = suite.megabytes_per_second;
+    }
+  }
+  BOOST_LOG_TRIVIAL(info) << "TCP server: Negotiated " << crypto::CipherBenchmark::get_name(*cipher)
+                          << " with peer " << static_cast<int>(peer_id) << " (local "
+                          << benchmark.get_throughput(*cipher) << " MB/s, remote " << remote_speed << " MB/s)";
+  return *cipher;
+}
+
+
 //==============================================
 // CONNECTION INITIATION
 //==============================================
@@ -0,0 +1,74 @@
+#include "store/access_tracker.hpp"
+#include <functional>
+#include <limits>
+
+namespace dfs {
+namespace store {
+
+//==============================================
+// TRACKING OPERATIONS
+//==============================================
+
+void AccessTracker::record(const std::string& key) {
+  uint64_t tick = ++clock_;
+  Shard& shard = shard_for(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  AccessStats& stats = shard.entries[key];
+  stats.last_access = tick;
+  if (stats.frequency < std::numeric_limits<uint32_t>::max()) {
+    stats.frequency++;
+  }
+}
+
+std::optional<AccessStats> AccessTracker::lookup(const std::string& key) const {
+  const Shard& shard = shard_for(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  auto it = shard.entries.find(key);
+  if (it == shard.entries.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void AccessTracker::forget(const std::string& key) {
+  Shard& shard = shard_for(key);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.entries.erase(key);
+}
+
+void AccessTracker::clear() {
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.entries.clear();
+  }
+}
+
+
+//==============================================
+// GETTERS
+//==============================================
+
+uint32_t AccessTracker::score(const std::optional<AccessStats>& stats) const {
+  if (!stats) {
+    return 0;
+  }
+  // Halve the frequency for every aging period the key sat idle
+  uint64_t idle_periods = (clock_ - stats->last_access) / AGING_PERIOD;
+  return idle_periods >= 32 ? 0 : stats->frequency >> idle_periods;
+}
+
+
+//==============================================
+// UTILITY METHODS
+//==============================================
+
+AccessTracker::Shard& AccessTracker::shard_for(const std::string& key) {
+  return shards_[std::hash<std::string>{}(key) % SHARD_COUNT];
+}
+
+const AccessTracker::Shard& AccessTracker::shard_for(const std::string& key) const {
+  return shards_[std::hash<std::string>{}(key) % SHARD_COUNT];
+}
+
+} // namespace store
+} // namespace dfs
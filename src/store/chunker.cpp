@@ -0,0 +1,72 @@
+#include "store/chunker.hpp"
+#include <algorithm>
+#include <bit>
+#include "store/store.hpp"
+
+namespace dfs {
+namespace store {
+
+//==============================================
+// CONSTRUCTOR AND DESTRUCTOR
+//==============================================
+
+Chunker::Chunker(size_t min_size, size_t avg_size, size_t max_size)
+  : min_size_(min_size)
+  , avg_size_(avg_size)
+  , max_size_(max_size) {
+  if (min_size_ == 0 || min_size_ > avg_size_ || avg_size_ > max_size_ || avg_size_ < 2 ||
+      !std::has_single_bit(avg_size_)) {
+    throw StoreError("Chunker: Invalid chunk size parameters");
+  }
+  mask_bits_ = static_cast<unsigned int>(std::countr_zero(avg_size_));
+}
+
+
+//==============================================
+// CHUNKING OPERATIONS
+//==============================================
+
+size_t Chunker::next_boundary(const uint8_t* data, size_t length) const {
+  if (length <= min_size_) {
+    return length;
+  }
+
+  const auto& gear = gear_table();
+  const size_t limit = std::min(length, max_size_);
+  const unsigned int shift = 64 - mask_bits_;
+  uint64_t hash = 0;
+
+  // Bytes below the minimum size still feed the hash so the window is warm
+  for (size_t i = 0; i < limit; ++i) {
+    hash = (hash << 1) + gear[data[i]];
+    if (i + 1 >= min_size_ && (hash >> shift) == 0) {
+      return i + 1;
+    }
+  }
+  return limit;
+}
+
+
+//==============================================
+// GEAR TABLE
+//==============================================
+
+const std::array<uint64_t, 256>& Chunker::gear_table() {
+  // Deterministic splitmix64 sequence so boundaries are stable across nodes
+  static const std::array<uint64_t, 256> table = [] {
+    std::array<uint64_t, 256> values{};
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    for (auto& value : values) {
+      state += 0x9E3779B97F4A7C15ULL;
+      uint64_t z = state;
+      z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+      z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+      value = z ^ (z >> 31);
+    }
+    return values;
+  }();
+  return table;
+}
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,108 @@
+#include "store/crc32c.hpp"
+#include <array>
+#include <cstring>
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace dfs {
+namespace store {
+
+namespace {
+
+// Castagnoli polynomial in reflected bit order
+constexpr uint32_t POLYNOMIAL = 0x82F63B78u;
+
+// TABLES[k][b] is the CRC of byte b followed by k zero bytes, letting the
+// software path fold eight input bytes per step
+using Tables = std::array<std::array<uint32_t, 256>, 8>;
+
+constexpr Tables make_tables() {
+  Tables tables{};
+  for (uint32_t byte = 0; byte < 256; ++byte) {
+    uint32_t crc = byte;
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ ((crc & 1) ? POLYNOMIAL : 0);
+    }
+    tables[0][byte] = crc;
+  }
+  for (size_t k = 1; k < tables.size(); ++k) {
+    for (uint32_t byte = 0; byte < 256; ++byte) {
+      uint32_t previous = tables[k - 1][byte];
+      tables[k][byte] = (previous >> 8) ^ tables[0][previous & 0xFF];
+    }
+  }
+  return tables;
+}
+
+constexpr Tables TABLES = make_tables();
+
+uint32_t update_software(uint32_t crc, const unsigned char* data, size_t length) {
+  while (length >= 8) {
+    uint32_t low = crc ^ (static_cast<uint32_t>(data[0]) | static_cast<uint32_t>(data[1]) << 8 |
+                          static_cast<uint32_t>(data[2]) << 16 | static_cast<uint32_t>(data[3]) << 24);
+    crc = TABLES[7][low & 0xFF] ^ TABLES[6][(low >> 8) & 0xFF] ^ TABLES[5][(low >> 16) & 0xFF] ^
+          TABLES[4][low >> 24] ^ TABLES[3][data[4]] ^ TABLES[2][data[5]] ^ TABLES[1][data[6]] ^
+          TABLES[0][data[7]];
+    data += 8;
+    length -= 8;
+  }
+  while (length--) {
+    crc = TABLES[0][(crc ^ *data++) & 0xFF] ^ (crc >> 8);
+  }
+  return crc;
+}
+
+#if defined(__x86_64__)
+// Compiled for SSE 4.2 on its own so the rest of the build keeps the baseline ISA
+__attribute__((target("sse4.2")))
+uint32_t update_hardware(uint32_t crc, const unsigned char* data, size_t length) {
+  uint64_t wide = crc;
+  while (length >= 8) {
+    uint64_t word;
+    std::memcpy(&word, data, sizeof(word));
+    wide = _mm_crc32_u64(wide, word);
+    data += 8;
+    length -= 8;
+  }
+  crc = static_cast<uint32_t>(wide);
+  while (length--) {
+    crc = _mm_crc32_u8(crc, *data++);
+  }
+  return crc;
+}
+#endif
+
+} // namespace
+
+//==============================================
+// CHECKSUM OPERATIONS
+//==============================================
+
+uint32_t Crc32c::update(uint32_t crc, const void* data, size_t length) {
+  const unsigned char* bytes = static_cast<const unsigned char*>(data);
+  crc = ~crc;
+#if defined(__x86_64__)
+  if (is_hardware_accelerated()) {
+    return ~update_hardware(crc, bytes, length);
+  }
+#endif
+  return ~update_software(crc, bytes, length);
+}
+
+
+//==============================================
+// GETTERS
+//==============================================
+
+bool Crc32c::is_hardware_accelerated() {
+#if defined(__x86_64__)
+  static const bool supported = __builtin_cpu_supports("sse4.2");
+  return supported;
+#else
+  return false;
+#endif
+}
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,260 @@
+#include "store/ingester.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstring>
+#include <fcntl.h>
+#include <fstream>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include <boost/log/trivial.hpp>
+#include "store/posix_io.hpp"
+
+namespace dfs {
+namespace store {
+
+//==============================================
+// CONSTRUCTOR AND DESTRUCTOR
+//==============================================
+
+Ingester::Ingester(Store& store, const std::filesystem::path& source, IngestOptions options)
+  : store_(store)
+  , source_(source)
+  , options_(std::move(options)) {
+  std::error_code ec;
+  if (!std::filesystem::is_directory(source_, ec)) {
+    BOOST_LOG_TRIVIAL(error) << "Ingester: Source is not a directory: " << source_;
+    throw StoreError("Ingester: Source is not a directory: " + source_.string());
+  }
+  checkpoint_path_ = options_.checkpoint.empty() ? store_.get_volumes().front() / CHECKPOINT_FILENAME
+                                                 : options_.checkpoint;
+  open_checkpoint();
+}
+
+Ingester::~Ingester() {
+  if (checkpoint_fd_ >= 0) {
+    ::fdatasync(checkpoint_fd_);
+    ::close(checkpoint_fd_);
+  }
+}
+
+
+//==============================================
+// INGEST OPERATIONS
+//==============================================
+
+IngestStats Ingester::run() {
+  files_ = 0;
+  bytes_ = 0;
+  skipped_ = 0;
+  failed_ = 0;
+  auto started = std::chrono::steady_clock::now();
+
+  size_t thread_count = options_.threads ? options_.threads : std::thread::hardware_concurrency();
+  thread_count = std::max<size_t>(thread_count, 1);
+  BOOST_LOG_TRIVIAL(info) << "Ingester: Ingesting " << source_ << " with " << thread_count << " threads, "
+                          << done_.size() << " files already checkpointed";
+
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    walking_ = true;
+  }
+  std::vector<std::thread> workers;
+  for (size_t i = 0; i < thread_count; ++i) {
+    workers.emplace_back(&Ingester::worker_loop, this);
+  }
+
+  // Workers must be stopped even if the walk fails
+  std::exception_ptr walk_error;
+  try {
+    walk();
+  } catch (...) {
+    walk_error = std::current_exception();
+  }
+  {
+    std::lock_guard<std::mutex> lock(queue_mutex_);
+    walking_ = false;
+  }
+  not_empty_.notify_all();
+  for (auto& worker : workers) {
+    worker.join();
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(checkpoint_mutex_);
+    if (unsynced_ > 0 && ::fdatasync(checkpoint_fd_) == 0) {
+      unsynced_ = 0;
+    }
+  }
+  if (walk_error) {
+    std::rethrow_exception(walk_error);
+  }
+
+  IngestStats stats;
+  stats.files = files_;
+  stats.bytes = bytes_;
+  stats.skipped = skipped_;
+  stats.failed = failed_;
+  stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - started).count();
+  BOOST_LOG_TRIVIAL(info) << "Ingester: Stored " << stats.files << " files (" << stats.bytes << " bytes) in "
+                          << stats.seconds << "s, skipped " << stats.skipped << ", failed " << stats.failed;
+  return stats;
+}
+
+
+//==============================================
+// GETTERS
+//==============================================
+
+size_t Ingester::get_checkpointed_count() const {
+  std::lock_guard<std::mutex> lock(checkpoint_mutex_);
+  return done_.size();
+}
+
+
+//==============================================
+// CHECKPOINT
+//==============================================
+
+void Ingester::open_checkpoint() {
+  // Records end in a newline, anything after the last one was torn by a crash
+  size_t complete = 0;
+  std::ifstream log(checkpoint_path_, std::ios::binary);
+  if (log) {
+    std::string contents((std::istreambuf_iterator<char>(log)), std::istreambuf_iterator<char>());
+    for (size_t end = contents.find('\n'); end != std::string::npos; end = contents.find('\n', complete)) {
+      if (end > complete) {
+        done_.insert(contents.substr(complete, end - complete));
+      }
+      complete = end + 1;
+    }
+    if (complete < contents.size()) {
+      BOOST_LOG_TRIVIAL(warning) << "Ingester: Dropping torn record at the end of " << checkpoint_path_;
+    }
+  }
+
+  checkpoint_fd_ = ::open(checkpoint_path_.c_str(), O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC, 0644);
+  if (checkpoint_fd_ < 0) {
+    BOOST_LOG_TRIVIAL(error) << "Ingester: Failed to open checkpoint " << checkpoint_path_ << ": "
+                             << std::strerror(errno);
+    throw StoreError("Ingester: Failed to open checkpoint: " + checkpoint_path_.string());
+  }
+  // Cut the torn record so the next one does not extend it
+  if (::ftruncate(checkpoint_fd_, static_cast<off_t>(complete)) != 0) {
+    BOOST_LOG_TRIVIAL(warning) << "Ingester: Failed to truncate checkpoint " << checkpoint_path_ << ": "
+                               << std::strerror(errno);
+  }
+}
+
+void Ingester::record_done(const std::string& key) {
+  std::string record = key + '\n';
+  std::lock_guard<std::mutex> lock(checkpoint_mutex_);
+  if (!io::write_all(checkpoint_fd_, record.data(), record.size())) {
+    BOOST_LOG_TRIVIAL(warning) << "Ingester: Failed to checkpoint " << key << ": " << std::strerror(errno);
+    return;
+  }
+  done_.insert(key);
+  if (++unsynced_ >= SYNC_INTERVAL && ::fdatasync(checkpoint_fd_) == 0) {
+    unsynced_ = 0;
+  }
+}
+
+bool Ingester::is_done(const std::string& key, uint64_t size) const {
+  {
+    std::lock_guard<std::mutex> lock(checkpoint_mutex_);
+    if (done_.count(key) == 0) {
+      return false;
+    }
+  }
+  // The log may outlive objects that were never made durable or were deleted since
+  try {
+    return store_.has(key) && store_.get_file_size(key) == size;
+  } catch (const StoreError&) {
+    return false;
+  }
+}
+
+
+//==============================================
+// WORKERS
+//==============================================
+
+void Ingester::walk() {
+  std::error_code ec;
+  std::filesystem::recursive_directory_iterator it(
+    source_, std::filesystem::directory_options::skip_permission_denied, ec);
+  for (std::filesystem::recursive_directory_iterator end; !ec && it != end; it.increment(ec)) {
+    std::error_code entry_ec;
+    if (!it->is_regular_file(entry_ec) || it->path() == checkpoint_path_) {
+      continue;
+    }
+    uint64_t size = it->file_size(entry_ec);
+    std::string key = options_.prefix + it->path().lexically_relative(source_).generic_string();
+    if (entry_ec) {
+      BOOST_LOG_TRIVIAL(warning) << "Ingester: Failed to stat " << it->path() << ": " << entry_ec.message();
+      failed_++;
+      continue;
+    }
+    // Checkpoint records are lines, so such a key could never be resumed
+    if (key.find('\n') != std::string::npos) {
+      BOOST_LOG_TRIVIAL(warning) << "Ingester: Skipping file with a newline in its name: " << it->path();
+      failed_++;
+      continue;
+    }
+    if (is_done(key, size)) {
+      skipped_++;
+      continue;
+    }
+
+    std::unique_lock<std::mutex> lock(queue_mutex_);
+    not_full_.wait(lock, [this] { return queue_.size() < QUEUE_CAPACITY; });
+    queue_.push_back(Task{it->path(), std::move(key), size});
+    lock.unlock();
+    not_empty_.notify_one();
+  }
+  if (ec) {
+    BOOST_LOG_TRIVIAL(error) << "Ingester: Failed to walk " << source_ << ": " << ec.message();
+    throw StoreError("Ingester: Failed to walk source: " + source_.string());
+  }
+}
+
+void Ingester::worker_loop() {
+  while (true) {
+    Task task;
+    {
+      std::unique_lock<std::mutex> lock(queue_mutex_);
+      not_empty_.wait(lock, [this] { return !queue_.empty() || !walking_; });
+      if (queue_.empty()) {
+        return;
+      }
+      task = std::move(queue_.front());
+      queue_.pop_front();
+    }
+    not_full_.notify_one();
+    ingest_file(task);
+  }
+}
+
+void Ingester::ingest_file(const Task& task) {
+  std::ifstream file(task.path, std::ios::binary);
+  if (!file) {
+    BOOST_LOG_TRIVIAL(warning) << "Ingester: Failed to open " << task.path;
+    failed_++;
+    return;
+  }
+  try {
+    store_.store(task.key, file, options_.origin);
+  } catch (const std::exception& e) {
+    BOOST_LOG_TRIVIAL(warning) << "Ingester: Failed to store " << task.path << ": " << e.what();
+    failed_++;
+    return;
+  }
+  // Only recorded once store() returned, so a resumed run never skips a half-written object
+  record_done(task.key);
+  files_++;
+  bytes_ += task.size;
+}
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,364 @@
+#include "store/io_ring.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/io_uring.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <vector>
+#include <boost/log/trivial.hpp>
+#include "store/store.hpp"
+
+namespace dfs {
+namespace store {
+
+namespace {
+
+int io_uring_setup(unsigned entries, io_uring_params* params) {
+  return static_cast<int>(::syscall(__NR_io_uring_setup, entries, params));
+}
+
+int io_uring_enter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags) {
+  return static_cast<int>(::syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, nullptr, 0));
+}
+
+int io_uring_register(int fd, unsigned opcode, void* arg, unsigned nr_args) {
+  return static_cast<int>(::syscall(__NR_io_uring_register, fd, opcode, arg, nr_args));
+}
+
+// Opcodes IoRing submits, all of which the kernel must support
+constexpr uint8_t REQUIRED_OPCODES[] = {IORING_OP_NOP, IORING_OP_OPENAT, IORING_OP_READ, IORING_OP_WRITE,
+                                        IORING_OP_FSYNC, IORING_OP_CLOSE};
+
+// Ring indices are shared with the kernel and need acquire/release ordering
+unsigned load_acquire(const unsigned* p) {
+  return __atomic_load_n(p, __ATOMIC_ACQUIRE);
+}
+
+void store_release(unsigned* p, unsigned value) {
+  __atomic_store_n(p, value, __ATOMIC_RELEASE);
+}
+
+} // namespace
+
+//==============================================
+// CONSTRUCTOR AND DESTRUCTOR
+//==============================================
+
+IoRing::IoRing(unsigned entries) {
+  io_uring_params params;
+  std::memset(&params, 0, sizeof(params));
+  ring_fd_ = io_uring_setup(entries, &params);
+  if (ring_fd_ < 0) {
+    BOOST_LOG_TRIVIAL(error) << "IO ring: Setup failed: " << std::strerror(errno);
+    throw StoreError("IO ring: Setup failed: " + std::string(std::strerror(errno)));
+  }
+
+  try {
+    map_rings(params);
+  } catch (...) {
+    ::close(ring_fd_);
+    throw;
+  }
+
+  reaper_ = std::thread(&IoRing::reap_loop, this);
+  BOOST_LOG_TRIVIAL(info) << "IO ring: Started with " << params.sq_entries << " submission entries";
+}
+
+IoRing::~IoRing() {
+  // Let in-flight operations finish, their buffers belong to the callers
+  {
+    std::unique_lock<std::mutex> lock(submit_mutex_);
+    slots_cv_.wait(lock, [this] { return in_flight_ == 0; });
+  }
+
+  // A no-op with null user data tells the completion thread to exit
+  try {
+    submit([](io_uring_sqe& sqe) {
+      sqe.opcode = IORING_OP_NOP;
+      sqe.user_data = 0;
+    }, nullptr);
+    reaper_.join();
+  } catch (const std::exception& e) {
+    BOOST_LOG_TRIVIAL(error) << "IO ring: Failed to stop completion thread: " << e.what();
+    reaper_.detach();
+  }
+
+  unmap_rings();
+  ::close(ring_fd_);
+  BOOST_LOG_TRIVIAL(info) << "IO ring: Stopped after " << submitted_ << " operations";
+}
+
+
+//==============================================
+// ASYNC OPERATIONS
+//==============================================
+
+std::future<int> IoRing::open(const std::string& path, int flags, mode_t mode, Completion on_complete) {
+  auto op = std::make_unique<Operation>();
+  op->on_complete = std::move(on_complete);
+  op->path = path;
+  const char* path_ptr = op->path.c_str();
+  return submit([path_ptr, flags, mode](io_uring_sqe& sqe) {
+    sqe.opcode = IORING_OP_OPENAT;
+    sqe.fd = AT_FDCWD;
+    sqe.addr = reinterpret_cast<uint64_t>(path_ptr);
+    sqe.len = mode;
+    sqe.open_flags = static_cast<uint32_t>(flags);
+  }, std::move(op));
+}
+
+std::future<int> IoRing::read(int fd, void* data, size_t length, uint64_t offset, Completion on_complete) {
+  auto op = std::make_unique<Operation>();
+  op->on_complete = std::move(on_complete);
+  return submit([fd, data, length, offset](io_uring_sqe& sqe) {
+    sqe.opcode = IORING_OP_READ;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<uint64_t>(data);
+    sqe.len = static_cast<uint32_t>(length);
+    sqe.off = offset;
+  }, std::move(op));
+}
+
+std::future<int> IoRing::write(int fd, const void* data, size_t length, uint64_t offset,
+                               Completion on_complete) {
+  auto op = std::make_unique<Operation>();
+  op->on_complete = std::move(on_complete);
+  return submit([fd, data, length, offset](io_uring_sqe& sqe) {
+    sqe.opcode = IORING_OP_WRITE;
+    sqe.fd = fd;
+    sqe.addr = reinterpret_cast<uint64_t>(data);
+    sqe.len = static_cast<uint32_t>(length);
+    sqe.off = offset;
+  }, std::move(op));
+}
+
+std::future<int> IoRing::fsync(int fd, bool data_only, Completion on_complete) {
+  auto op = std::make_unique<Operation>();
+  op->on_complete = std::move(on_complete);
+  return submit([fd, data_only](io_uring_sqe& sqe) {
+    sqe.opcode = IORING_OP_FSYNC;
+    sqe.fd = fd;
+    sqe.fsync_flags = data_only ? IORING_FSYNC_DATASYNC : 0;
+  }, std::move(op));
+}
+
+std::future<int> IoRing::close(int fd, Completion on_complete) {
+  auto op = std::make_unique<Operation>();
+  op->on_complete = std::move(on_complete);
+  return submit([fd](io_uring_sqe& sqe) {
+    sqe.opcode = IORING_OP_CLOSE;
+    sqe.fd = fd;
+  }, std::move(op));
+}
+
+
+//==============================================
+// GETTERS
+//==============================================
+
+bool IoRing::is_supported() {
+  static const bool supported = [] {
+    io_uring_params params;
+    std::memset(&params, 0, sizeof(params));
+    int fd = io_uring_setup(1, &params);
+    if (fd < 0) {
+      return false;
+    }
+
+    // Rings predating the probe lack the OPENAT and READ opcodes too
+    constexpr unsigned probe_ops = 256;
+    std::vector<char> buffer(sizeof(io_uring_probe) + probe_ops * sizeof(io_uring_probe_op), 0);
+    auto* probe = reinterpret_cast<io_uring_probe*>(buffer.data());
+    bool probed = io_uring_register(fd, IORING_REGISTER_PROBE, probe, probe_ops) == 0;
+    ::close(fd);
+    if (!probed) {
+      BOOST_LOG_TRIVIAL(info) << "IO ring: Kernel cannot report supported opcodes";
+      return false;
+    }
+    for (uint8_t opcode : REQUIRED_OPCODES) {
+      if (opcode > probe->last_op || !(probe->ops[opcode].flags & IO_URING_OP_SUPPORTED)) {
+        BOOST_LOG_TRIVIAL(info) << "IO ring: Kernel lacks opcode " << static_cast<int>(opcode);
+        return false;
+      }
+    }
+    return true;
+  }();
+  return supported;
+}
+
+size_t IoRing::get_in_flight() const {
+  std::lock_guard<std::mutex> lock(submit_mutex_);
+  return in_flight_;
+}
+
+
+//==============================================
+// RING MANAGEMENT
+//==============================================
+
+void IoRing::map_rings(const io_uring_params& params) {
+  rings_.sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+  rings_.cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(io_uring_cqe);
+
+  // Newer kernels share one mapping between both rings
+  bool single_map = params.features & IORING_FEAT_SINGLE_MMAP;
+  if (single_map) {
+    rings_.sq_map_size = std::max(rings_.sq_map_size, rings_.cq_map_size);
+  }
+
+  rings_.sq_map = ::mmap(nullptr, rings_.sq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                         ring_fd_, IORING_OFF_SQ_RING);
+  if (rings_.sq_map == MAP_FAILED) {
+    rings_.sq_map = nullptr;
+    throw StoreError("IO ring: Failed to map submission ring");
+  }
+
+  if (single_map) {
+    rings_.cq_map = rings_.sq_map;
+  } else {
+    rings_.cq_map = ::mmap(nullptr, rings_.cq_map_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                           ring_fd_, IORING_OFF_CQ_RING);
+    if (rings_.cq_map == MAP_FAILED) {
+      rings_.cq_map = nullptr;
+      unmap_rings();
+      throw StoreError("IO ring: Failed to map completion ring");
+    }
+  }
+
+  rings_.sqes_size = params.sq_entries * sizeof(io_uring_sqe);
+  void* sqes = ::mmap(nullptr, rings_.sqes_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE,
+                      ring_fd_, IORING_OFF_SQES);
+  if (sqes == MAP_FAILED) {
+    unmap_rings();
+    throw StoreError("IO ring: Failed to map submission entries");
+  }
+  rings_.sqes = static_cast<io_uring_sqe*>(sqes);
+
+  char* sq = static_cast<char*>(rings_.sq_map);
+  rings_.sq_head = reinterpret_cast<unsigned*>(sq + params.sq_off.head);
+  rings_.sq_tail = reinterpret_cast<unsigned*>(sq + params.sq_off.tail);
+  rings_.sq_mask = reinterpret_cast<unsigned*>(sq + params.sq_off.ring_mask);
+  rings_.sq_array = reinterpret_cast<unsigned*>(sq + params.sq_off.array);
+
+  char* cq = static_cast<char*>(rings_.cq_map);
+  rings_.cq_head = reinterpret_cast<unsigned*>(cq + params.cq_off.head);
+  rings_.cq_tail = reinterpret_cast<unsigned*>(cq + params.cq_off.tail);
+  rings_.cq_mask = reinterpret_cast<unsigned*>(cq + params.cq_off.ring_mask);
+  rings_.cqes = reinterpret_cast<io_uring_cqe*>(cq + params.cq_off.cqes);
+  rings_.cq_entries = params.cq_entries;
+}
+
+void IoRing::unmap_rings() {
+  if (rings_.sqes) {
+    ::munmap(rings_.sqes, rings_.sqes_size);
+  }
+  if (rings_.cq_map && rings_.cq_map != rings_.sq_map) {
+    ::munmap(rings_.cq_map, rings_.cq_map_size);
+  }
+  if (rings_.sq_map) {
+    ::munmap(rings_.sq_map, rings_.sq_map_size);
+  }
+  rings_ = Rings{};
+}
+
+std::future<int> IoRing::submit(std::function<void(io_uring_sqe&)> prepare, std::unique_ptr<Operation> op) {
+  std::future<int> result = op ? op->promise.get_future() : std::future<int>();
+  std::unique_lock<std::mutex> lock(submit_mutex_);
+
+  // Bound in-flight operations by the completion ring so none are dropped.
+  // Callbacks must not wait on the thread that would free a slot
+  bool from_callback = std::this_thread::get_id() == reaper_.get_id();
+  if (op && !from_callback) {
+    slots_cv_.wait(lock, [this] { return in_flight_ < rings_.cq_entries; });
+  }
+
+  unsigned tail = *rings_.sq_tail;
+  unsigned index = tail & *rings_.sq_mask;
+  io_uring_sqe& sqe = rings_.sqes[index];
+  std::memset(&sqe, 0, sizeof(sqe));
+  prepare(sqe);
+  sqe.user_data = reinterpret_cast<uint64_t>(op.get());
+  rings_.sq_array[index] = index;
+  store_release(rings_.sq_tail, tail + 1);
+
+  int submitted;
+  do {
+    submitted = io_uring_enter(ring_fd_, 1, 0, 0);
+  } while (submitted < 0 && errno == EINTR);
+
+  if (submitted < 1) {
+    // The kernel did not consume the entry, so it can be withdrawn
+    store_release(rings_.sq_tail, tail);
+    BOOST_LOG_TRIVIAL(error) << "IO ring: Submission failed: " << std::strerror(errno);
+    throw StoreError("IO ring: Submission failed: " + std::string(std::strerror(errno)));
+  }
+
+  if (op) {
+    // A callback's first follow-up takes over the slot of the completing
+    // operation, so chains stay within the bound
+    if (from_callback && callback_slot_free_) {
+      callback_slot_free_ = false;
+    } else {
+      in_flight_++;
+    }
+    op.release();  // Owned by the completion thread from here
+  }
+  submitted_++;
+  return result;
+}
+
+
+//==============================================
+// COMPLETION HANDLING
+//==============================================
+
+void IoRing::reap_loop() {
+  bool stopping = false;
+  while (!stopping) {
+    if (io_uring_enter(ring_fd_, 0, 1, IORING_ENTER_GETEVENTS) < 0 && errno != EINTR) {
+      BOOST_LOG_TRIVIAL(error) << "IO ring: Waiting for completions failed: " << std::strerror(errno);
+    }
+
+    unsigned head = *rings_.cq_head;
+    while (head != load_acquire(rings_.cq_tail)) {
+      io_uring_cqe& cqe = rings_.cqes[head & *rings_.cq_mask];
+      uint64_t user_data = cqe.user_data;
+      int res = cqe.res;
+      store_release(rings_.cq_head, ++head);
+
+      if (user_data == 0) {
+        stopping = true;
+        continue;
+      }
+
+      std::unique_ptr<Operation> op(reinterpret_cast<Operation*>(user_data));
+      {
+        std::lock_guard<std::mutex> lock(submit_mutex_);
+        callback_slot_free_ = true;
+      }
+      if (op->on_complete) {
+        try {
+          op->on_complete(res);
+        } catch (const std::exception& e) {
+          BOOST_LOG_TRIVIAL(error) << "IO ring: Completion callback failed: " << e.what();
+        }
+      }
+      op->promise.set_value(res);
+
+      {
+        std::lock_guard<std::mutex> lock(submit_mutex_);
+        if (callback_slot_free_) {
+          in_flight_--;
+          callback_slot_free_ = false;
+        }
+      }
+      slots_cv_.notify_all();
+    }
+  }
+}
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,242 @@
+#include "store/io_scheduler.hpp"
+#include <algorithm>
+#include <boost/log/trivial.hpp>
+
+namespace dfs {
+namespace store {
+
+namespace {
+
+size_t class_index(IoClass io_class) {
+  return static_cast<size_t>(io_class);
+}
+
+} // namespace
+
+//==============================================
+// GRANT
+//==============================================
+
+IoScheduler::Grant::Grant(Grant&& other) noexcept
+  : scheduler_(other.scheduler_)
+  , io_class_(other.io_class_) {
+  other.scheduler_ = nullptr;
+}
+
+IoScheduler::Grant& IoScheduler::Grant::operator=(Grant&& other) noexcept {
+  if (this != &other) {
+    release();
+    scheduler_ = other.scheduler_;
+    io_class_ = other.io_class_;
+    other.scheduler_ = nullptr;
+  }
+  return *this;
+}
+
+void IoScheduler::Grant::release() {
+  if (scheduler_) {
+    scheduler_->release(io_class_);
+    scheduler_ = nullptr;
+  }
+}
+
+
+//==============================================
+// CONSTRUCTOR AND DESTRUCTOR
+//==============================================
+
+IoScheduler::IoScheduler(size_t queue_depth) : queue_depth_(std::max<size_t>(queue_depth, 1)) {
+  Clock::time_point now = Clock::now();
+  for (auto& state : classes_) {
+    state.refilled = now;
+  }
+
+  // Foreground requests always find free slots, lower classes yield to them
+  // unless they have waited far longer than a client would
+  classes_[class_index(IoClass::Foreground)].budget.deadline = std::chrono::milliseconds(10);
+  classes_[class_index(IoClass::Replication)].budget.max_in_flight = std::max<size_t>(queue_depth_ / 2, 1);
+  classes_[class_index(IoClass::Replication)].budget.deadline = std::chrono::milliseconds(100);
+  classes_[class_index(IoClass::Background)].budget.max_in_flight = std::max<size_t>(queue_depth_ / 4, 1);
+  classes_[class_index(IoClass::Background)].budget.deadline = std::chrono::seconds(1);
+}
+
+
+//==============================================
+// SCHEDULING OPERATIONS
+//==============================================
+
+IoScheduler::Grant IoScheduler::acquire(IoClass io_class, uint64_t bytes) {
+  std::unique_lock<std::mutex> lock(mutex_);
+  ClassState& state = classes_[class_index(io_class)];
+  Request request;
+  request.bytes = bytes;
+  request.arrival = Clock::now();
+  request.deadline = request.arrival + state.budget.deadline;
+  state.queue.push_back(&request);
+  dispatch(request.arrival);
+
+  // Whoever wakes first when a rate budget recovers admits the next requests
+  while (!request.granted) {
+    Clock::duration wait = time_until_refill();
+    if (wait == Clock::duration::max()) {
+      request.cv.wait(lock);
+    } else {
+      request.cv.wait_for(lock, wait);
+    }
+    if (!request.granted) {
+      dispatch(Clock::now());
+    }
+  }
+  return Grant(this, io_class);
+}
+
+
+//==============================================
+// GETTERS AND SETTERS
+//==============================================
+
+void IoScheduler::set_budget(IoClass io_class, const IoBudget& budget) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ClassState& state = classes_[class_index(io_class)];
+  state.budget = budget;
+  state.byte_tokens = static_cast<double>(budget.bytes_per_second);
+  state.op_tokens = static_cast<double>(budget.ops_per_second);
+  state.refilled = Clock::now();
+  dispatch(state.refilled);
+  BOOST_LOG_TRIVIAL(info) << "IO scheduler: Class " << class_index(io_class) << " limited to "
+                          << budget.bytes_per_second << " bytes/s, " << budget.ops_per_second << " ops/s, "
+                          << budget.max_in_flight << " in flight";
+}
+
+IoBudget IoScheduler::get_budget(IoClass io_class) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return classes_[class_index(io_class)].budget;
+}
+
+IoClassStats IoScheduler::get_stats(IoClass io_class) const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return classes_[class_index(io_class)].stats;
+}
+
+size_t IoScheduler::get_in_flight() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return in_flight_;
+}
+
+size_t IoScheduler::get_queued() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  size_t queued = 0;
+  for (const auto& state : classes_) {
+    queued += state.queue.size();
+  }
+  return queued;
+}
+
+
+//==============================================
+// DISPATCH
+//==============================================
+
+void IoScheduler::release(IoClass io_class) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  ClassState& state = classes_[class_index(io_class)];
+  state.in_flight--;
+  in_flight_--;
+  dispatch(Clock::now());
+}
+
+void IoScheduler::dispatch(Clock::time_point now) {
+  for (auto& state : classes_) {
+    refill(state, now);
+  }
+
+  while (in_flight_ < queue_depth_) {
+    // The highest admissible class goes next unless another request is overdue
+    ClassState* next = nullptr;
+    ClassState* overdue = nullptr;
+    for (auto& state : classes_) {
+      if (state.queue.empty() || !can_admit(state)) {
+        continue;
+      }
+      if (!next) {
+        next = &state;
+      }
+      Clock::time_point deadline = state.queue.front()->deadline;
+      if (deadline <= now && (!overdue || deadline < overdue->queue.front()->deadline)) {
+        overdue = &state;
+      }
+    }
+    if (overdue) {
+      next = overdue;
+    }
+    if (!next) {
+      break;
+    }
+
+    Request* request = next->queue.front();
+    next->queue.pop_front();
+    next->byte_tokens -= static_cast<double>(request->bytes);
+    next->op_tokens -= 1;
+    next->in_flight++;
+    in_flight_++;
+
+    uint64_t wait_us = static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::microseconds>(now - request->arrival).count());
+    next->stats.operations++;
+    next->stats.bytes += request->bytes;
+    next->stats.total_wait_us += wait_us;
+    next->stats.max_wait_us = std::max(next->stats.max_wait_us, wait_us);
+    if (now > request->deadline) {
+      next->stats.deadline_misses++;
+    }
+    request->granted = true;
+    request->cv.notify_one();
+  }
+}
+
+void IoScheduler::refill(ClassState& state, Clock::time_point now) const {
+  double elapsed = std::chrono::duration<double>(now - state.refilled).count();
+  state.refilled = now;
+  if (elapsed <= 0) {
+    return;
+  }
+  double byte_rate = static_cast<double>(state.budget.bytes_per_second);
+  double op_rate = static_cast<double>(state.budget.ops_per_second);
+  state.byte_tokens = std::min(byte_rate, state.byte_tokens + byte_rate * elapsed);
+  state.op_tokens = std::min(op_rate, state.op_tokens + op_rate * elapsed);
+}
+
+bool IoScheduler::can_admit(const ClassState& state) const {
+  size_t max_in_flight = state.budget.max_in_flight ? state.budget.max_in_flight : queue_depth_;
+  return state.in_flight < max_in_flight &&
+         (state.budget.bytes_per_second == 0 || state.byte_tokens > 0) &&
+         (state.budget.ops_per_second == 0 || state.op_tokens > 0);
+}
+
+IoScheduler::Clock::duration IoScheduler::time_until_refill() const {
+  Clock::duration shortest = Clock::duration::max();
+  for (const auto& state : classes_) {
+    size_t max_in_flight = state.budget.max_in_flight ? state.budget.max_in_flight : queue_depth_;
+    if (state.queue.empty() || state.in_flight >= max_in_flight) {
+      continue;
+    }
+
+    // Seconds until both balances are positive again
+    double seconds = 0;
+    if (state.budget.bytes_per_second && state.byte_tokens <= 0) {
+      seconds = std::max(seconds, -state.byte_tokens / static_cast<double>(state.budget.bytes_per_second));
+    }
+    if (state.budget.ops_per_second && state.op_tokens <= 0) {
+      seconds = std::max(seconds, -state.op_tokens / static_cast<double>(state.budget.ops_per_second));
+    }
+    if (!can_admit(state)) {
+      Clock::duration wait = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(seconds)) +
+                             std::chrono::microseconds(100);
+      shortest = std::min(shortest, wait);
+    }
+  }
+  return shortest;
+}
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,39 @@
+#include "store/key_locks.hpp"
+#include <functional>
+
+namespace dfs {
+namespace store {
+
+//==============================================
+// LOCK OPERATIONS
+//==============================================
+
+std::shared_lock<std::shared_mutex> KeyLockManager::lock_shared(const std::string& hash) const {
+  std::shared_lock<std::shared_mutex> lock(stripes_[stripe_of(hash)].mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    contended_++;
+    lock.lock();
+  }
+  return lock;
+}
+
+std::unique_lock<std::shared_mutex> KeyLockManager::lock_exclusive(const std::string& hash) const {
+  std::unique_lock<std::shared_mutex> lock(stripes_[stripe_of(hash)].mutex, std::try_to_lock);
+  if (!lock.owns_lock()) {
+    contended_++;
+    lock.lock();
+  }
+  return lock;
+}
+
+
+//==============================================
+// GETTERS
+//==============================================
+
+size_t KeyLockManager::stripe_of(const std::string& hash) const {
+  return std::hash<std::string>{}(hash) % STRIPE_COUNT;
+}
+
+} // namespace store
+} // namespace dfs
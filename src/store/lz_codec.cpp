@@ -0,0 +1,192 @@
+#include "store/lz_codec.hpp"
+#include <algorithm>
+#include <array>
+#include <cstring>
+
+namespace dfs {
+namespace store {
+
+namespace {
+
+// A match must leave this many literals at the end of the block, and none
+// starts within MATCH_FIND_LIMIT bytes of it
+constexpr size_t LAST_LITERALS = 5;
+constexpr size_t MATCH_FIND_LIMIT = 12;
+constexpr unsigned RUN_BITS = 4;
+constexpr size_t RUN_MASK = (1u << RUN_BITS) - 1;
+
+uint32_t read32(const char* p) {
+  uint32_t value;
+  std::memcpy(&value, p, sizeof(value));
+  return value;
+}
+
+uint32_t hash_sequence(uint32_t sequence) {
+  return (sequence * 2654435761u) >> (32 - LzCodec::HASH_BITS);
+}
+
+// Appends the extra bytes of a length that did not fit its token nibble
+bool write_length(size_t length, char*& out, const char* end) {
+  while (length >= 255) {
+    if (out == end) {
+      return false;
+    }
+    *out++ = static_cast<char>(255);
+    length -= 255;
+  }
+  if (out == end) {
+    return false;
+  }
+  *out++ = static_cast<char>(length);
+  return true;
+}
+
+// Reads the extra bytes of a length whose token nibble was saturated
+bool read_length(const unsigned char*& in, const unsigned char* end, size_t& length) {
+  unsigned char byte;
+  do {
+    if (in == end) {
+      return false;
+    }
+    byte = *in++;
+    length += byte;
+  } while (byte == 255);
+  return true;
+}
+
+// Writes one sequence, match_length zero for the final literals-only one
+bool write_sequence(const char* literals, size_t literal_length, size_t offset, size_t match_length,
+                    char*& out, const char* end) {
+  if (out == end) {
+    return false;
+  }
+  char* token = out++;
+  size_t match_code = match_length ? match_length - LzCodec::MIN_MATCH : 0;
+  *token = static_cast<char>((std::min(literal_length, RUN_MASK) << RUN_BITS) | std::min(match_code, RUN_MASK));
+
+  if (literal_length >= RUN_MASK && !write_length(literal_length - RUN_MASK, out, end)) {
+    return false;
+  }
+  if (static_cast<size_t>(end - out) < literal_length) {
+    return false;
+  }
+  std::memcpy(out, literals, literal_length);
+  out += literal_length;
+
+  if (match_length == 0) {
+    return true;
+  }
+  if (end - out < 2) {
+    return false;
+  }
+  *out++ = static_cast<char>(offset & 0xFF);
+  *out++ = static_cast<char>(offset >> 8);
+  return match_code < RUN_MASK || write_length(match_code - RUN_MASK, out, end);
+}
+
+} // namespace
+
+//==============================================
+// CODEC OPERATIONS
+//==============================================
+
+size_t LzCodec::max_compressed_size(size_t length) {
+  return length + length / 255 + 16;
+}
+
+size_t LzCodec::compress(const char* input, size_t length, char* output, size_t capacity) {
+  char* out = output;
+  const char* end = output + capacity;
+  size_t anchor = 0;
+
+  if (length > MATCH_FIND_LIMIT) {
+    // Positions of recent four-byte prefixes by hash, reused by the thread
+    thread_local std::array<uint32_t, 1u << HASH_BITS> table;
+    table.fill(0);
+
+    size_t limit = length - MATCH_FIND_LIMIT;
+    size_t position = 0;
+    while (position < limit) {
+      uint32_t sequence = read32(input + position);
+      uint32_t& slot = table[hash_sequence(sequence)];
+      size_t candidate = slot;
+      slot = static_cast<uint32_t>(position);
+
+      if (candidate >= position || position - candidate > MAX_OFFSET || read32(input + candidate) != sequence) {
+        // Step faster through data that keeps failing to match
+        position += 1 + ((position - anchor) >> 6);
+        continue;
+      }
+
+      size_t match_length = MIN_MATCH;
+      size_t max_length = length - LAST_LITERALS - position;
+      while (match_length < max_length && input[candidate + match_length] == input[position + match_length]) {
+        match_length++;
+      }
+      if (!write_sequence(input + anchor, position - anchor, position - candidate, match_length, out, end)) {
+        return 0;
+      }
+      position += match_length;
+      anchor = position;
+    }
+  }
+
+  if (!write_sequence(input + anchor, length - anchor, 0, 0, out, end)) {
+    return 0;
+  }
+  return static_cast<size_t>(out - output);
+}
+
+bool LzCodec::decompress(const char* input, size_t length, char* output, size_t expected) {
+  const unsigned char* in = reinterpret_cast<const unsigned char*>(input);
+  const unsigned char* in_end = in + length;
+  size_t produced = 0;
+
+  while (in < in_end) {
+    unsigned char token = *in++;
+    size_t literal_length = token >> RUN_BITS;
+    if (literal_length == RUN_MASK && !read_length(in, in_end, literal_length)) {
+      return false;
+    }
+    if (static_cast<size_t>(in_end - in) < literal_length || expected - produced < literal_length) {
+      return false;
+    }
+    std::memcpy(output + produced, in, literal_length);
+    in += literal_length;
+    produced += literal_length;
+
+    // The final sequence ends after its literals
+    if (in == in_end) {
+      break;
+    }
+    if (in_end - in < 2) {
+      return false;
+    }
+    size_t offset = in[0] | (static_cast<size_t>(in[1]) << 8);
+    in += 2;
+    size_t match_length = token & RUN_MASK;
+    if (match_length == RUN_MASK && !read_length(in, in_end, match_length)) {
+      return false;
+    }
+    match_length += MIN_MATCH;
+    if (offset == 0 || offset > produced || expected - produced < match_length) {
+      return false;
+    }
+
+    // Overlapping matches repeat the bytes just written, so copy forward one at a time
+    char* destination = output + produced;
+    const char* source = destination - offset;
+    if (offset >= match_length) {
+      std::memcpy(destination, source, match_length);
+    } else {
+      for (size_t i = 0; i < match_length; ++i) {
+        destination[i] = source[i];
+      }
+    }
+    produced += match_length;
+  }
+  return produced == expected;
+}
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,185 @@
+#include "store/object_cache.hpp"
+#include <algorithm>
+#include <functional>
+#include <boost/log/trivial.hpp>
+
+namespace dfs {
+namespace store {
+
+namespace {
+
+// Odd multipliers giving each sketch row an independent index
+constexpr uint64_t SKETCH_SEEDS[ObjectCache::SKETCH_DEPTH] = {
+  0x9E3779B97F4A7C15ull, 0xC2B2AE3D27D4EB4Full, 0x165667B19E3779F9ull, 0xD6E8FEB86659FD93ull
+};
+
+std::size_t sketch_index(std::size_t hash, std::size_t row) {
+  return static_cast<std::size_t>((static_cast<uint64_t>(hash) * SKETCH_SEEDS[row]) >> 32) %
+         ObjectCache::SKETCH_WIDTH;
+}
+
+} // namespace
+
+//==============================================
+// CONSTRUCTOR AND DESTRUCTOR
+//==============================================
+
+ObjectCache::ObjectCache(std::size_t capacity) : capacity_(capacity) {
+  for (auto& shard : shards_) {
+    shard.capacity = capacity / SHARD_COUNT;
+  }
+}
+
+
+//==============================================
+// CACHE OPERATIONS
+//==============================================
+
+ObjectViewPtr ObjectCache::lookup(const std::string& key, uint64_t& ticket) {
+  std::size_t hash = std::hash<std::string>{}(key);
+  Shard& shard = shard_for(hash);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  record_access(shard, hash);
+
+  auto it = shard.entries.find(key);
+  if (it == shard.entries.end()) {
+    ticket = shard.generation;
+    misses_++;
+    return nullptr;
+  }
+
+  shard.lru.splice(shard.lru.begin(), shard.lru, it->second);
+  hits_++;
+  return it->second->view;
+}
+
+void ObjectCache::insert(const std::string& key, ObjectViewPtr view, uint64_t ticket) {
+  std::size_t hash = std::hash<std::string>{}(key);
+  Shard& shard = shard_for(hash);
+  std::lock_guard<std::mutex> lock(shard.mutex);
+
+  // The object changed while it was being read, caching it would serve stale data
+  if (ticket != shard.generation || shard.capacity == 0 || view->size() > shard.capacity) {
+    return;
+  }
+
+  auto existing = shard.entries.find(key);
+  if (existing != shard.entries.end()) {
+    shard.bytes -= existing->second->view->size();
+    shard.lru.erase(existing->second);
+    shard.entries.erase(existing);
+  }
+
+  // Only admit an entry that would evict others if it is hotter than the LRU victim
+  if (shard.bytes + view->size() > shard.capacity && !shard.lru.empty() &&
+      estimate_frequency(shard, hash) <= estimate_frequency(shard, std::hash<std::string>{}(shard.lru.back().key))) {
+    rejections_++;
+    return;
+  }
+
+  shard.bytes += view->size();
+  shard.lru.push_front(Entry{key, std::move(view)});
+  shard.entries[key] = shard.lru.begin();
+  evict_to_capacity(shard);
+}
+
+void ObjectCache::invalidate(const std::string& key) {
+  Shard& shard = shard_for(std::hash<std::string>{}(key));
+  std::lock_guard<std::mutex> lock(shard.mutex);
+  shard.generation++;
+
+  auto it = shard.entries.find(key);
+  if (it != shard.entries.end()) {
+    shard.bytes -= it->second->view->size();
+    shard.lru.erase(it->second);
+    shard.entries.erase(it);
+  }
+}
+
+void ObjectCache::clear() {
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.generation++;
+    shard.lru.clear();
+    shard.entries.clear();
+    shard.bytes = 0;
+  }
+}
+
+
+//==============================================
+// GETTERS AND SETTERS
+//==============================================
+
+void ObjectCache::set_capacity(std::size_t capacity) {
+  capacity_ = capacity;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    shard.capacity = capacity / SHARD_COUNT;
+    evict_to_capacity(shard);
+  }
+  BOOST_LOG_TRIVIAL(info) << "Object cache: Capacity set to " << capacity << " bytes";
+}
+
+CacheStats ObjectCache::stats() const {
+  CacheStats stats;
+  stats.hits = hits_;
+  stats.misses = misses_;
+  stats.evictions = evictions_;
+  stats.rejections = rejections_;
+  for (auto& shard : shards_) {
+    std::lock_guard<std::mutex> lock(shard.mutex);
+    stats.entries += shard.entries.size();
+    stats.bytes += shard.bytes;
+  }
+  return stats;
+}
+
+
+//==============================================
+// UTILITY METHODS
+//==============================================
+
+ObjectCache::Shard& ObjectCache::shard_for(std::size_t hash) {
+  return shards_[hash % SHARD_COUNT];
+}
+
+void ObjectCache::record_access(Shard& shard, std::size_t hash) {
+  for (std::size_t row = 0; row < SKETCH_DEPTH; ++row) {
+    uint8_t& counter = shard.sketch[row][sketch_index(hash, row)];
+    if (counter < UINT8_MAX) {
+      counter++;
+    }
+  }
+
+  // Age the sketch so past popularity fades
+  if (++shard.sketch_accesses >= SKETCH_WIDTH * 8) {
+    for (auto& row : shard.sketch) {
+      for (auto& counter : row) {
+        counter >>= 1;
+      }
+    }
+    shard.sketch_accesses = 0;
+  }
+}
+
+uint8_t ObjectCache::estimate_frequency(const Shard& shard, std::size_t hash) {
+  uint8_t frequency = UINT8_MAX;
+  for (std::size_t row = 0; row < SKETCH_DEPTH; ++row) {
+    frequency = std::min(frequency, shard.sketch[row][sketch_index(hash, row)]);
+  }
+  return frequency;
+}
+
+void ObjectCache::evict_to_capacity(Shard& shard) {
+  while (shard.bytes > shard.capacity && !shard.lru.empty()) {
+    const Entry& victim = shard.lru.back();
+    shard.bytes -= victim.view->size();
+    shard.entries.erase(victim.key);
+    shard.lru.pop_back();
+    evictions_++;
+  }
+}
+
+} // namespace store
+} // namespace dfs
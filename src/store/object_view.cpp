@@ -0,0 +1,139 @@
+#include "store/object_view.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/log/trivial.hpp>
+#include "store/posix_io.hpp"
+#include "store/store.hpp"
+
+namespace dfs {
+namespace store {
+
+//==============================================
+// CONSTRUCTOR AND DESTRUCTOR
+//==============================================
+
+std::shared_ptr<const ObjectView> ObjectView::open(const std::filesystem::path& path,
+                                                   std::uintmax_t mmap_limit,
+                                                   IoScheduler* scheduler, IoClass io_class) {
+  std::shared_ptr<ObjectView> view(new ObjectView());
+
+  view->fd_ = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (view->fd_ < 0) {
+    BOOST_LOG_TRIVIAL(error) << "Object view: Failed to open file: " << path.string();
+    throw StoreError("Object view: Failed to open file: " + path.string());
+  }
+
+  struct stat st;
+  if (::fstat(view->fd_, &st) != 0) {
+    throw StoreError("Object view: Failed to stat file: " + path.string());
+  }
+  view->size_ = static_cast<std::uintmax_t>(st.st_size);
+
+  // Empty files cannot be mapped and need no backing at all
+  if (view->size_ == 0) {
+    view->contiguous_ = true;
+    return view;
+  }
+
+  if (view->size_ <= mmap_limit) {
+    void* addr = ::mmap(nullptr, view->size_, PROT_READ, MAP_SHARED, view->fd_, 0);
+    if (addr != MAP_FAILED) {
+      ::madvise(addr, view->size_, MADV_SEQUENTIAL);
+      view->data_ = static_cast<const char*>(addr);
+      view->mapped_ = true;
+      view->contiguous_ = true;
+      BOOST_LOG_TRIVIAL(debug) << "Object view: Mapped " << view->size_ << " bytes of " << path.string();
+      return view;
+    }
+    BOOST_LOG_TRIVIAL(warning) << "Object view: mmap failed, falling back to pread: " << std::strerror(errno);
+  }
+
+  BOOST_LOG_TRIVIAL(debug) << "Object view: Serving " << view->size_ << " bytes of "
+                           << path.string() << " through pread";
+  view->scheduler_ = scheduler;
+  view->io_class_ = io_class;
+  return view;
+}
+
+std::shared_ptr<const ObjectView> ObjectView::from_buffer(std::vector<char> buffer) {
+  std::shared_ptr<ObjectView> view(new ObjectView());
+  view->buffer_ = std::move(buffer);
+  view->data_ = view->buffer_.data();
+  view->size_ = view->buffer_.size();
+  view->contiguous_ = true;
+  return view;
+}
+
+ObjectView::~ObjectView() {
+  if (mapped_) {
+    ::munmap(const_cast<char*>(data_), size_);
+  }
+  if (fd_ >= 0) {
+    ::close(fd_);
+  }
+}
+
+
+//==============================================
+// READ OPERATIONS
+//==============================================
+
+std::size_t ObjectView::read(std::uintmax_t offset, char* output, std::size_t length) const {
+  if (offset >= size_) {
+    return 0;
+  }
+  length = static_cast<std::size_t>(std::min<std::uintmax_t>(length, size_ - offset));
+
+  if (contiguous_) {
+    std::memcpy(output, data_ + offset, length);
+    return length;
+  }
+
+  // Positioned reads leave the descriptor offset untouched so views stay shareable
+  IoScheduler::Grant grant;
+  if (scheduler_) {
+    grant = scheduler_->acquire(io_class_, length);
+  }
+  ssize_t n = io::pread_all(fd_, output, length, offset);
+  if (n < 0 || static_cast<std::size_t>(n) != length) {
+    throw StoreError("Object view: Failed to read object");
+  }
+  return length;
+}
+
+void ObjectView::write_to(std::ostream& output) const {
+  write_range_to(output, 0, size_);
+}
+
+std::uintmax_t ObjectView::write_range_to(std::ostream& output, std::uintmax_t offset,
+                                          std::uintmax_t length) const {
+  if (offset >= size_) {
+    return 0;
+  }
+  length = std::min(length, size_ - offset);
+
+  if (contiguous_) {
+    output.write(data_ + offset, static_cast<std::streamsize>(length));
+  } else {
+    // Only the requested range is read from disk
+    std::vector<char> buffer(static_cast<std::size_t>(std::min<std::uintmax_t>(READ_CHUNK_SIZE, length)));
+    for (std::uintmax_t end = offset + length; offset < end;) {
+      std::size_t n = read(offset, buffer.data(), static_cast<std::size_t>(std::min<std::uintmax_t>(buffer.size(), end - offset)));
+      output.write(buffer.data(), static_cast<std::streamsize>(n));
+      offset += n;
+    }
+  }
+
+  if (!output.good()) {
+    throw StoreError("Object view: Failed to write to output stream");
+  }
+  return length;
+}
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,117 @@
+#include "store/object_writer.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <unistd.h>
+#include <boost/log/trivial.hpp>
+#include "store/posix_io.hpp"
+#include "store/store.hpp"
+
+namespace dfs {
+namespace store {
+
+//==============================================
+// CONSTRUCTOR AND DESTRUCTOR
+//==============================================
+
+ObjectWriter::ObjectWriter(Store& store, const std::string& key, const std::string& hash,
+                           const std::filesystem::path& temp_path, int fd, uint64_t expected_size,
+                           uint32_t volume, ObjectOrigin origin)
+  : store_(store)
+  , key_(key)
+  , hash_(hash)
+  , temp_path_(temp_path)
+  , fd_(fd)
+  , expected_size_(expected_size)
+  , volume_(volume)
+  , origin_(origin) {
+  preallocate();
+}
+
+ObjectWriter::~ObjectWriter() {
+  if (!finished_) {
+    BOOST_LOG_TRIVIAL(warning) << "Object writer: Discarding uncommitted write for key: " << key_;
+    abort();
+  }
+}
+
+
+//==============================================
+// WRITE OPERATIONS
+//==============================================
+
+void ObjectWriter::append(const char* data, size_t length) {
+  check_open();
+  auto grant = store_.scheduler_.acquire(Store::io_class_for(origin_), length);
+  if (!io::write_all(fd_, data, length)) {
+    BOOST_LOG_TRIVIAL(error) << "Object writer: Failed to write data for key: " << key_;
+    throw StoreError("Object writer: Failed to write data");
+  }
+  checksum_ = Crc32c::update(checksum_, data, length);
+  written_ += length;
+}
+
+void ObjectWriter::append(std::istream& input) {
+  char buffer[65536];
+  while (input.read(buffer, sizeof(buffer)) || input.gcount() > 0) {
+    append(buffer, static_cast<size_t>(input.gcount()));
+  }
+  if (input.bad()) {
+    throw StoreError("Object writer: Failed to read input stream");
+  }
+}
+
+void ObjectWriter::commit() {
+  check_open();
+
+  // Release preallocated space past the data actually written
+  if (preallocated_ && written_ < expected_size_ && ::ftruncate(fd_, static_cast<off_t>(written_)) != 0) {
+    BOOST_LOG_TRIVIAL(warning) << "Object writer: Failed to trim preallocation for key: " << key_;
+  }
+
+  // The store takes ownership of the descriptor from here
+  int fd = fd_;
+  fd_ = -1;
+  finished_ = true;
+  store_.publish_written_object(key_, hash_, fd, temp_path_, written_, volume_, origin_, checksum_);
+  BOOST_LOG_TRIVIAL(info) << "Object writer: Committed " << written_ << " bytes with key: " << key_;
+}
+
+void ObjectWriter::abort() {
+  if (finished_) {
+    return;
+  }
+  finished_ = true;
+  ::close(fd_);
+  fd_ = -1;
+  std::error_code ec;
+  std::filesystem::remove(temp_path_, ec);
+}
+
+
+//==============================================
+// UTILITY METHODS
+//==============================================
+
+void ObjectWriter::preallocate() {
+  if (expected_size_ == 0) {
+    return;
+  }
+
+  // Keeping the size lets appends and the final file size stay exact
+  if (::fallocate(fd_, FALLOC_FL_KEEP_SIZE, 0, static_cast<off_t>(expected_size_)) == 0) {
+    preallocated_ = true;
+  } else {
+    BOOST_LOG_TRIVIAL(debug) << "Object writer: Preallocation unavailable for key: " << key_
+                             << ": " << std::strerror(errno);
+  }
+}
+
+void ObjectWriter::check_open() const {
+  if (finished_) {
+    throw StoreError("Object writer: Writer already closed for key: " + key_);
+  }
+}
+
+} // namespace store
+} // namespace dfs
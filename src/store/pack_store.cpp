@@ -0,0 +1,496 @@
+#include "store/pack_store.hpp"
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <sstream>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/log/trivial.hpp>
+#include "store/posix_io.hpp"
+#include "store/store.hpp"
+
+namespace dfs {
+namespace store {
+
+namespace {
+
+constexpr uint32_t RECORD_MAGIC = 0x4B504644;  // "DFPK"
+constexpr uint8_t RECORD_PUT = 1;
+constexpr uint8_t RECORD_TOMBSTONE = 2;
+// magic, op, hash length, reserved, data length
+constexpr size_t RECORD_HEADER_SIZE = 4 + 1 + 1 + 2 + 8;
+
+} // namespace
+
+//==============================================
+// CONSTRUCTOR AND DESTRUCTOR
+//==============================================
+
+PackStore::PackStore(const std::filesystem::path& directory, IoScheduler* scheduler)
+  : directory_(directory)
+  , scheduler_(scheduler) {
+  BOOST_LOG_TRIVIAL(info) << "Pack store: Opening segments in: " << directory_;
+  std::filesystem::create_directories(directory_);
+
+  // Replay segments oldest first so later records win
+  std::vector<uint32_t> ids;
+  for (const auto& entry : std::filesystem::directory_iterator(directory_)) {
+    if (entry.is_regular_file() && entry.path().extension() == SEGMENT_EXTENSION) {
+      ids.push_back(static_cast<uint32_t>(std::stoul(entry.path().stem().string())));
+    }
+  }
+  std::sort(ids.begin(), ids.end());
+
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  for (uint32_t id : ids) {
+    scan_segment(id);
+  }
+  if (segments_.empty()) {
+    start_segment(1);
+  } else {
+    active_segment_ = segments_.rbegin()->first;
+  }
+  lock.unlock();
+
+  compactor_ = std::thread(&PackStore::compaction_loop, this);
+  BOOST_LOG_TRIVIAL(info) << "Pack store: Loaded " << object_count() << " objects from "
+                          << segment_count() << " segments";
+}
+
+PackStore::~PackStore() {
+  {
+    std::lock_guard<std::mutex> lock(compactor_mutex_);
+    running_ = false;
+  }
+  compactor_cv_.notify_all();
+  if (compactor_.joinable()) {
+    compactor_.join();
+  }
+
+  for (auto& [id, segment] : segments_) {
+    if (id == active_segment_) {
+      ::fdatasync(segment.fd);
+    }
+    ::close(segment.fd);
+  }
+}
+
+
+//==============================================
+// PACK OPERATIONS
+//==============================================
+
+void PackStore::put(const std::string& hash, const char* data, size_t length) {
+  std::unique_lock<std::shared_mutex> lock(mutex_);
+  uint64_t offset = append_record(RECORD_PUT, hash, data, length);
+
+  // The new record supersedes any earlier object or tombstone for this hash
+  auto existing = locations_.find(hash);
+  if (existing != locations_.end()) {
+    mark_dead(existing->second.segment, record_size(hash.size(), existing->second.length));
+  }
+  tombstones_.erase(hash);
+  locations_[hash] = Location{active_segment_, offset, length};
+}
+
+std::vector<char> PackStore::read(const std::string& hash) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = locations_.find(hash);
+  if (it == locations_.end()) {
+    throw StoreError("Pack store: Object not found: " + hash);
+  }
+
+  // Segments are only closed under the exclusive lock, so the descriptor stays valid
+  const Location& location = it->second;
+  std::vector<char> data(location.length);
+  ssize_t n = io::pread_all(segments_.at(location.segment).fd, data.data(), data.size(), location.offset);
+  if (n < 0 || static_cast<uint64_t>(n) != location.length) {
+    BOOST_LOG_TRIVIAL(error) << "Pack store: Short read of " << hash << " in segment " << location.segment;
+    throw StoreError("Pack store: Failed to read object: " + hash);
+  }
+  return data;
+}
+
+bool PackStore::remove(const std::string& hash) {
+  bool request_compaction = false;
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    auto it = locations_.find(hash);
+    if (it == locations_.end()) {
+      return false;
+    }
+
+    append_record(RECORD_TOMBSTONE, hash, nullptr, 0);
+    Location location = it->second;
+    locations_.erase(it);
+    tombstones_[hash] = active_segment_;
+    mark_dead(location.segment, record_size(hash.size(), location.length));
+    mark_dead(active_segment_, record_size(hash.size(), 0));
+
+    const Segment& segment = segments_.at(location.segment);
+    request_compaction = segment.dead_bytes >= segment.size * COMPACT_DEAD_RATIO;
+  }
+
+  // Wake the compactor once a segment is mostly dead
+  if (request_compaction) {
+    std::lock_guard<std::mutex> lock(compactor_mutex_);
+    compact_requested_ = true;
+    compactor_cv_.notify_all();
+  }
+  return true;
+}
+
+bool PackStore::contains(const std::string& hash) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return locations_.count(hash) != 0;
+}
+
+std::optional<uint64_t> PackStore::size_of(const std::string& hash) const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  auto it = locations_.find(hash);
+  if (it == locations_.end()) {
+    return std::nullopt;
+  }
+  return it->second.length;
+}
+
+void PackStore::sync() {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  if (::fdatasync(segments_.at(active_segment_).fd) != 0) {
+    throw StoreError("Pack store: Failed to sync segment");
+  }
+}
+
+uint64_t PackStore::compact() {
+  // One compaction at a time, so segments being rewritten stay open
+  std::lock_guard<std::mutex> compact_lock(compact_mutex_);
+
+  // Admit the rewrite, charged with the live bytes it copies
+  IoScheduler::Grant grant;
+  if (scheduler_) {
+    uint64_t live_bytes = 0;
+    {
+      std::shared_lock<std::shared_mutex> lock(mutex_);
+      for (const auto& [id, segment] : segments_) {
+        if (needs_compaction(segment)) {
+          live_bytes += segment.size - std::min(segment.size, segment.dead_bytes);
+        }
+      }
+    }
+    grant = scheduler_->acquire(IoClass::Background, live_bytes);
+  }
+
+  std::vector<uint32_t> candidates;
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    for (const auto& [id, segment] : segments_) {
+      if (needs_compaction(segment)) {
+        candidates.push_back(id);
+      }
+    }
+    if (candidates.empty()) {
+      return 0;
+    }
+
+    // Seal the active segment if it is a candidate, so every candidate is immutable
+    if (std::find(candidates.begin(), candidates.end(), active_segment_) != candidates.end()) {
+      start_segment(active_segment_ + 1);
+    }
+  }
+
+  uint64_t reclaimed = 0;
+  for (uint32_t id : candidates) {
+    reclaimed += rewrite_segment(id);
+  }
+  BOOST_LOG_TRIVIAL(info) << "Pack store: Compacted " << candidates.size() << " segments, reclaimed "
+                          << reclaimed << " bytes";
+  return reclaimed;
+}
+
+
+//==============================================
+// GETTERS
+//==============================================
+
+size_t PackStore::object_count() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return locations_.size();
+}
+
+std::vector<std::string> PackStore::hashes() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  std::vector<std::string> result;
+  result.reserve(locations_.size());
+  for (const auto& [hash, location] : locations_) {
+    result.push_back(hash);
+  }
+  return result;
+}
+
+size_t PackStore::segment_count() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  return segments_.size();
+}
+
+uint64_t PackStore::dead_bytes() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  uint64_t total = 0;
+  for (const auto& [id, segment] : segments_) {
+    total += segment.dead_bytes;
+  }
+  return total;
+}
+
+uint64_t PackStore::disk_bytes() const {
+  std::shared_lock<std::shared_mutex> lock(mutex_);
+  uint64_t total = 0;
+  for (const auto& [id, segment] : segments_) {
+    total += segment.size;
+  }
+  return total;
+}
+
+
+//==============================================
+// SEGMENT MANAGEMENT
+//==============================================
+
+void PackStore::scan_segment(uint32_t id) {
+  std::filesystem::path path = get_segment_path(id);
+  Segment segment;
+  segment.fd = ::open(path.c_str(), O_RDWR | O_CLOEXEC);
+  struct stat st;
+  if (segment.fd < 0 || ::fstat(segment.fd, &st) != 0) {
+    throw StoreError("Pack store: Failed to open segment: " + path.string());
+  }
+  uint64_t file_size = static_cast<uint64_t>(st.st_size);
+  segments_[id] = segment;
+
+  uint64_t offset = 0;
+  char header[RECORD_HEADER_SIZE];
+  while (offset + RECORD_HEADER_SIZE <= file_size) {
+    if (io::pread_all(segment.fd, header, RECORD_HEADER_SIZE, offset) != static_cast<ssize_t>(RECORD_HEADER_SIZE)) {
+      break;
+    }
+    uint32_t magic;
+    uint64_t length;
+    std::memcpy(&magic, header, sizeof(magic));
+    uint8_t op = static_cast<uint8_t>(header[4]);
+    uint8_t hash_length = static_cast<uint8_t>(header[5]);
+    std::memcpy(&length, header + 8, sizeof(length));
+    if (magic != RECORD_MAGIC || (op != RECORD_PUT && op != RECORD_TOMBSTONE) ||
+        offset + record_size(hash_length, length) > file_size) {
+      break;
+    }
+
+    std::string hash(hash_length, '\0');
+    if (io::pread_all(segment.fd, hash.data(), hash_length, offset + RECORD_HEADER_SIZE) != hash_length) {
+      break;
+    }
+    segments_[id].size = offset + record_size(hash_length, length);
+
+    // Replay the record against what earlier records established
+    auto existing = locations_.find(hash);
+    if (existing != locations_.end()) {
+      mark_dead(existing->second.segment, record_size(hash_length, existing->second.length));
+      locations_.erase(existing);
+    }
+    tombstones_.erase(hash);
+    if (op == RECORD_PUT) {
+      locations_[hash] = Location{id, offset + RECORD_HEADER_SIZE + hash_length, length};
+    } else {
+      tombstones_[hash] = id;
+      mark_dead(id, record_size(hash_length, 0));
+    }
+    offset = segments_[id].size;
+  }
+
+  // A torn tail record is expected after a crash and cut off
+  if (offset < file_size) {
+    BOOST_LOG_TRIVIAL(warning) << "Pack store: Truncating incomplete record at offset " << offset
+                               << " of segment " << id;
+    if (::ftruncate(segment.fd, static_cast<off_t>(offset)) != 0) {
+      throw StoreError("Pack store: Failed to truncate segment: " + path.string());
+    }
+  }
+  ::lseek(segment.fd, 0, SEEK_END);
+}
+
+void PackStore::start_segment(uint32_t id) {
+  std::filesystem::path path = get_segment_path(id);
+  Segment segment;
+  segment.fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (segment.fd < 0) {
+    BOOST_LOG_TRIVIAL(error) << "Pack store: Failed to create segment: " << path.string();
+    throw StoreError("Pack store: Failed to create segment: " + path.string());
+  }
+
+  // Make the previous segment durable before appends move on
+  if (segments_.count(active_segment_) != 0) {
+    ::fdatasync(segments_.at(active_segment_).fd);
+  }
+  segments_[id] = segment;
+  active_segment_ = id;
+  BOOST_LOG_TRIVIAL(debug) << "Pack store: Started segment " << id;
+}
+
+uint64_t PackStore::append_record(uint8_t op, const std::string& hash, const char* data, size_t length) {
+  if (segments_.at(active_segment_).size >= SEGMENT_SIZE) {
+    start_segment(active_segment_ + 1);
+  }
+  Segment& segment = segments_.at(active_segment_);
+
+  std::string header(RECORD_HEADER_SIZE, '\0');
+  uint64_t data_length = length;
+  std::memcpy(header.data(), &RECORD_MAGIC, sizeof(RECORD_MAGIC));
+  header[4] = static_cast<char>(op);
+  header[5] = static_cast<char>(hash.size());
+  std::memcpy(header.data() + 8, &data_length, sizeof(data_length));
+  header += hash;
+
+  if (!io::write_all(segment.fd, header.data(), header.size()) ||
+      (length > 0 && !io::write_all(segment.fd, data, length))) {
+    // Drop the partial record so the segment stays parseable
+    if (::ftruncate(segment.fd, static_cast<off_t>(segment.size)) == 0) {
+      ::lseek(segment.fd, 0, SEEK_END);
+    }
+    throw StoreError("Pack store: Failed to append to segment " + std::to_string(active_segment_));
+  }
+
+  uint64_t data_offset = segment.size + header.size();
+  segment.size = data_offset + length;
+  return data_offset;
+}
+
+void PackStore::mark_dead(uint32_t segment, uint64_t record_size) {
+  auto it = segments_.find(segment);
+  if (it != segments_.end()) {
+    it->second.dead_bytes += record_size;
+  }
+}
+
+uint64_t PackStore::rewrite_segment(uint32_t id) {
+  // Sealed segments never change, so live records are listed under the
+  // shared lock and their bytes read without holding it
+  int fd;
+  uint64_t old_size;
+  std::vector<std::pair<std::string, Location>> live;
+  {
+    std::shared_lock<std::shared_mutex> lock(mutex_);
+    const Segment& segment = segments_.at(id);
+    fd = segment.fd;
+    old_size = segment.size;
+    for (const auto& [hash, location] : locations_) {
+      if (location.segment == id) {
+        live.emplace_back(hash, location);
+      }
+    }
+  }
+  std::sort(live.begin(), live.end(), [](const auto& a, const auto& b) { return a.second.offset < b.second.offset; });
+
+  uint64_t copied = 0;
+  std::vector<char> buffer;
+  for (size_t begin = 0; begin < live.size();) {
+    // Read a batch of records without the lock
+    size_t end = begin;
+    buffer.clear();
+    while (end < live.size() && (end == begin || buffer.size() + live[end].second.length <= COMPACT_BATCH_SIZE)) {
+      const Location& location = live[end].second;
+      size_t at = buffer.size();
+      buffer.resize(at + location.length);
+      ssize_t n = io::pread_all(fd, buffer.data() + at, location.length, location.offset);
+      if (n < 0 || static_cast<uint64_t>(n) != location.length) {
+        throw StoreError("Pack store: Failed to read segment " + std::to_string(id));
+      }
+      ++end;
+    }
+
+    // Move only records that were not replaced or removed while they were read
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    size_t at = 0;
+    for (size_t i = begin; i < end; ++i) {
+      const auto& [hash, old_location] = live[i];
+      auto it = locations_.find(hash);
+      if (it != locations_.end() && it->second.segment == id && it->second.offset == old_location.offset) {
+        uint64_t offset = append_record(RECORD_PUT, hash, buffer.data() + at, old_location.length);
+        it->second = Location{active_segment_, offset, old_location.length};
+        copied += record_size(hash.size(), old_location.length);
+      }
+      at += old_location.length;
+    }
+    begin = end;
+  }
+
+  // Tombstones only matter while an older segment may still hold the object
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    bool older_segments = segments_.begin()->first < id;
+    for (auto it = tombstones_.begin(); it != tombstones_.end();) {
+      if (it->second != id) {
+        ++it;
+      } else if (older_segments) {
+        append_record(RECORD_TOMBSTONE, it->first, nullptr, 0);
+        it->second = active_segment_;
+        mark_dead(active_segment_, record_size(it->first.size(), 0));
+        copied += record_size(it->first.size(), 0);
+        ++it;
+      } else {
+        it = tombstones_.erase(it);
+      }
+    }
+  }
+
+  // Copies must be durable before the only other copy is deleted
+  sync();
+  {
+    std::unique_lock<std::shared_mutex> lock(mutex_);
+    ::close(fd);
+    std::filesystem::remove(get_segment_path(id));
+    segments_.erase(id);
+  }
+
+  BOOST_LOG_TRIVIAL(debug) << "Pack store: Rewrote segment " << id << ", kept " << copied << " of "
+                           << old_size << " bytes";
+  return old_size - copied;
+}
+
+bool PackStore::needs_compaction(const Segment& segment) {
+  return segment.size > 0 && segment.dead_bytes >= segment.size * COMPACT_DEAD_RATIO;
+}
+
+std::filesystem::path PackStore::get_segment_path(uint32_t id) const {
+  std::ostringstream name;
+  name << std::setw(8) << std::setfill('0') << id << SEGMENT_EXTENSION;
+  return directory_ / name.str();
+}
+
+uint64_t PackStore::record_size(size_t hash_length, uint64_t data_length) {
+  return RECORD_HEADER_SIZE + hash_length + data_length;
+}
+
+
+//==============================================
+// BACKGROUND COMPACTION
+//==============================================
+
+void PackStore::compaction_loop() {
+  std::unique_lock<std::mutex> lock(compactor_mutex_);
+  while (running_) {
+    compactor_cv_.wait_for(lock, COMPACT_INTERVAL, [this] { return !running_ || compact_requested_; });
+    if (!running_) {
+      break;
+    }
+    compact_requested_ = false;
+    lock.unlock();
+    try {
+      compact();
+    } catch (const std::exception& e) {
+      BOOST_LOG_TRIVIAL(error) << "Pack store: Background compaction failed: " << e.what();
+    }
+    lock.lock();
+  }
+}
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,185 @@
+#include "store/reclaimer.hpp"
+#include <boost/log/trivial.hpp>
+#include "store/store.hpp"
+
+namespace dfs {
+namespace store {
+
+//==============================================
+// CONSTRUCTOR AND DESTRUCTOR
+//==============================================
+
+Reclaimer::Reclaimer(const std::filesystem::path& root, const std::filesystem::path& trash_directory,
+                     std::chrono::milliseconds interval, IoScheduler* scheduler)
+  : root_(root)
+  , trash_(trash_directory)
+  , interval_(interval)
+  , scheduler_(scheduler)
+  // Tombstone names start from the clock so they never collide with a previous run's
+  , next_id_(static_cast<uint64_t>(std::chrono::system_clock::now().time_since_epoch().count())) {
+  std::filesystem::create_directories(trash_);
+
+  // Finish deletions a previous run accepted but did not get to
+  for (const auto& entry : std::filesystem::directory_iterator(trash_)) {
+    queue_.push_back(Tombstone{entry.path(), {}});
+  }
+  if (!queue_.empty()) {
+    BOOST_LOG_TRIVIAL(info) << "Reclaimer: Resuming " << queue_.size() << " tombstones in " << trash_;
+  }
+
+  worker_ = std::thread(&Reclaimer::reclaim_loop, this);
+}
+
+Reclaimer::~Reclaimer() {
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    running_ = false;
+  }
+  cv_.notify_all();
+  drained_cv_.notify_all();
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+  BOOST_LOG_TRIVIAL(info) << "Reclaimer: Stopped after reclaiming " << reclaimed_ << " entries, "
+                          << queue_.size() << " left in trash";
+}
+
+
+//==============================================
+// RECLAIM OPERATIONS
+//==============================================
+
+bool Reclaimer::bury(const std::filesystem::path& path) {
+  std::filesystem::path tombstone = trash_ / std::to_string(next_id_++);
+
+  // One rename makes the entry disappear, the rest of the work is deferred
+  std::error_code ec;
+  std::filesystem::rename(path, tombstone, ec);
+  if (ec == std::errc::no_such_file_or_directory) {
+    return false;
+  }
+  if (ec) {
+    BOOST_LOG_TRIVIAL(error) << "Reclaimer: Failed to move " << path << " to trash: " << ec.message();
+    throw StoreError("Reclaimer: Failed to move to trash: " + path.string());
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    queue_.push_back(Tombstone{tombstone, path.parent_path()});
+  }
+  cv_.notify_all();
+  return true;
+}
+
+void Reclaimer::drain() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  drained_cv_.wait(lock, [this] { return !running_ || (queue_.empty() && in_progress_ == 0); });
+}
+
+
+//==============================================
+// GETTERS AND SETTERS
+//==============================================
+
+void Reclaimer::set_interval(std::chrono::milliseconds interval) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  interval_ = interval;
+}
+
+size_t Reclaimer::get_pending_count() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return queue_.size() + in_progress_;
+}
+
+
+//==============================================
+// RECLAIM PROCESSING
+//==============================================
+
+void Reclaimer::reclaim_loop() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  while (true) {
+    cv_.wait(lock, [this] { return !running_ || !queue_.empty(); });
+    if (!running_) {
+      break;
+    }
+
+    std::deque<Tombstone> batch;
+    while (!queue_.empty() && batch.size() < BATCH_SIZE) {
+      batch.push_back(std::move(queue_.front()));
+      queue_.pop_front();
+    }
+    in_progress_ = batch.size();
+
+    lock.unlock();
+    {
+      IoScheduler::Grant grant;
+      if (scheduler_) {
+        grant = scheduler_->acquire(IoClass::Background, 0);
+      }
+      reclaim_batch(batch);
+    }
+    lock.lock();
+
+    // Entries of trashed directories go first so the directory is empty when it comes up again
+    queue_.insert(queue_.begin(), std::make_move_iterator(batch.begin()), std::make_move_iterator(batch.end()));
+    in_progress_ = 0;
+
+    if (queue_.empty()) {
+      drained_cv_.notify_all();
+    } else {
+      // Throttle so background deletion leaves I/O for foreground requests
+      cv_.wait_for(lock, interval_, [this] { return !running_; });
+    }
+  }
+}
+
+void Reclaimer::reclaim_batch(std::deque<Tombstone>& batch) {
+  std::deque<Tombstone> requeue;
+  for (auto& tombstone : batch) {
+    std::error_code ec;
+    if (std::filesystem::is_directory(std::filesystem::symlink_status(tombstone.path, ec))) {
+      // Take apart a full directory at most one batch of entries at a time
+      std::deque<Tombstone> entries;
+      for (std::filesystem::directory_iterator it(tombstone.path, ec), end;
+           !ec && it != end && entries.size() < BATCH_SIZE; it.increment(ec)) {
+        entries.push_back(Tombstone{it->path(), {}});
+      }
+      if (!entries.empty()) {
+        requeue.insert(requeue.end(), std::make_move_iterator(entries.begin()),
+                       std::make_move_iterator(entries.end()));
+        requeue.push_back(std::move(tombstone));
+        continue;
+      }
+    }
+
+    std::filesystem::remove(tombstone.path, ec);
+    if (ec) {
+      BOOST_LOG_TRIVIAL(warning) << "Reclaimer: Failed to remove " << tombstone.path << ": " << ec.message();
+      continue;
+    }
+    reclaimed_++;
+    if (!tombstone.origin.empty()) {
+      prune(tombstone.origin);
+    }
+  }
+  batch = std::move(requeue);
+}
+
+void Reclaimer::prune(std::filesystem::path directory) const {
+  // Stop at the root, at anything outside it and at the first directory still in use
+  while (directory != root_) {
+    std::filesystem::path relative = directory.lexically_relative(root_);
+    if (relative.empty() || *relative.begin() == "..") {
+      break;
+    }
+    std::error_code ec;
+    if (!std::filesystem::remove(directory, ec) || ec) {
+      break;
+    }
+    directory = directory.parent_path();
+  }
+}
+
+} // namespace store
+} // namespace dfs
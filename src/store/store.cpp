@@ -1,7 +1,21 @@
 #include "store/store.hpp"
-#include <iomanip>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <unordered_map>
+#include <unordered_set>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/stat.h>
+#include <unistd.h>
 #include <boost/log/trivial.hpp>
 #include <thread>
+#include "store/posix_io.hpp"
 
 namespace dfs {
 namespace store {
@@ -11,112 +25,427 @@ namespace store {
 //==============================================
   
 // Initialize store with base directory path and ensure it exists
-Store::Store(const std::string& base_path) : base_path_(base_path) {
+Store::Store(const std::string& base_path, bool scan_on_open) : base_path_(base_path) {
   BOOST_LOG_TRIVIAL(info) << "Store: Initializing Store with base path: " << base_path;
   check_directory_exists(base_path_); // Create base directory if it doesn't exist
   BOOST_LOG_TRIVIAL(debug) << "Store: Store directory created/verified at: " << base_path;
+  index_ = std::make_unique<StoreIndex>(base_path_);
+  open_volumes();
+  open_pack_store();
+  if (scan_on_open) {
+    scan(true);
+  }
 }
 
-  
+Store::~Store() {
+  stop_scrubber();
+  stop_migrator();
+}
+
+
 //==============================================
-// CORE STORAGE OPERATIONS
+// CONFIGURATION
 //==============================================
 
-void Store::store(const std::string& key, std::istream& data) {
-  BOOST_LOG_TRIVIAL(info) << "Store: Storing data with key: " << key;
+void Store::set_durability(Durability mode) {
+  if (mode == Durability::GroupCommit && !committer_) {
+    committer_ = std::make_unique<GroupCommitter>(commit_window_);
+    // Packed data and index records for a batch become durable together with its files
+    committer_->set_flush_hook([this] {
+      if (pack_) {
+        pack_->sync();
+      }
+    });
+    committer_->set_sync_hook([this] { index_->sync(); });
+  } else if (mode == Durability::Atomic) {
+    committer_.reset();  // Drains pending commits
+  }
+  durability_ = mode;
+  BOOST_LOG_TRIVIAL(info) << "Store: Durability set to "
+                          << (mode == Durability::GroupCommit ? "group commit" : "atomic");
+}
 
-  if (!data.good()) {
-    BOOST_LOG_TRIVIAL(error) << "Store: Invalid input stream provided for key: " << key;
-    throw StoreError("Store: Invalid input stream");
+void Store::set_commit_window(std::chrono::microseconds window) {
+  commit_window_ = window;
+  if (committer_) {
+    committer_->set_window(window);
   }
+}
 
-  // Generate path from key and ensure directory structure exists
-  std::filesystem::path file_path = resolve_key_path(key);
-  check_directory_exists(file_path.parent_path());
-  BOOST_LOG_TRIVIAL(debug) << "Store: Calculated file path: " << file_path.string();
+void Store::set_packing(bool enabled) {
+  packing_enabled_ = enabled;
+  open_pack_store();
+  BOOST_LOG_TRIVIAL(info) << "Store: Packing " << (enabled ? "enabled" : "disabled");
+}
 
-  // Open output file in binary mode for cross-platform consistency
-  std::ofstream file(file_path, std::ios::binary);
-  if (!file) {
-    throw StoreError("Store: Failed to create file: " + file_path.string());
+void Store::set_capacity(uint64_t bytes) {
+  capacity_ = bytes;
+  BOOST_LOG_TRIVIAL(info) << "Store: Capacity set to " << bytes << " bytes";
+  enforce_capacity();
+}
+
+void Store::set_io_backend(IoBackend backend) {
+  if (backend == IoBackend::Uring && !ring_) {
+    if (!IoRing::is_supported()) {
+      BOOST_LOG_TRIVIAL(warning) << "Store: io_uring unavailable, keeping blocking I/O";
+      return;
+    }
+    ring_ = std::make_unique<IoRing>();
+  } else if (backend == IoBackend::Blocking) {
+    ring_.reset();  // Waits for in-flight operations
   }
+  BOOST_LOG_TRIVIAL(info) << "Store: I/O backend set to "
+                          << (ring_ ? "io_uring" : "blocking");
+}
 
-  size_t bytes_written = 0;
-  char buffer[4096];  
-
-  // Check for empty input stream
-  data.peek();
-  if (data.eof()) {
-    BOOST_LOG_TRIVIAL(debug) << "Store: Storing empty content for key: " << key;
-    file.close();
-    BOOST_LOG_TRIVIAL(info) << "Store: Successfully stored 0 bytes with key: " << key;
-    return;
+void Store::add_volume(const std::string& path, StorageTier tier) {
+  std::filesystem::path root = std::filesystem::absolute(path).lexically_normal();
+  BOOST_LOG_TRIVIAL(info) << "Store: Adding " << (tier == StorageTier::Slow ? "slow" : "fast")
+                          << " volume: " << root;
+  std::lock_guard<std::mutex> migration_lock(migration_mutex_);
+
+  if (volumes_.size() >= MAX_VOLUMES) {
+    throw StoreError("Store: Too many volumes");
+  }
+  check_directory_exists(root);
+  for (const auto& volume : volumes_) {
+    if (std::filesystem::equivalent(volume->root, root)) {
+      BOOST_LOG_TRIVIAL(error) << "Store: Directory is already a volume: " << root;
+      throw StoreError("Store: Directory is already a volume: " + root.string());
+    }
   }
 
-  // Read input stream in chunks and write to file
-  while (data.read(buffer, sizeof(buffer))) {
-    file.write(buffer, data.gcount());
-    bytes_written += data.gcount();
+  std::ofstream list(base_path_ / VOLUMES_FILENAME, std::ios::app);
+  if (!(list << root.string() << (tier == StorageTier::Slow ? SLOW_TIER_TAG : "") << '\n') || !list.flush()) {
+    throw StoreError("Store: Failed to record volume: " + root.string());
   }
+  attach_volume(root, tier);
+  refresh_free_space();
+}
 
-  // Handle final partial chunk if present
-  if (data.gcount() > 0) {
-    file.write(buffer, data.gcount());
-    bytes_written += data.gcount();
+std::vector<std::filesystem::path> Store::get_volumes() const {
+  std::vector<std::filesystem::path> roots;
+  for (const auto& volume : volumes_) {
+    roots.push_back(volume->root);
   }
+  return roots;
+}
 
-  file.close();
-  BOOST_LOG_TRIVIAL(info) << "Store: Successfully stored " << bytes_written << " bytes with key: " << key;
+void Store::set_tiering(const TieringPolicy& policy) {
+  if (policy.low_water < 0 || policy.low_water > 1) {
+    throw StoreError("Store: Tiering low water mark must be between 0 and 1");
+  }
+  {
+    std::lock_guard<std::mutex> lock(migrator_mutex_);
+    tiering_ = policy;
+  }
+  if (policy.fast_capacity == 0) {
+    stop_migrator();
+  } else if (!migrator_.joinable()) {
+    migrator_running_ = true;
+    migrator_ = std::thread(&Store::migrate_loop, this);
+  } else {
+    migrator_cv_.notify_all();
+  }
+  BOOST_LOG_TRIVIAL(info) << "Store: Fast tier capacity set to " << policy.fast_capacity << " bytes";
+}
+
+TieringPolicy Store::get_tiering() const {
+  std::lock_guard<std::mutex> lock(migrator_mutex_);
+  return tiering_;
+}
+
+std::optional<StorageTier> Store::get_tier(const std::string& key) const {
+  std::optional<IndexEntry> entry = index_->lookup(key);
+  if (!entry || entry->volume() >= volumes_.size()) {
+    return std::nullopt;
+  }
+  return volumes_[entry->volume()]->tier;
+}
+
+uint64_t Store::get_tier_bytes(StorageTier tier) const {
+  uint64_t bytes = 0;
+  index_->for_each([&](const std::string&, const IndexEntry& entry) {
+    if (entry.volume() < volumes_.size() && volumes_[entry.volume()]->tier == tier) {
+      bytes += entry.size;
+    }
+  });
+  return bytes;
+}
+
+CompressionStats Store::get_compression_stats() const {
+  CompressionStats stats;
+  stats.compressed_objects = compressed_objects_;
+  stats.incompressible_objects = incompressible_objects_;
+  stats.input_bytes = compressed_input_bytes_;
+  stats.stored_bytes = compressed_stored_bytes_;
+  return stats;
+}
+
+void Store::set_scrubbing(const ScrubPolicy& policy) {
+  {
+    std::lock_guard<std::mutex> lock(scrubber_mutex_);
+    scrubbing_ = policy;
+  }
+  if (policy.interval.count() == 0) {
+    stop_scrubber();
+  } else if (!scrubber_.joinable()) {
+    scrubber_running_ = true;
+    scrubber_ = std::thread(&Store::scrub_loop, this);
+  } else {
+    scrubber_cv_.notify_all();
+  }
+  BOOST_LOG_TRIVIAL(info) << "Store: Scrub interval set to " << policy.interval.count() << "ms at "
+                          << policy.bytes_per_second << " bytes/s";
+}
+
+ScrubPolicy Store::get_scrubbing() const {
+  std::lock_guard<std::mutex> lock(scrubber_mutex_);
+  return scrubbing_;
+}
+
+ScrubStats Store::get_scrub_stats() const {
+  ScrubStats stats;
+  stats.passes = scrub_passes_;
+  stats.objects = scrubbed_objects_;
+  stats.bytes = scrubbed_bytes_;
+  stats.corrupt = corruptions_;
+  return stats;
+}
+
+std::vector<std::string> Store::get_corrupt_objects() const {
+  std::lock_guard<std::mutex> lock(corrupt_mutex_);
+  return std::vector<std::string>(corrupt_keys_.begin(), corrupt_keys_.end());
+}
+
+std::optional<uint32_t> Store::get_checksum(const std::string& key) const {
+  std::optional<IndexEntry> entry = index_->lookup(key);
+  if (!entry || !(entry->flags & INDEX_FLAG_CHECKSUM)) {
+    return std::nullopt;
+  }
+  return entry->checksum;
+}
+
+  
+//==============================================
+// CORE STORAGE OPERATIONS
+//==============================================
+
+void Store::store(const std::string& key, std::istream& data, ObjectOrigin origin) {
+  store_object(key, data, origin);
+  access_.record(key);
+  enforce_capacity();
+}
+
+std::unique_ptr<ObjectWriter> Store::open_writer(const std::string& key, uint64_t expected_size,
+                                                 ObjectOrigin origin) {
+  BOOST_LOG_TRIVIAL(info) << "Store: Opening writer for key: " << key << " expecting " << expected_size << " bytes";
+
+  // The key is only locked when the writer commits, so a slow stream never blocks readers
+  std::optional<IndexEntry> previous = index_->lookup(key);
+  std::string hash = previous ? previous->hash : hash_key(key);
+  uint32_t volume = volume_for_write(hash, previous);
+  std::filesystem::path file_path = get_path_for_hash(hash, volume);
+  check_directory_exists(file_path.parent_path());
+  std::filesystem::path temp_path;
+  int fd = open_temp_file(file_path, temp_path);
+  return std::unique_ptr<ObjectWriter>(
+    new ObjectWriter(*this, key, hash, temp_path, fd, expected_size, volume, origin));
 }
 
 void Store::get(const std::string& key, std::stringstream& output) {
   BOOST_LOG_TRIVIAL(info) << "Store: Retrieving data for key: " << key;
 
-  std::filesystem::path file_path = resolve_key_path(key);
+  // Stream straight from the object's view instead of a bounce buffer
+  ObjectViewPtr view = open_view(key);
+  view->write_to(output);
+
+  BOOST_LOG_TRIVIAL(info) << "Store: Successfully streamed " << view->size() << " bytes for key: " << key;
+}
+
+ObjectViewPtr Store::open_view(const std::string& key) const {
+  // Hot objects are served from the cache without touching the filesystem.
+  // Accesses are recorded once the key is known to exist, so misses never
+  // create access statistics
+  uint64_t ticket = 0;
+  if (ObjectViewPtr cached = cache_.lookup(key, ticket)) {
+    BOOST_LOG_TRIVIAL(debug) << "Store: Serving cached view for key: " << key;
+    access_.record(key);
+    return cached;
+  }
+
+  ObjectViewPtr view;
+  {
+    auto lock = locks_.lock_shared(lookup_hash(key));
+    view = load_view(key);
+    // Cached views were verified when they were loaded
+    if (verify_reads_) {
+      if (std::optional<IndexEntry> entry = index_->lookup(key)) {
+        verify_view(key, *entry, *view);
+      }
+    }
+  }
+  access_.record(key);
+  consider_promotion(key);
+  cache_.insert(key, view, ticket);
+  return view;
+}
+
+ObjectViewPtr Store::load_view(const std::string& key, IoClass io_class) const {
+  BOOST_LOG_TRIVIAL(debug) << "Store: Opening view for key: " << key;
+
+  // Raw objects are mapped lazily and charged here, the grant ends when the
+  // view is returned. Unmapped views admit each of their reads instead
+  IndexEntry entry = lookup_entry(key);
+  bool unmapped = !(entry.flags & INDEX_LAYOUT_MASK) && entry.size > ObjectView::MMAP_LIMIT;
+  auto grant = scheduler_.acquire(io_class, unmapped ? 0 : entry.size);
+  if (entry.flags & INDEX_FLAG_PACKED) {
+    if (!pack_) {
+      throw StoreError("Store: Packed object without pack store: " + key);
+    }
+    return ObjectView::from_buffer(pack_->read(entry.hash));
+  }
+
+  std::filesystem::path file_path = get_path_for_hash(entry.hash, entry.volume());
   verify_file_exists(file_path);
 
-  // Handle empty file case
-  if (std::filesystem::file_size(file_path) == 0) {
-    BOOST_LOG_TRIVIAL(debug) << "Store: Retrieved empty content for key: " << key;
-    return;
+  if (entry.flags & INDEX_FLAG_COMPRESSED) {
+    return ObjectView::from_buffer(read_compressed(file_path));
   }
 
-  // Open file in binary mode to handle all file types correctly
-  std::ifstream file(file_path, std::ios::binary);
-  if (!file) {
-    throw StoreError("Store: Failed to open file: " + file_path.string());
+  // Chunked objects have no single backing file and are assembled in memory.
+  // Only the index flag marks a manifest, raw content may start with its magic
+  if (entry.flags & INDEX_FLAG_CHUNKED) {
+    std::stringstream content;
+    stream_chunks(open_manifest(file_path), content);
+    std::string assembled = content.str();
+    return ObjectView::from_buffer(std::vector<char>(assembled.begin(), assembled.end()));
   }
 
-  char buffer[4096];
-  size_t total_bytes = 0;
+  return ObjectView::open(file_path, ObjectView::MMAP_LIMIT, &scheduler_, io_class);
+}
+  
+std::uintmax_t Store::get_range(const std::string& key, std::uintmax_t offset, std::uintmax_t length,
+                               std::ostream& output) const {
+  BOOST_LOG_TRIVIAL(debug) << "Store: Reading range [" << offset << ", +" << length << ") of key: " << key;
+
+  // Cached objects are sliced in memory
+  uint64_t ticket = 0;
+  if (ObjectViewPtr cached = cache_.lookup(key, ticket)) {
+    access_.record(key);
+    check_range(key, offset, cached->size());
+    return cached->write_range_to(output, offset, length);
+  }
 
-  // Read file in chunks to handle large files efficiently
-  while (file.read(buffer, sizeof(buffer))) {
-    output.write(buffer, file.gcount());
-    total_bytes += file.gcount();
+  auto lock = locks_.lock_shared(lookup_hash(key));
+  IndexEntry entry = lookup_entry(key);
+  access_.record(key);
+  consider_promotion(key);
+  if (entry.flags & INDEX_FLAG_PACKED) {
+    ObjectViewPtr view = load_view(key);
+    cache_.insert(key, view, ticket);
+    check_range(key, offset, view->size());
+    return view->write_range_to(output, offset, length);
   }
 
-  // Handle final partial chunk if any
-  if (file.gcount() > 0) {
-    output.write(buffer, file.gcount());
-    total_bytes += file.gcount();
+  std::filesystem::path file_path = get_path_for_hash(entry.hash, entry.volume());
+  verify_file_exists(file_path);
+  auto grant = scheduler_.acquire(IoClass::Foreground, std::min(length, entry.size));
+
+  // Compressed objects only decompress the blocks overlapping the range
+  if (entry.flags & INDEX_FLAG_COMPRESSED) {
+    return read_compressed_range(key, file_path, offset, length, output);
   }
 
-  if (!output.good()) {
-    throw StoreError("Store: Failed to write to output stream");
+  // Chunked objects only read the chunks overlapping the range
+  if (entry.flags & INDEX_FLAG_CHUNKED) {
+    Manifest manifest = open_manifest(file_path);
+    check_range(key, offset, manifest.total_size);
+    std::uintmax_t written = 0;
+    std::uintmax_t chunk_start = 0;
+    for (const auto& [hash, chunk_length] : manifest.chunks) {
+      std::uintmax_t chunk_end = chunk_start + chunk_length;
+      if (chunk_end > offset && written < length) {
+        std::uintmax_t skip = offset + written - chunk_start;
+        written += ObjectView::open(get_chunk_path(hash), 0)->write_range_to(output, skip, length - written);
+      }
+      if (written >= length) {
+        break;
+      }
+      chunk_start = chunk_end;
+    }
+    return written;
   }
 
-  BOOST_LOG_TRIVIAL(info) << "Store: Successfully streamed " << total_bytes << " bytes for key: " << key;
+  // A zero mapping limit serves the view through pread of just this range
+  ObjectViewPtr view = ObjectView::open(file_path, 0);
+  check_range(key, offset, view->size());
+  return view->write_range_to(output, offset, length);
 }
-  
+
+std::future<ObjectViewPtr> Store::read_async(const std::string& key) const {
+  // Packed, chunked and compressed objects are assembled in memory, only raw files go through the ring.
+  // open_view records the access itself
+  std::optional<IndexEntry> entry = index_->lookup(key);
+  if (!ring_ || !entry || (entry->flags & INDEX_LAYOUT_MASK) != 0) {
+    std::promise<ObjectViewPtr> promise;
+    try {
+      promise.set_value(open_view(key));
+    } catch (...) {
+      promise.set_exception(std::current_exception());
+    }
+    return promise.get_future();
+  }
+  access_.record(key);
+  consider_promotion(key);
+
+  auto request = std::make_shared<AsyncRead>();
+  request->key = key;
+  std::future<ObjectViewPtr> result = request->promise.get_future();
+  if (ObjectViewPtr cached = cache_.lookup(key, request->ticket)) {
+    request->promise.set_value(cached);
+    return result;
+  }
+
+  // Objects are published by rename, so an open descriptor always sees a
+  // complete object and no key lock needs to span the callbacks. The grant
+  // is taken here since completion callbacks must never wait
+  request->grant = scheduler_.acquire(IoClass::Foreground, entry->size);
+  if (verify_reads_ && (entry->flags & INDEX_FLAG_CHECKSUM)) {
+    request->checksum = entry->checksum;
+  }
+  BOOST_LOG_TRIVIAL(debug) << "Store: Submitting async read for key: " << key;
+  ring_->open(get_path_for_hash(entry->hash, entry->volume()).string(), O_RDONLY | O_CLOEXEC, 0, [this, request](int fd) {
+    if (fd < 0) {
+      fail_async_read(request, "Store: File not found: " + request->key);
+      return;
+    }
+    request->fd = fd;
+    struct stat st;
+    if (::fstat(fd, &st) != 0) {
+      fail_async_read(request, "Store: Failed to stat file: " + request->key);
+      return;
+    }
+    request->buffer.resize(static_cast<size_t>(st.st_size));
+    continue_async_read(request);
+  });
+  return result;
+}
+
 void Store::remove(const std::string& key) {
   BOOST_LOG_TRIVIAL(info) << "Store: Removing file with key: " << key;
 
-  // Convert the key to its corresponding file path using content-addressing
-  std::filesystem::path file_path = resolve_key_path(key);
-
-  // Attempt to remove the file, std::filesystem::remove returns true if successful
-  if (std::filesystem::remove(file_path)) {
+  // Remove the object from whichever layout holds it
+  std::string hash = lookup_hash(key);
+  auto lock = locks_.lock_exclusive(hash);
+  std::optional<IndexEntry> entry = index_->lookup(key);
+  if (!entry && !index_->is_authoritative()) {
+    entry = learn_object(key);
+  }
+  if (entry && remove_object(hash, entry->flags)) {
+    index_->erase(key);
+    cache_.invalidate(key);
+    access_.forget(key);
     BOOST_LOG_TRIVIAL(info) << "Store: Successfully removed file with key: " << key;
   } else {
     BOOST_LOG_TRIVIAL(error) << "Store: Failed to remove file with key: " << key;
@@ -126,36 +455,354 @@ void Store::remove(const std::string& key) {
 
 void Store::clear() {
   BOOST_LOG_TRIVIAL(info) << "Store: Clearing entire store at: " << base_path_;
-  std::filesystem::remove_all(base_path_);
-  check_directory_exists(base_path_);
+  std::lock_guard<std::mutex> migration_lock(migration_mutex_);
+  pack_.reset();
+  index_->clear();
+
+  // Move everything but the trash, the fresh journal and the volume list
+  // aside, each volume's reclaimer deletes it
+  for (uint32_t volume = 0; volume < volumes_.size(); ++volume) {
+    check_directory_exists(volumes_[volume]->root);
+    for (const auto& entry : std::filesystem::directory_iterator(volumes_[volume]->root)) {
+      std::string name = entry.path().filename().string();
+      if (name != TRASH_DIRECTORY && name != StoreIndex::JOURNAL_FILENAME && name != VOLUMES_FILENAME) {
+        bury(entry.path(), volume);
+      }
+    }
+  }
+  cache_.clear();
+  access_.clear();
+  open_pack_store();
   BOOST_LOG_TRIVIAL(info) << "Store: Store cleared successfully";
 }
 
   
+//==============================================
+// MAINTENANCE
+//==============================================
+
+std::uintmax_t Store::collect_garbage() {
+  BOOST_LOG_TRIVIAL(info) << "Store: Collecting unreferenced chunks in: " << base_path_;
+
+  std::unordered_set<std::string> referenced;
+  // Chunk files with the hash rebuilt from their fan-out path
+  std::vector<std::pair<std::filesystem::path, std::string>> chunk_files;
+
+  // Let pending deletions finish so the walk does not race directory pruning
+  flush_deletes();
+
+  // Chunked writes that reuse an existing chunk wait until the sweep is done,
+  // their manifests are not published yet and cannot be marked
+  std::unique_lock<std::shared_mutex> chunk_lock(chunk_mutex_);
+
+  // Object files of indexed keys, the flags tell manifests from raw content
+  std::unordered_map<std::string, uint32_t> indexed;
+  index_->for_each([&indexed](const std::string&, const IndexEntry& entry) {
+    if (!(entry.flags & INDEX_FLAG_PACKED)) {
+      indexed[entry.hash] |= entry.flags;
+    }
+  });
+
+  // Mark every chunk referenced by a manifest on any volume, deleted manifests
+  // in the trash no longer count
+  for (const auto& volume : volumes_) {
+    for (auto it = std::filesystem::recursive_directory_iterator(volume->root);
+         it != std::filesystem::recursive_directory_iterator(); ++it) {
+      const auto& entry = *it;
+      if (it.depth() == 0 && entry.path().filename() == TRASH_DIRECTORY) {
+        it.disable_recursion_pending();
+        continue;
+      }
+      if (!entry.is_regular_file() || entry.path().filename().string().find(TEMP_SUFFIX) != std::string::npos) {
+        continue;
+      }
+      if (entry.path().extension() == PackStore::SEGMENT_EXTENSION) {
+        continue;
+      }
+      std::string hash;
+      for (const auto& part : std::filesystem::relative(entry.path(), volume->root)) {
+        hash += part.stem().string();
+      }
+      if (entry.path().extension() == CHUNK_EXTENSION) {
+        chunk_files.emplace_back(entry.path(), std::move(hash));
+        continue;
+      }
+
+      // Unindexed files may be manifests written before the index existed.
+      // Raw content that merely looks like one only keeps chunks alive
+      Manifest manifest;
+      auto known = indexed.find(hash);
+      if (known != indexed.end()) {
+        if (!(known->second & INDEX_FLAG_CHUNKED)) {
+          continue;
+        }
+        manifest = open_manifest(entry.path());
+      } else {
+        std::ifstream file(entry.path(), std::ios::binary);
+        try {
+          if (!file || !read_manifest(file, manifest)) {
+            continue;
+          }
+        } catch (const StoreError&) {
+          continue;
+        }
+      }
+      for (const auto& chunk : manifest.chunks) {
+        referenced.insert(chunk.first);
+      }
+    }
+  }
+
+  // Sweep chunks whose rebuilt hash is not referenced
+  std::uintmax_t reclaimed = 0;
+  for (const auto& [chunk_path, hash] : chunk_files) {
+    if (referenced.count(hash) == 0) {
+      reclaimed += std::filesystem::file_size(chunk_path);
+      std::filesystem::remove(chunk_path);
+    }
+  }
+
+  BOOST_LOG_TRIVIAL(info) << "Store: Reclaimed " << reclaimed << " bytes of unreferenced chunks";
+  return reclaimed;
+}
+
+void Store::flush_deletes() {
+  for (auto& volume : volumes_) {
+    volume->reclaimer->drain();
+  }
+}
+
+size_t Store::get_pending_deletes() const {
+  size_t pending = 0;
+  for (const auto& volume : volumes_) {
+    pending += volume->reclaimer->get_pending_count();
+  }
+  return pending;
+}
+
+void Store::set_reclaim_interval(std::chrono::milliseconds interval) {
+  for (auto& volume : volumes_) {
+    volume->reclaimer->set_interval(interval);
+  }
+}
+
+size_t Store::migrate_cold_objects() {
+  std::lock_guard<std::mutex> migration_lock(migration_mutex_);
+  TieringPolicy policy = get_tiering();
+  bool has_slow = std::any_of(volumes_.begin(), volumes_.end(), [](const auto& volume) {
+    return volume->tier == StorageTier::Slow;
+  });
+  if (policy.fast_capacity == 0 || !has_slow) {
+    return 0;
+  }
+  size_t promoted = promote_hot_objects(policy);
+
+  // Only objects with a file of their own can move, so chunk manifests and
+  // packed objects neither count against the budget nor get ranked. The
+  // per-volume totals of the index answer the common case without a walk
+  uint64_t fast_bytes = fast_file_bytes();
+  if (fast_bytes <= policy.fast_capacity) {
+    return 0;
+  }
+
+  // Consume the ranking of an earlier walk, walking the index again only
+  // once per pass and only after new objects may have become old enough
+  uint64_t target = static_cast<uint64_t>(policy.fast_capacity * policy.low_water);
+  size_t demoted = 0;
+  bool ranked = false;
+  while (fast_bytes > target) {
+    if (demotion_queue_.empty()) {
+      if (ranked || std::chrono::system_clock::now() < next_ranking_) {
+        break;
+      }
+      rank_demotion_candidates(policy);
+      ranked = true;
+      continue;
+    }
+    DemotionCandidate candidate = std::move(demotion_queue_.front());
+    demotion_queue_.pop_front();
+    // Objects read since they were ranked are no longer cold
+    if (access_.score(access_.lookup(candidate.key)) > candidate.score) {
+      continue;
+    }
+    if (move_object(candidate.key, candidate.hash, StorageTier::Slow)) {
+      demoted++;
+      fast_bytes = fast_file_bytes();
+    }
+  }
+
+  if (fast_bytes > policy.fast_capacity) {
+    BOOST_LOG_TRIVIAL(warning) << "Store: Fast tier over capacity with " << fast_bytes << " of "
+                               << policy.fast_capacity << " movable bytes, the rest is too new";
+  }
+  BOOST_LOG_TRIVIAL(info) << "Store: Demoted " << demoted << " and promoted " << promoted
+                          << " objects, fast tier holds " << fast_bytes << " movable bytes";
+  return demoted;
+}
+
+size_t Store::scrub_objects() {
+  ScrubPolicy policy = get_scrubbing();
+  std::vector<std::string> keys;
+  index_->for_each([&keys](const std::string& key, const IndexEntry& entry) {
+    if (entry.flags & INDEX_FLAG_CHECKSUM) {
+      keys.push_back(key);
+    }
+  });
+
+  auto start = std::chrono::steady_clock::now();
+  uint64_t bytes = 0;
+  size_t corrupt = 0;
+  for (const auto& key : keys) {
+    // Pace the pass to the policy's average rate, waking early on shutdown
+    if (policy.bytes_per_second) {
+      auto due = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+        std::chrono::duration<double>(static_cast<double>(bytes) / static_cast<double>(policy.bytes_per_second)));
+      std::unique_lock<std::mutex> lock(scrubber_mutex_);
+      if (scrubber_cv_.wait_until(lock, due, [this] { return scrub_cancelled_; })) {
+        break;
+      }
+    }
+
+    // The migration lock only orders the re-check, the read runs under the key lock
+    std::optional<IndexEntry> entry;
+    {
+      std::lock_guard<std::mutex> migration_lock(migration_mutex_);
+      entry = index_->lookup(key);
+    }
+    if (!entry) {
+      continue;
+    }
+    if (!scrub_object(key)) {
+      corrupt++;
+    }
+    bytes += entry->size;
+  }
+
+  scrub_passes_++;
+  BOOST_LOG_TRIVIAL(info) << "Store: Scrubbed " << keys.size() << " objects, " << bytes << " bytes, "
+                          << corrupt << " corrupt";
+  return corrupt;
+}
+
+ScanReport Store::scan(bool repair) {
+  std::vector<std::filesystem::path> roots = get_volumes();
+  StoreScanner scanner(roots, TEMP_SUFFIX, CHUNK_EXTENSION, {PACK_DIRECTORY, TRASH_DIRECTORY});
+  ScanReport report = scanner.scan();
+
+  // Temp files of live processes may still be in the middle of a write
+  for (const auto& path : report.temp_files) {
+    if (is_orphaned_temp_file(path)) {
+      report.orphaned_temp_files.push_back(path);
+    }
+  }
+
+  // Index entries must point at an object on their volume, and every object should have an entry
+  std::vector<std::unordered_set<std::string>> on_disk(roots.size());
+  for (size_t i = 0; i < report.object_hashes.size(); ++i) {
+    on_disk[report.object_volumes[i]].insert(report.object_hashes[i]);
+  }
+  std::vector<std::unordered_set<std::string>> referenced(roots.size());
+  std::unordered_set<std::string> referenced_packed;
+  std::vector<std::string> dangling;
+  index_->for_each([&](const std::string& key, const IndexEntry& entry) {
+    bool exists;
+    if (entry.flags & INDEX_FLAG_PACKED) {
+      referenced_packed.insert(entry.hash);
+      exists = pack_ && pack_->contains(entry.hash);
+    } else {
+      uint32_t volume = entry.volume();
+      exists = volume < roots.size() && on_disk[volume].count(entry.hash) > 0;
+      if (exists) {
+        referenced[volume].insert(entry.hash);
+      }
+    }
+    if (!exists) {
+      dangling.push_back(key);
+    }
+  });
+  report.dangling_entries = dangling.size();
+  for (size_t i = 0; i < report.object_hashes.size(); ++i) {
+    report.unindexed_objects += referenced[report.object_volumes[i]].count(report.object_hashes[i]) == 0;
+  }
+  if (pack_) {
+    for (const auto& hash : pack_->hashes()) {
+      report.unindexed_objects += referenced_packed.count(hash) == 0;
+    }
+  }
+
+  if (repair) {
+    std::error_code ec;
+    for (const auto& path : report.orphaned_temp_files) {
+      std::filesystem::remove(path, ec);
+    }
+    // Parents emptied by the removal are removed as well, up to their volume root
+    for (auto current : report.empty_directories) {
+      while (std::find(roots.begin(), roots.end(), current) == roots.end() &&
+             std::filesystem::is_empty(current, ec) && !ec) {
+        std::filesystem::remove(current, ec);
+        current = current.parent_path();
+      }
+    }
+    for (const auto& key : dangling) {
+      index_->erase(key);
+    }
+    // Unindexed objects are found again through the filesystem fallback
+    index_->set_authoritative(report.unindexed_objects == 0);
+  }
+
+  BOOST_LOG_TRIVIAL(info) << "Store: Scanned " << report.objects << " objects and " << report.chunks
+                          << " chunks in " << report.seconds << "s (" << static_cast<uint64_t>(report.objects_per_second())
+                          << " objects/s), " << report.orphaned_temp_files.size() << " orphaned temp files, "
+                          << report.empty_directories.size() << " empty directories, " << report.dangling_entries
+                          << " dangling and " << report.unindexed_objects << " unindexed objects"
+                          << (repair ? ", repaired" : "");
+  return report;
+}
+
+std::uintmax_t Store::compact_packs() {
+  return pack_ ? pack_->compact() : 0;
+}
+
+  
 //==============================================
 // QUERY OPERATIONS
 //==============================================
 
 bool Store::has(const std::string& key) const {
   BOOST_LOG_TRIVIAL(debug) << "Store: Checking existence of key: " << key;
-  
-  std::filesystem::path file_path = resolve_key_path(key);
-  bool exists = std::filesystem::exists(file_path);
-  
-  BOOST_LOG_TRIVIAL(debug) << "Store: Key " << key << (exists ? " exists" : " not found") 
-                           << " at path: " << file_path.string();
+
+  // Index hits and authoritative misses are answered without hashing or syscalls
+  bool exists = index_->lookup(key).has_value();
+  if (!exists && !index_->is_authoritative()) {
+    exists = learn_object(key).has_value();
+  }
+  if (exists) {
+    access_.record(key);
+  }
+
+  BOOST_LOG_TRIVIAL(debug) << "Store: Key " << key << (exists ? " exists" : " not found");
   return exists;
 }
 
 std::uintmax_t Store::get_file_size(const std::string& key) const {
   BOOST_LOG_TRIVIAL(debug) << "Store: Getting file size for key: " << key;
 
-  std::filesystem::path file_path = resolve_key_path(key);
-  verify_file_exists(file_path);
+  std::optional<IndexEntry> entry = index_->lookup(key);
+  if (!entry && !index_->is_authoritative()) {
+    entry = learn_object(key);
+  }
+  if (!entry) {
+    BOOST_LOG_TRIVIAL(error) << "Store: File not found for key: " << key;
+    throw StoreError("Store: File not found");
+  }
+
+  BOOST_LOG_TRIVIAL(debug) << "Store: File size for key " << key << ": " << entry->size << " bytes";
+  return entry->size;
+}
 
-  std::uintmax_t size = std::filesystem::file_size(file_path);
-  BOOST_LOG_TRIVIAL(debug) << "Store: File size for key " << key << ": " << size << " bytes";
-  return size;
+ListPage Store::list(const std::string& prefix, const std::string& cursor, size_t limit) const {
+  BOOST_LOG_TRIVIAL(debug) << "Store: Listing up to " << limit << " names with prefix: " << prefix;
+  return index_->list(prefix, cursor, limit);
 }
 
   
@@ -166,22 +813,12 @@ std::uintmax_t Store::get_file_size(const std::string& key) const {
 bool Store::read_file(const std::string& key, size_t lines_per_page) const {
   BOOST_LOG_TRIVIAL(info) << "Store: Reading file with key: " << key;
   try {
-    std::filesystem::path file_path = resolve_key_path(key);
-
-    if (!std::filesystem::exists(file_path)) {
-      BOOST_LOG_TRIVIAL(error) << "Store: File not found: " << file_path.string();
-      return false;
-    }
-    
-    // Open file for reading
-    std::ifstream file(file_path);
-    if (!file) {
-      BOOST_LOG_TRIVIAL(error) << "Store: Failed to open file: " << file_path.string();
-      return false;
-    }
+    // Views cover raw, chunked and packed objects alike
+    std::stringstream content;
+    open_view(key)->write_to(content);
 
     // Delegate to display function for paginated output
-    return display_file_contents(file, key, lines_per_page);
+    return display_file_contents(content, key, lines_per_page);
   }
   catch (const std::exception& e) {
     BOOST_LOG_TRIVIAL(error) << "Store: Exception while reading file: " << e.what();
@@ -189,7 +826,7 @@ bool Store::read_file(const std::string& key, size_t lines_per_page) const {
   }
 }
 
-bool Store::display_file_contents(std::ifstream& file, const std::string& key, 
+bool Store::display_file_contents(std::istream& file, const std::string& key, 
                 size_t lines_per_page) const {
   std::string line;
   size_t current_line = 0;
@@ -243,13 +880,16 @@ void Store::print_working_dir() const {
                 << " " << entry.path().filename() << std::endl;
     }
 
-    // Display files in the DFS storage directory
+    // Display stored filenames page by page from the catalog
     std::cout << "\nDFS Store:" << std::endl;
-    for (const auto& entry : std::filesystem::directory_iterator(base_path_)) {
-      // Format each entry with directory/file indicator and filename
-      std::cout << "* " << (entry.is_directory() ? "[DIR] " : "[FILE]") 
-                << " " << entry.path().filename() << std::endl;
-  }
+    std::string cursor;
+    do {
+      ListPage page = list("", cursor);
+      for (const auto& entry : page.entries) {
+        std::cout << "* [FILE]  " << entry.name << " (" << entry.size << " bytes)" << std::endl;
+      }
+      cursor = std::move(page.next_cursor);
+    } while (!cursor.empty());
 }
 
 void Store::move_dir(const std::string& path) {
@@ -276,8 +916,17 @@ void Store::move_dir(const std::string& path) {
       throw StoreError("Store: DFS path is not a directory");
     }
 
-    // Update the base path for the store
+    // Update the base path for the store and load the index kept there
+    std::lock_guard<std::mutex> migration_lock(migration_mutex_);
+    pack_.reset();
+    index_.reset();
+    volumes_.clear();  // Unfinished deletions resume when the old directory is opened again
     base_path_ = new_path;
+    index_ = std::make_unique<StoreIndex>(base_path_);
+    open_volumes();
+    cache_.clear();
+    access_.clear();
+    open_pack_store();
     BOOST_LOG_TRIVIAL(info) << "Store: Successfully changed DFS directory to: " << base_path_;
 
   } catch (const std::filesystem::filesystem_error& e) {
@@ -290,32 +939,39 @@ void Store::move_dir(const std::string& path) {
 void Store::delete_file(const std::string& filename) {
   BOOST_LOG_TRIVIAL(info) << "Store: Deleting file: " << filename;
 
-  std::string hash = hash_key(filename);
-  std::filesystem::path file_path = get_path_for_hash(hash);
-
-  if (!std::filesystem::exists(file_path)) {
-    BOOST_LOG_TRIVIAL(error) << "Store: File not found: " << file_path.string();
-    throw StoreError("Store: File not found");
+  std::string hash = lookup_hash(filename);
+  auto lock = locks_.lock_exclusive(hash);
+  std::optional<IndexEntry> entry = index_->lookup(filename);
+  if (!entry && !index_->is_authoritative()) {
+    entry = learn_object(filename);
   }
 
-  // Delete the file
-  if (!std::filesystem::remove(file_path)) {
-    BOOST_LOG_TRIVIAL(error) << "Store: Failed to delete file: " << filename;
-    throw StoreError("Store: Failed to delete file");
+  // Packed objects have no file or directories to clean up
+  if (entry && (entry->flags & INDEX_FLAG_PACKED)) {
+    if (!remove_object(hash, entry->flags)) {
+      BOOST_LOG_TRIVIAL(error) << "Store: Packed object not found: " << filename;
+      throw StoreError("Store: File not found");
+    }
+    index_->erase(filename);
+    cache_.invalidate(filename);
+    access_.forget(filename);
+    BOOST_LOG_TRIVIAL(info) << "Store: Successfully deleted packed file: " << filename;
+    return;
   }
 
-  // Clean up empty parent directories up to base_path_
-  auto current = file_path.parent_path();
-  while (current != base_path_) {
-    if (std::filesystem::is_empty(current)) {
-      std::filesystem::remove(current);
-      current = current.parent_path();
-    } else {
-      break;
-    }
+  uint32_t volume = entry ? entry->volume() : find_volume(hash).value_or(0);
+  std::filesystem::path file_path = get_path_for_hash(hash, volume);
+
+  // Tombstone the file, the reclaimer unlinks it and prunes emptied directories
+  if (!bury(file_path, volume)) {
+    BOOST_LOG_TRIVIAL(error) << "Store: File not found: " << file_path.string();
+    throw StoreError("Store: File not found");
   }
+  index_->erase(filename);
+  cache_.invalidate(filename);
+  access_.forget(filename);
 
-  BOOST_LOG_TRIVIAL(info) << "Store: Successfully deleted file and cleaned up directories: " << filename;
+  BOOST_LOG_TRIVIAL(info) << "Store: Successfully deleted file: " << filename;
 }
 
   
@@ -325,51 +981,55 @@ void Store::delete_file(const std::string& filename) {
 
 std::string Store::hash_key(const std::string& key) const {
   BOOST_LOG_TRIVIAL(debug) << "Store: Generating hash for key: " << key;
+  return hash_bytes(key.data(), key.length());
+}
 
+std::string Store::hash_bytes(const void* data, size_t length) const {
+  static constexpr char HEX_DIGITS[] = "0123456789abcdef";
   unsigned char hash[EVP_MAX_MD_SIZE];
   unsigned int hash_len;
 
-  // Create a new message digest context for the hashing operation
-  EVP_MD_CTX* ctx = EVP_MD_CTX_new();
+  // Reuse one digest context per thread instead of allocating one per hash
+  struct DigestContextDeleter {
+    void operator()(EVP_MD_CTX* ctx) const { EVP_MD_CTX_free(ctx); }
+  };
+  thread_local std::unique_ptr<EVP_MD_CTX, DigestContextDeleter> ctx(EVP_MD_CTX_new());
   if (!ctx) {
     throw StoreError("Store: Failed to create hash context");
   }
 
   // Initialize the context with SHA-256 algorithm
-  if (!EVP_DigestInit_ex(ctx, EVP_sha256(), nullptr)) {
-    EVP_MD_CTX_free(ctx);
+  if (!EVP_DigestInit_ex(ctx.get(), EVP_sha256(), nullptr)) {
     throw StoreError("Store: Failed to initialize hash context");
   }
 
-  // Feed the input key data into the hash function
-  if (!EVP_DigestUpdate(ctx, key.c_str(), key.length())) {
-    EVP_MD_CTX_free(ctx);
+  // Feed the input data into the hash function
+  if (!EVP_DigestUpdate(ctx.get(), data, length)) {
     throw StoreError("Store: Failed to update hash");
   }
 
   // Generate the final hash value
-  if (!EVP_DigestFinal_ex(ctx, hash, &hash_len)) {
-    EVP_MD_CTX_free(ctx);
+  if (!EVP_DigestFinal_ex(ctx.get(), hash, &hash_len)) {
     throw StoreError("Store: Failed to finalize hash");
   }
 
-  // Clean up the context
-  EVP_MD_CTX_free(ctx);
-
   // Convert the raw hash bytes to a hexadecimal string
-  std::stringstream ss;
+  std::string result(hash_len * 2, '0');
   for (unsigned int i = 0; i < hash_len; i++) {
-    ss << std::hex << std::setw(2) << std::setfill('0') 
-       << static_cast<int>(hash[i]);
+    result[2 * i] = HEX_DIGITS[hash[i] >> 4];
+    result[2 * i + 1] = HEX_DIGITS[hash[i] & 0x0F];
   }
 
-  std::string result = ss.str();
-  BOOST_LOG_TRIVIAL(debug) << "Store: Generated hash: " << result;
+  BOOST_LOG_TRIVIAL(trace) << "Store: Generated hash: " << result;
   return result;
 }
 
-std::filesystem::path Store::get_path_for_hash(const std::string& hash) const {
-  std::filesystem::path path = base_path_;
+std::filesystem::path Store::get_path_for_hash(const std::string& hash, uint32_t volume) const {
+  if (volume >= volumes_.size()) {
+    BOOST_LOG_TRIVIAL(error) << "Store: Object " << hash << " refers to unknown volume " << volume;
+    throw StoreError("Store: Unknown volume " + std::to_string(volume));
+  }
+  std::filesystem::path path = volumes_[volume]->root;
   
   for (size_t i = 0; i < 6; i += 2) {
     path /= hash.substr(i, 2);
@@ -379,21 +1039,1352 @@ std::filesystem::path Store::get_path_for_hash(const std::string& hash) const {
   BOOST_LOG_TRIVIAL(debug) << "Store: Calculated path: " << path.string();
   return path;
 }
-  
+
 
 //==============================================
-// UTILITY METHODS 
+// VOLUME MANAGEMENT
 //==============================================
-  
-void Store::check_directory_exists(const std::filesystem::path& path) const {
-  if (!std::filesystem::exists(path)) {
-    std::filesystem::create_directories(path);
+
+void Store::open_volumes() {
+  volumes_.clear();
+  attach_volume(base_path_, StorageTier::Fast);
+
+  std::ifstream list(base_path_ / VOLUMES_FILENAME);
+  std::string root;
+  while (std::getline(list, root)) {
+    if (root.empty()) {
+      continue;
+    }
+    // Lines written before tiers existed carry no tag and are fast volumes
+    StorageTier tier = StorageTier::Fast;
+    size_t tag = root.size() - std::min(root.size(), sizeof(SLOW_TIER_TAG) - 1);
+    if (root.compare(tag, std::string::npos, SLOW_TIER_TAG) == 0) {
+      tier = StorageTier::Slow;
+      root.erase(tag);
+    }
+    // Entries locate their volume by position, so a missing disk cannot be skipped
+    if (!std::filesystem::is_directory(root)) {
+      BOOST_LOG_TRIVIAL(error) << "Store: Volume is missing: " << root;
+      throw StoreError("Store: Volume is missing: " + root);
+    }
+    attach_volume(root, tier);
   }
+  refresh_free_space();
 }
 
-std::filesystem::path Store::resolve_key_path(const std::string& key) const {
-  std::string hash = hash_key(key);
-  return get_path_for_hash(hash);
+void Store::attach_volume(const std::filesystem::path& root, StorageTier tier) {
+  auto volume = std::make_unique<Volume>();
+  volume->root = root;
+  volume->tier = tier;
+  // Tombstones are renamed, so every volume needs a trash on its own filesystem
+  volume->reclaimer = std::make_unique<Reclaimer>(root, root / TRASH_DIRECTORY, Reclaimer::DEFAULT_INTERVAL,
+                                                  &scheduler_);
+  volumes_.push_back(std::move(volume));
+  BOOST_LOG_TRIVIAL(info) << "Store: Attached volume " << volumes_.size() - 1 << " at: " << root;
+}
+
+uint32_t Store::place_object(const std::string& hash, StorageTier tier) {
+  if (volumes_.size() == 1) {
+    return 0;
+  }
+  if (placements_++ % VOLUME_REFRESH_INTERVAL == 0) {
+    refresh_free_space();
+  }
+  bool tier_exists = std::any_of(volumes_.begin(), volumes_.end(), [tier](const auto& volume) {
+    return volume->tier == tier;
+  });
+
+  // Weighted rendezvous hashing: every volume draws a uniform value from the
+  // object hash and the highest weight / -ln(value) wins. Each volume receives
+  // its share of free space and adding a volume only moves objects onto it
+  uint64_t seed = std::strtoull(hash.substr(0, 16).c_str(), nullptr, 16);
+  uint32_t best = 0;
+  double best_score = -1;
+  for (uint32_t volume = 0; volume < volumes_.size(); ++volume) {
+    if (tier_exists && volumes_[volume]->tier != tier) {
+      continue;
+    }
+    uint64_t x = seed + (volume + 1) * 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    double uniform = (static_cast<double>(x >> 11) + 0.5) / 9007199254740992.0;  // In (0, 1)
+    double weight = static_cast<double>(std::max<uint64_t>(volumes_[volume]->free_bytes, 1));
+    double score = -weight / std::log(uniform);
+    if (score > best_score) {
+      best_score = score;
+      best = volume;
+    }
+  }
+  return best;
+}
+
+void Store::refresh_free_space() {
+  for (auto& volume : volumes_) {
+    std::error_code ec;
+    std::filesystem::space_info space = std::filesystem::space(volume->root, ec);
+    volume->free_bytes = ec ? 0 : space.available;
+  }
+}
+
+uint32_t Store::volume_for_write(const std::string& hash, const std::optional<IndexEntry>& previous) {
+  // Overwrites stay on the object's fast volume, new objects and objects
+  // rewritten after demotion are placed by hash and free space
+  if (previous && !(previous->flags & INDEX_FLAG_PACKED) && previous->volume() < volumes_.size() &&
+      volumes_[previous->volume()]->tier == StorageTier::Fast) {
+    return previous->volume();
+  }
+  return place_object(hash);
+}
+
+bool Store::bury(const std::filesystem::path& path, uint32_t volume) {
+  return volumes_.at(volume)->reclaimer->bury(path);
+}
+
+std::optional<uint32_t> Store::find_volume(const std::string& hash) const {
+  for (uint32_t volume = 0; volume < volumes_.size(); ++volume) {
+    if (std::filesystem::exists(get_path_for_hash(hash, volume))) {
+      return volume;
+    }
+  }
+  return std::nullopt;
+}
+
+
+//==============================================
+// TIERED STORAGE
+//==============================================
+
+void Store::migrate_loop() {
+  std::unique_lock<std::mutex> lock(migrator_mutex_);
+  while (migrator_running_) {
+    // A policy with a new interval ends the current wait
+    std::chrono::milliseconds interval = tiering_.interval;
+    migrator_cv_.wait_for(lock, interval, [this, interval] {
+      return !migrator_running_ || tiering_.interval != interval;
+    });
+    if (!migrator_running_) {
+      break;
+    }
+    lock.unlock();
+    try {
+      migrate_cold_objects();
+    } catch (const std::exception& e) {
+      BOOST_LOG_TRIVIAL(error) << "Store: Migration pass failed: " << e.what();
+    }
+    lock.lock();
+  }
+}
+
+void Store::stop_migrator() {
+  {
+    std::lock_guard<std::mutex> lock(migrator_mutex_);
+    migrator_running_ = false;
+  }
+  migrator_cv_.notify_all();
+  if (migrator_.joinable()) {
+    migrator_.join();
+  }
+}
+
+void Store::rank_demotion_candidates(const TieringPolicy& policy) {
+  // Rank old enough objects like replicas for eviction, objects never read
+  // since startup falling back to store time
+  struct Candidate {
+    DemotionCandidate candidate;
+    uint64_t last_access;
+    int64_t mtime;
+  };
+  std::vector<Candidate> candidates;
+  auto now = std::chrono::system_clock::now();
+  int64_t cutoff = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    now.time_since_epoch() - policy.min_age).count();
+  int64_t oldest_skipped = std::numeric_limits<int64_t>::max();
+  index_->for_each([&](const std::string& key, const IndexEntry& entry) {
+    if ((entry.flags & (INDEX_FLAG_CHUNKED | INDEX_FLAG_PACKED)) || entry.volume() >= volumes_.size() ||
+        volumes_[entry.volume()]->tier != StorageTier::Fast) {
+      return;
+    }
+    if (entry.mtime > cutoff) {
+      oldest_skipped = std::min(oldest_skipped, entry.mtime);
+      return;
+    }
+    std::optional<AccessStats> stats = access_.lookup(key);
+    candidates.push_back(Candidate{DemotionCandidate{key, entry.hash, access_.score(stats)},
+                                   stats ? stats->last_access : 0, entry.mtime});
+  });
+  std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+    if (a.candidate.score != b.candidate.score) {
+      return a.candidate.score < b.candidate.score;
+    }
+    return a.last_access != b.last_access ? a.last_access < b.last_access : a.mtime < b.mtime;
+  });
+
+  demotion_queue_.clear();
+  for (auto& candidate : candidates) {
+    demotion_queue_.push_back(std::move(candidate.candidate));
+  }
+  // Nothing skipped now becomes movable before the oldest skipped object does
+  next_ranking_ = now + policy.min_age;
+  if (oldest_skipped != std::numeric_limits<int64_t>::max()) {
+    auto eligible = std::chrono::system_clock::time_point(std::chrono::duration_cast<std::chrono::system_clock::duration>(
+      std::chrono::nanoseconds(oldest_skipped))) + policy.min_age;
+    next_ranking_ = std::min(next_ranking_, eligible);
+  }
+  BOOST_LOG_TRIVIAL(debug) << "Store: Ranked " << demotion_queue_.size() << " objects for demotion";
+}
+
+size_t Store::promote_hot_objects(const TieringPolicy& policy) {
+  std::set<std::string> keys;
+  {
+    std::lock_guard<std::mutex> lock(migrator_mutex_);
+    keys.swap(promotion_queue_);
+  }
+
+  // Promotion stops at the capacity, so it never triggers the next demotion
+  uint64_t fast_bytes = fast_file_bytes();
+  size_t promoted = 0;
+  for (const auto& key : keys) {
+    std::optional<IndexEntry> entry = index_->lookup(key);
+    if (!entry) {
+      continue;
+    }
+    if (fast_bytes + entry->size > policy.fast_capacity) {
+      continue;
+    }
+    if (move_object(key, entry->hash, StorageTier::Fast)) {
+      fast_bytes += entry->size;
+      promoted++;
+    }
+  }
+  return promoted;
+}
+
+void Store::consider_promotion(const std::string& key) const {
+  std::optional<IndexEntry> entry = index_->lookup(key);
+  if (!entry || (entry->flags & (INDEX_FLAG_CHUNKED | INDEX_FLAG_PACKED)) || entry->volume() >= volumes_.size() ||
+      volumes_[entry->volume()]->tier != StorageTier::Slow) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(migrator_mutex_);
+  if (tiering_.fast_capacity > 0 && tiering_.promote_score > 0 &&
+      access_.score(access_.lookup(key)) >= tiering_.promote_score) {
+    promotion_queue_.insert(key);
+  }
+}
+
+uint64_t Store::fast_file_bytes() const {
+  uint64_t bytes = 0;
+  for (uint32_t volume = 0; volume < volumes_.size(); ++volume) {
+    if (volumes_[volume]->tier == StorageTier::Fast) {
+      bytes += index_->file_bytes(volume);
+    }
+  }
+  return bytes;
+}
+
+bool Store::move_object(const std::string& key, const std::string& hash, StorageTier tier) {
+  uint32_t target = place_object(hash, tier);
+  std::filesystem::path target_path = get_path_for_hash(hash, target);
+  std::filesystem::path temp_path;
+  IndexEntry entry;
+  int fd;
+  {
+    // Readers continue while the copy is made, writers of the key wait
+    auto lock = locks_.lock_shared(hash);
+    std::optional<IndexEntry> current = index_->lookup(key);
+    if (!current || (current->flags & (INDEX_FLAG_CHUNKED | INDEX_FLAG_PACKED)) || current->volume() >= volumes_.size() ||
+        volumes_[current->volume()]->tier == tier) {
+      return false;
+    }
+    entry = *current;
+    check_directory_exists(target_path.parent_path());
+    fd = open_temp_file(target_path, temp_path);
+    try {
+      copy_file_contents(get_path_for_hash(hash, entry.volume()), fd);
+      // The object was durable on its old tier and must not be less so on the new one
+      if (durability_ != Durability::GroupCommit && ::fdatasync(fd) != 0) {
+        throw StoreError("Store: Failed to sync moved object: " + target_path.string());
+      }
+    } catch (...) {
+      ::close(fd);
+      std::filesystem::remove(temp_path);
+      throw;
+    }
+  }
+
+  // Publish only if nothing replaced the object while the key was shared
+  auto lock = locks_.lock_exclusive(hash);
+  std::optional<IndexEntry> current = index_->lookup(key);
+  if (!current || current->mtime != entry.mtime || current->flags != entry.flags) {
+    ::close(fd);
+    std::filesystem::remove(temp_path);
+    return false;
+  }
+  IndexEntry moved = entry;
+  moved.flags = (entry.flags & ~INDEX_VOLUME_MASK) | (target << INDEX_VOLUME_SHIFT);
+  commit_temp_file(fd, temp_path, target_path, [this, &key, &moved] { index_->put(key, moved); }).get();
+  bury(get_path_for_hash(hash, entry.volume()), entry.volume());
+  if (tier == StorageTier::Slow) {
+    demotions_++;
+  } else {
+    promotions_++;
+  }
+  BOOST_LOG_TRIVIAL(debug) << "Store: " << (tier == StorageTier::Slow ? "Demoted " : "Promoted ") << key
+                           << " to volume " << target;
+  return true;
+}
+
+uint64_t Store::copy_file_contents(const std::filesystem::path& source, int fd) const {
+  int source_fd = ::open(source.c_str(), O_RDONLY | O_CLOEXEC);
+  if (source_fd < 0) {
+    throw StoreError("Store: Failed to open object for migration: " + source.string());
+  }
+  std::vector<char> buffer(MIGRATION_BUFFER_SIZE);
+  uint64_t copied = 0;
+  while (true) {
+    auto grant = scheduler_.acquire(IoClass::Background, buffer.size());
+    ssize_t n = io::pread_all(source_fd, buffer.data(), buffer.size(), copied);
+    if (n < 0 || (n > 0 && !io::write_all(fd, buffer.data(), static_cast<size_t>(n)))) {
+      ::close(source_fd);
+      throw StoreError("Store: Failed to copy object for migration: " + source.string());
+    }
+    if (n == 0) {
+      break;
+    }
+    copied += static_cast<uint64_t>(n);
+  }
+  ::close(source_fd);
+  return copied;
+}
+
+
+//==============================================
+// INTEGRITY CHECKING
+//==============================================
+
+void Store::scrub_loop() {
+  std::unique_lock<std::mutex> lock(scrubber_mutex_);
+  while (scrubber_running_) {
+    // A policy with a new interval ends the current wait
+    std::chrono::milliseconds interval = scrubbing_.interval;
+    scrubber_cv_.wait_for(lock, interval, [this, interval] {
+      return !scrubber_running_ || scrubbing_.interval != interval;
+    });
+    if (!scrubber_running_) {
+      break;
+    }
+    lock.unlock();
+    try {
+      scrub_objects();
+    } catch (const std::exception& e) {
+      BOOST_LOG_TRIVIAL(error) << "Store: Scrub pass failed: " << e.what();
+    }
+    lock.lock();
+  }
+}
+
+void Store::stop_scrubber() {
+  {
+    std::lock_guard<std::mutex> lock(scrubber_mutex_);
+    scrubber_running_ = false;
+    scrub_cancelled_ = true;
+  }
+  scrubber_cv_.notify_all();
+  if (scrubber_.joinable()) {
+    scrubber_.join();
+  }
+  std::lock_guard<std::mutex> lock(scrubber_mutex_);
+  scrub_cancelled_ = false;
+}
+
+bool Store::scrub_object(const std::string& key) {
+  std::string hash = lookup_hash(key);
+  IndexEntry entry;
+  {
+    // Scrubbing reads at background priority and bypasses the cache
+    auto lock = locks_.lock_shared(hash);
+    std::optional<IndexEntry> current = index_->lookup(key);
+    if (!current || !(current->flags & INDEX_FLAG_CHECKSUM)) {
+      return true;
+    }
+    entry = *current;
+    bool intact = false;
+    try {
+      ObjectViewPtr view = load_view(key, IoClass::Background);
+      scrubbed_bytes_ += view->size();
+      intact = checksum_view(*view) == entry.checksum;
+    } catch (const std::exception& e) {
+      // An unreadable object is reported like a corrupt one and the pass goes on
+      BOOST_LOG_TRIVIAL(error) << "Store: Failed to read object while scrubbing key: " << key << ": " << e.what();
+    }
+    scrubbed_objects_++;
+    if (intact) {
+      return true;
+    }
+  }
+  record_corruption(key);
+
+  // Peers hold intact copies of a replica, so a corrupt one is dropped
+  // unless it was rewritten since it was read
+  if (entry.flags & INDEX_FLAG_REPLICA) {
+    auto lock = locks_.lock_exclusive(hash);
+    std::optional<IndexEntry> current = index_->lookup(key);
+    if (current && current->mtime == entry.mtime && current->flags == entry.flags) {
+      remove_object(hash, current->flags);
+      index_->erase(key);
+      cache_.invalidate(key);
+      access_.forget(key);
+      BOOST_LOG_TRIVIAL(warning) << "Store: Dropped corrupt replica with key: " << key;
+    }
+  }
+  return false;
+}
+
+void Store::verify_view(const std::string& key, const IndexEntry& entry, const ObjectView& view) const {
+  if (!(entry.flags & INDEX_FLAG_CHECKSUM) || checksum_view(view) == entry.checksum) {
+    return;
+  }
+  record_corruption(key);
+  throw StoreError("Store: Checksum mismatch for key: " + key);
+}
+
+void Store::record_corruption(const std::string& key) const {
+  corruptions_++;
+  {
+    std::lock_guard<std::mutex> lock(corrupt_mutex_);
+    corrupt_keys_.insert(key);
+  }
+  BOOST_LOG_TRIVIAL(error) << "Store: Checksum mismatch for key: " << key;
+}
+
+uint32_t Store::checksum_view(const ObjectView& view) {
+  if (view.is_contiguous()) {
+    return Crc32c::compute(view.bytes().data(), view.bytes().size());
+  }
+  std::vector<char> buffer(ObjectView::READ_CHUNK_SIZE);
+  uint32_t checksum = 0;
+  std::uintmax_t offset = 0;
+  while (size_t n = view.read(offset, buffer.data(), buffer.size())) {
+    checksum = Crc32c::update(checksum, buffer.data(), n);
+    offset += n;
+  }
+  return checksum;
+}
+
+  
+//==============================================
+// CHUNKED STORAGE SUPPORT
+//==============================================
+
+size_t Store::store_chunked(int fd, std::istream& data, IoClass io_class, uint32_t& checksum) {
+  // Buffer holds two maximum-size chunks so the chunker always sees a full window
+  std::vector<uint8_t> buffer(chunker_.max_size() * 2);
+  size_t filled = 0;
+  bool input_done = false;
+  size_t new_bytes = 0;
+  Manifest manifest;
+  std::vector<std::future<void>> pending;
+
+  while (true) {
+    // Top up the buffer from the input stream
+    while (!input_done && filled < buffer.size()) {
+      data.read(reinterpret_cast<char*>(buffer.data() + filled), buffer.size() - filled);
+      filled += data.gcount();
+      if (data.bad()) {
+        throw StoreError("Store: Failed to read input stream");
+      }
+      if (!data) {
+        input_done = true;
+      }
+    }
+
+    if (filled == 0) {
+      break;
+    }
+
+    // Cut the next chunk and store it under its content hash
+    size_t length = chunker_.next_boundary(buffer.data(), filled);
+    std::string hash = hash_bytes(buffer.data(), length);
+    checksum = Crc32c::update(checksum, buffer.data(), length);
+    if (write_chunk(hash, buffer.data(), length, io_class, pending)) {
+      new_bytes += length;
+    }
+    manifest.chunks.emplace_back(hash, length);
+    manifest.total_size += length;
+
+    // Shift the unconsumed tail to the front of the buffer
+    std::memmove(buffer.data(), buffer.data() + length, filled - length);
+    filled -= length;
+  }
+
+  // Write the manifest only after its chunks are committed so readers never
+  // see references to missing chunks
+  for (auto& commit : pending) {
+    commit.get();
+  }
+  std::ostringstream contents;
+  contents.write(MANIFEST_MAGIC, MANIFEST_MAGIC_SIZE);
+  contents << manifest.total_size << '\n';
+  for (const auto& [hash, length] : manifest.chunks) {
+    contents << hash << ' ' << length << '\n';
+  }
+  const std::string encoded = contents.str();
+  auto grant = scheduler_.acquire(io_class, encoded.size());
+  if (!io::write_all(fd, encoded.data(), encoded.size())) {
+    throw StoreError("Store: Failed to write manifest");
+  }
+
+  BOOST_LOG_TRIVIAL(debug) << "Store: Chunked " << manifest.total_size << " bytes into " 
+                           << manifest.chunks.size() << " chunks, " << new_bytes << " bytes new";
+  return manifest.total_size;
+}
+
+bool Store::write_chunk(const std::string& hash, const uint8_t* data, size_t length, IoClass io_class,
+                        std::vector<std::future<void>>& pending) {
+  std::filesystem::path chunk_path = get_chunk_path(hash);
+  if (std::filesystem::exists(chunk_path)) {
+    BOOST_LOG_TRIVIAL(trace) << "Store: Deduplicated chunk: " << hash;
+    return false;
+  }
+  check_directory_exists(chunk_path.parent_path());
+
+  std::filesystem::path temp_path;
+  int fd = open_temp_file(chunk_path, temp_path);
+  auto grant = scheduler_.acquire(io_class, length);
+  if (!io::write_all(fd, reinterpret_cast<const char*>(data), length)) {
+    ::close(fd);
+    std::filesystem::remove(temp_path);
+    throw StoreError("Store: Failed to write chunk: " + chunk_path.string());
+  }
+  pending.push_back(commit_temp_file(fd, temp_path, chunk_path));
+  return true;
+}
+
+bool Store::read_manifest(std::istream& file, Manifest& manifest) const {
+  char magic[MANIFEST_MAGIC_SIZE];
+  file.read(magic, MANIFEST_MAGIC_SIZE);
+  if (file.gcount() != static_cast<std::streamsize>(MANIFEST_MAGIC_SIZE) ||
+      std::memcmp(magic, MANIFEST_MAGIC, MANIFEST_MAGIC_SIZE) != 0) {
+    // Raw content, rewind so the caller can read it from the start
+    file.clear();
+    file.seekg(0);
+    return false;
+  }
+
+  if (!(file >> manifest.total_size)) {
+    throw StoreError("Store: Corrupt manifest header");
+  }
+  std::string hash;
+  std::size_t length;
+  while (file >> hash >> length) {
+    manifest.chunks.emplace_back(hash, length);
+  }
+  return true;
+}
+
+Store::Manifest Store::open_manifest(const std::filesystem::path& path) const {
+  std::ifstream file(path, std::ios::binary);
+  Manifest manifest;
+  if (!file || !read_manifest(file, manifest)) {
+    BOOST_LOG_TRIVIAL(error) << "Store: Corrupt manifest: " << path.string();
+    throw StoreError("Store: Corrupt manifest: " + path.string());
+  }
+  return manifest;
+}
+
+void Store::stream_chunks(const Manifest& manifest, std::ostream& output) const {
+  std::vector<char> buffer(chunker_.max_size());
+  for (const auto& [hash, length] : manifest.chunks) {
+    std::filesystem::path chunk_path = get_chunk_path(hash);
+    std::ifstream chunk(chunk_path, std::ios::binary);
+    if (!chunk) {
+      BOOST_LOG_TRIVIAL(error) << "Store: Missing chunk: " << chunk_path.string();
+      throw StoreError("Store: Missing chunk " + hash);
+    }
+    if (buffer.size() < length) {
+      buffer.resize(length);
+    }
+    if (!chunk.read(buffer.data(), length)) {
+      throw StoreError("Store: Truncated chunk " + hash);
+    }
+    output.write(buffer.data(), length);
+  }
+
+  if (!output.good()) {
+    throw StoreError("Store: Failed to write to output stream");
+  }
+}
+
+std::filesystem::path Store::get_chunk_path(const std::string& hash) const {
+  std::filesystem::path path = get_path_for_hash(hash);
+  path += CHUNK_EXTENSION;
+  return path;
+}
+
+
+//==============================================
+// COMPRESSED STORAGE SUPPORT
+//==============================================
+
+size_t Store::store_compressed(int fd, std::istream& data, IoClass io_class, bool& compressed,
+                               uint32_t& checksum) {
+  std::vector<char> block(COMPRESSION_BLOCK_SIZE);
+  std::vector<char> packed(LzCodec::max_compressed_size(COMPRESSION_BLOCK_SIZE));
+  std::vector<uint32_t> lengths;
+  std::string encoded;
+  size_t consumed = 0;
+
+  // Reads the next block, false once the input is exhausted
+  auto read_block = [&](size_t& length) {
+    data.read(block.data(), block.size());
+    length = static_cast<size_t>(data.gcount());
+    if (data.bad()) {
+      throw StoreError("Store: Failed to read input stream");
+    }
+    checksum = Crc32c::update(checksum, block.data(), length);
+    return length > 0;
+  };
+  // Appends a block to encoded, uncompressed if compressing does not shrink it
+  auto encode_block = [&](size_t length) {
+    size_t stored = LzCodec::compress(block.data(), length, packed.data(), packed.size());
+    if (stored == 0 || stored >= length) {
+      encoded.append(block.data(), length);
+      lengths.push_back(static_cast<uint32_t>(length) | RAW_BLOCK_FLAG);
+    } else {
+      encoded.append(packed.data(), stored);
+      lengths.push_back(static_cast<uint32_t>(stored));
+    }
+    consumed += length;
+  };
+  auto write_encoded = [&] {
+    auto grant = scheduler_.acquire(io_class, encoded.size());
+    if (!io::write_all(fd, encoded.data(), encoded.size())) {
+      throw StoreError("Store: Failed to write compressed data");
+    }
+    encoded.clear();
+  };
+
+  // Compress a sample first so incompressible data costs only these blocks
+  std::string sample;
+  size_t length;
+  while (lengths.size() < COMPRESSION_SAMPLE_BLOCKS && read_block(length)) {
+    sample.append(block.data(), length);
+    encode_block(length);
+  }
+  if (encoded.size() >= sample.size() * COMPRESSION_MIN_RATIO) {
+    {
+      auto grant = scheduler_.acquire(io_class, sample.size());
+      if (!io::write_all(fd, sample.data(), sample.size())) {
+        throw StoreError("Store: Failed to write data");
+      }
+    }
+    compressed = false;
+    incompressible_objects_++;
+    BOOST_LOG_TRIVIAL(debug) << "Store: Sample of " << sample.size() << " bytes compressed to "
+                             << encoded.size() << ", storing raw";
+    return sample.size() + write_stream(fd, data, io_class, checksum);
+  }
+
+  encoded.insert(0, COMPRESSED_MAGIC, COMPRESSED_MAGIC_SIZE);
+  uint64_t stored_bytes = encoded.size();
+  write_encoded();
+  while (read_block(length)) {
+    encode_block(length);
+    stored_bytes += encoded.size();
+    write_encoded();
+  }
+
+  // The block index and footer go last so blocks never need to be buffered
+  uint64_t original_size = consumed;
+  uint64_t index_offset = stored_bytes;
+  uint32_t block_size = static_cast<uint32_t>(COMPRESSION_BLOCK_SIZE);
+  uint32_t block_count = static_cast<uint32_t>(lengths.size());
+  encoded.resize(lengths.size() * sizeof(uint32_t) + COMPRESSED_FOOTER_SIZE);
+  char* out = encoded.data();
+  std::memcpy(out, lengths.data(), lengths.size() * sizeof(uint32_t));
+  out += lengths.size() * sizeof(uint32_t);
+  std::memcpy(out, &original_size, sizeof(original_size));
+  std::memcpy(out + 8, &index_offset, sizeof(index_offset));
+  std::memcpy(out + 16, &block_size, sizeof(block_size));
+  std::memcpy(out + 20, &block_count, sizeof(block_count));
+  stored_bytes += encoded.size();
+  write_encoded();
+
+  compressed = true;
+  compressed_objects_++;
+  compressed_input_bytes_ += original_size;
+  compressed_stored_bytes_ += stored_bytes;
+  BOOST_LOG_TRIVIAL(debug) << "Store: Compressed " << original_size << " bytes into " << stored_bytes
+                           << " in " << block_count << " blocks";
+  return consumed;
+}
+
+Store::BlockIndex Store::read_block_index(int fd, const std::filesystem::path& path) const {
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || static_cast<uint64_t>(st.st_size) < COMPRESSED_MAGIC_SIZE + COMPRESSED_FOOTER_SIZE) {
+    throw StoreError("Store: Corrupt compressed object: " + path.string());
+  }
+  uint64_t file_size = static_cast<uint64_t>(st.st_size);
+
+  char footer[COMPRESSED_FOOTER_SIZE];
+  uint64_t original_size, index_offset;
+  uint32_t block_size, block_count;
+  if (io::pread_all(fd, footer, sizeof(footer), file_size - sizeof(footer)) != static_cast<ssize_t>(sizeof(footer))) {
+    throw StoreError("Store: Failed to read compressed object footer: " + path.string());
+  }
+  std::memcpy(&original_size, footer, sizeof(original_size));
+  std::memcpy(&index_offset, footer + 8, sizeof(index_offset));
+  std::memcpy(&block_size, footer + 16, sizeof(block_size));
+  std::memcpy(&block_count, footer + 20, sizeof(block_count));
+  if (block_size == 0 || index_offset < COMPRESSED_MAGIC_SIZE ||
+      index_offset + uint64_t{block_count} * sizeof(uint32_t) + sizeof(footer) != file_size ||
+      original_size > uint64_t{block_count} * block_size ||
+      original_size > (file_size - COMPRESSED_MAGIC_SIZE) * LzCodec::MAX_EXPANSION) {
+    throw StoreError("Store: Corrupt compressed object footer: " + path.string());
+  }
+
+  std::vector<uint32_t> lengths(block_count);
+  size_t index_bytes = lengths.size() * sizeof(uint32_t);
+  if (io::pread_all(fd, reinterpret_cast<char*>(lengths.data()), index_bytes, index_offset) != static_cast<ssize_t>(index_bytes)) {
+    throw StoreError("Store: Failed to read compressed block index: " + path.string());
+  }
+
+  BlockIndex index;
+  index.original_size = original_size;
+  index.block_size = block_size;
+  index.offsets.reserve(lengths.size() + 1);
+  index.raw.reserve(lengths.size());
+  uint64_t offset = COMPRESSED_MAGIC_SIZE;
+  for (uint32_t length : lengths) {
+    index.offsets.push_back(offset);
+    index.raw.push_back((length & RAW_BLOCK_FLAG) != 0);
+    offset += length & ~RAW_BLOCK_FLAG;
+  }
+  index.offsets.push_back(offset);
+  if (offset != index_offset) {
+    throw StoreError("Store: Corrupt compressed block index: " + path.string());
+  }
+  return index;
+}
+
+void Store::read_blocks(int fd, const std::filesystem::path& path, const BlockIndex& index, size_t first, size_t last,
+                        std::vector<char>& output) const {
+  std::vector<char> stored;
+  for (size_t i = first; i <= last; ++i) {
+    size_t stored_length = static_cast<size_t>(index.offsets[i + 1] - index.offsets[i]);
+    size_t block_length = static_cast<size_t>(
+      std::min<std::uintmax_t>(index.block_size, index.original_size - i * index.block_size));
+    stored.resize(stored_length);
+    if (io::pread_all(fd, stored.data(), stored_length, index.offsets[i]) != static_cast<ssize_t>(stored_length)) {
+      throw StoreError("Store: Failed to read compressed block: " + path.string());
+    }
+
+    size_t start = output.size();
+    if (index.raw[i]) {
+      if (stored_length != block_length) {
+        throw StoreError("Store: Corrupt compressed block: " + path.string());
+      }
+      output.insert(output.end(), stored.begin(), stored.end());
+      continue;
+    }
+    output.resize(start + block_length);
+    if (!LzCodec::decompress(stored.data(), stored_length, output.data() + start, block_length)) {
+      BOOST_LOG_TRIVIAL(error) << "Store: Corrupt block " << i << " in " << path.string();
+      throw StoreError("Store: Corrupt compressed block: " + path.string());
+    }
+  }
+}
+
+std::vector<char> Store::read_compressed(const std::filesystem::path& path) const {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw StoreError("Store: Failed to open compressed object: " + path.string());
+  }
+  std::vector<char> content;
+  try {
+    BlockIndex index = read_block_index(fd, path);
+    content.reserve(static_cast<size_t>(index.original_size));
+    if (!index.raw.empty()) {
+      read_blocks(fd, path, index, 0, index.raw.size() - 1, content);
+    }
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+  return content;
+}
+
+std::uintmax_t Store::read_compressed_range(const std::string& key, const std::filesystem::path& path,
+                                            std::uintmax_t offset, std::uintmax_t length,
+                                            std::ostream& output) const {
+  int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    throw StoreError("Store: Failed to open compressed object: " + path.string());
+  }
+  std::vector<char> content;
+  std::uintmax_t content_start = 0;
+  std::uintmax_t end = 0;
+  try {
+    BlockIndex index = read_block_index(fd, path);
+    check_range(key, offset, index.original_size);
+    end = offset + std::min(length, index.original_size - offset);
+    if (end > offset) {
+      size_t first = static_cast<size_t>(offset / index.block_size);
+      read_blocks(fd, path, index, first, static_cast<size_t>((end - 1) / index.block_size), content);
+      content_start = static_cast<std::uintmax_t>(first) * index.block_size;
+    }
+  } catch (...) {
+    ::close(fd);
+    throw;
+  }
+  ::close(fd);
+
+  if (end == offset) {
+    return 0;
+  }
+  output.write(content.data() + (offset - content_start), static_cast<std::streamsize>(end - offset));
+  if (!output.good()) {
+    throw StoreError("Store: Failed to write to output stream");
+  }
+  return end - offset;
+}
+
+
+//==============================================
+// CAPACITY MANAGEMENT
+//==============================================
+
+void Store::store_object(const std::string& key, std::istream& data, ObjectOrigin origin) {
+  BOOST_LOG_TRIVIAL(info) << "Store: Storing data with key: " << key;
+
+  if (!data.good()) {
+    BOOST_LOG_TRIVIAL(error) << "Store: Invalid input stream provided for key: " << key;
+    throw StoreError("Store: Invalid input stream");
+  }
+
+  // Writers of one key are serialized, writers of unrelated keys proceed in parallel
+  std::string hash = lookup_hash(key);
+  auto lock = locks_.lock_exclusive(hash);
+  std::optional<IndexEntry> previous = index_->lookup(key);
+
+  // Small objects are appended to a pack segment instead of getting their own file
+  std::vector<char> small_object;
+  if (packing_enabled_ && read_small_object(data, small_object)) {
+    {
+      auto grant = scheduler_.acquire(io_class_for(origin), small_object.size());
+      pack_->put(hash, small_object.data(), small_object.size());
+    }
+    uint32_t flags = INDEX_FLAG_PACKED | origin_flags(previous, origin);
+    uint32_t checksum = Crc32c::compute(small_object.data(), small_object.size());
+    auto record = [this, &key, &hash, &small_object, flags, checksum] {
+      index_object(key, hash, small_object.size(), flags, checksum);
+    };
+    if (durability_ == Durability::GroupCommit) {
+      // The committer syncs the pack before recording and syncs the index after, once per batch
+      committer_->submit(record).get();
+    } else {
+      record();
+    }
+    if (previous && !(previous->flags & INDEX_FLAG_PACKED)) {
+      remove_object(hash, previous->flags);
+    }
+    cache_.invalidate(key);
+    BOOST_LOG_TRIVIAL(info) << "Store: Successfully packed " << small_object.size() << " bytes with key: " << key;
+    return;
+  }
+
+  uint32_t volume = volume_for_write(hash, previous);
+  std::filesystem::path file_path = get_path_for_hash(hash, volume);
+  check_directory_exists(file_path.parent_path());
+  BOOST_LOG_TRIVIAL(debug) << "Store: Calculated file path: " << file_path.string();
+
+  // Write everything under a temp name so readers never see partial objects
+  std::filesystem::path temp_path;
+  int fd = open_temp_file(file_path, temp_path);
+  size_t bytes_written = 0;
+  uint32_t flags = volume << INDEX_VOLUME_SHIFT;
+  uint32_t checksum = 0;
+  // Held from the first reused chunk until the manifest is published
+  std::shared_lock<std::shared_mutex> chunk_lock;
+  try {
+    data.peek();
+    if (data.eof()) {
+      BOOST_LOG_TRIVIAL(debug) << "Store: Storing empty content for key: " << key;
+    } else if (chunking_enabled_) {
+      // Chunked objects are written as a manifest of deduplicated chunks
+      chunk_lock = std::shared_lock<std::shared_mutex>(chunk_mutex_);
+      bytes_written = store_chunked(fd, data, io_class_for(origin), checksum);
+      flags |= INDEX_FLAG_CHUNKED;
+    } else if (compression_enabled_) {
+      bool compressed = false;
+      bytes_written = store_compressed(fd, data, io_class_for(origin), compressed, checksum);
+      if (compressed) {
+        flags |= INDEX_FLAG_COMPRESSED;
+      }
+    } else {
+      bytes_written = write_stream(fd, data, io_class_for(origin), checksum);
+    }
+  } catch (...) {
+    ::close(fd);
+    std::filesystem::remove(temp_path);
+    throw;
+  }
+
+  publish_temp_file(key, hash, fd, temp_path, bytes_written, flags, origin, checksum);
+  BOOST_LOG_TRIVIAL(info) << "Store: Successfully stored " << bytes_written << " bytes with key: " << key;
+}
+
+uint32_t Store::origin_flags(const std::optional<IndexEntry>& previous, ObjectOrigin origin) {
+  // Once a node stores an object itself it is never demoted to a replica
+  bool local = origin == ObjectOrigin::Local || (previous && !(previous->flags & INDEX_FLAG_REPLICA));
+  return local ? 0u : static_cast<uint32_t>(INDEX_FLAG_REPLICA);
+}
+
+IoClass Store::io_class_for(ObjectOrigin origin) {
+  return origin == ObjectOrigin::Replica ? IoClass::Replication : IoClass::Foreground;
+}
+
+void Store::enforce_capacity() {
+  uint64_t capacity = capacity_;
+  if (capacity == 0 || index_->total_bytes() <= capacity) {
+    return;
+  }
+
+  // One evictor at a time, others find the budget already restored
+  std::lock_guard<std::mutex> eviction_lock(eviction_mutex_);
+  uint64_t target = static_cast<uint64_t>(capacity * EVICTION_TARGET);
+  if (index_->total_bytes() <= capacity) {
+    return;
+  }
+
+  // Consume the ranking of the last scan, so one index walk serves many
+  // evictions. Keys removed or stored locally since then are skipped
+  uint64_t used = index_->total_bytes();
+  size_t evicted = 0;
+  while (index_->total_bytes() > target) {
+    if (eviction_queue_.empty()) {
+      if (replica_writes_.exchange(0) == 0) {
+        break;
+      }
+      rank_replicas();
+      if (eviction_queue_.empty()) {
+        break;
+      }
+    }
+    std::string key = std::move(eviction_queue_.front());
+    eviction_queue_.pop_front();
+    evicted += evict_replica(key);
+  }
+  uint64_t freed = used - std::min(used, index_->total_bytes());
+
+  if (index_->total_bytes() > capacity) {
+    BOOST_LOG_TRIVIAL(warning) << "Store: Over capacity with " << index_->total_bytes() << " of " << capacity
+                               << " bytes after evicting every replica, the rest is local data";
+  }
+  BOOST_LOG_TRIVIAL(info) << "Store: Evicted " << evicted << " replicas freeing " << freed << " bytes";
+}
+
+void Store::rank_replicas() {
+  struct Candidate {
+    std::string key;
+    uint32_t score;
+    uint64_t last_access;
+  };
+  std::vector<Candidate> candidates;
+  index_->for_each([&](const std::string& key, const IndexEntry& entry) {
+    if (entry.flags & INDEX_FLAG_REPLICA) {
+      std::optional<AccessStats> stats = access_.lookup(key);
+      candidates.push_back(Candidate{key, access_.score(stats), stats ? stats->last_access : 0});
+    }
+  });
+  std::sort(candidates.begin(), candidates.end(), [](const Candidate& a, const Candidate& b) {
+    return a.score != b.score ? a.score < b.score : a.last_access < b.last_access;
+  });
+
+  eviction_queue_.clear();
+  for (auto& candidate : candidates) {
+    eviction_queue_.push_back(std::move(candidate.key));
+  }
+  BOOST_LOG_TRIVIAL(debug) << "Store: Ranked " << eviction_queue_.size() << " replicas for eviction";
+}
+
+bool Store::evict_replica(const std::string& key) {
+  std::string hash = lookup_hash(key);
+  auto lock = locks_.lock_exclusive(hash);
+
+  // The key may have been removed or stored locally since it was ranked
+  std::optional<IndexEntry> entry = index_->lookup(key);
+  if (!entry || !(entry->flags & INDEX_FLAG_REPLICA)) {
+    return false;
+  }
+  remove_object(hash, entry->flags);
+  index_->erase(key);
+  cache_.invalidate(key);
+  access_.forget(key);
+  evictions_++;
+  BOOST_LOG_TRIVIAL(debug) << "Store: Evicted replica with key: " << key;
+  return true;
+}
+
+
+//==============================================
+// ASYNC I/O SUPPORT
+//==============================================
+
+void Store::continue_async_read(const std::shared_ptr<AsyncRead>& request) const {
+  if (request->filled == request->buffer.size()) {
+    ring_->close(request->fd);
+    request->fd = -1;
+    if (request->checksum &&
+        Crc32c::compute(request->buffer.data(), request->buffer.size()) != *request->checksum) {
+      record_corruption(request->key);
+      fail_async_read(request, "Store: Checksum mismatch for key: " + request->key);
+      return;
+    }
+    request->grant.release();
+    ObjectViewPtr view = ObjectView::from_buffer(std::move(request->buffer));
+    cache_.insert(request->key, view, request->ticket);
+    request->promise.set_value(view);
+    return;
+  }
+
+  // A single read is limited to what the SQE length field can express
+  size_t length = std::min<size_t>(request->buffer.size() - request->filled, 1u << 30);
+  ring_->read(request->fd, request->buffer.data() + request->filled, length, request->filled,
+              [this, request](int n) {
+    if (n < 0) {
+      fail_async_read(request, "Store: Failed to read file: " + request->key);
+      return;
+    }
+    if (n == 0) {
+      request->buffer.resize(request->filled);  // Unexpected end of file
+    }
+    request->filled += static_cast<size_t>(n);
+    continue_async_read(request);
+  });
+}
+
+void Store::fail_async_read(const std::shared_ptr<AsyncRead>& request, const std::string& message) const {
+  BOOST_LOG_TRIVIAL(error) << message;
+  if (request->fd >= 0) {
+    ring_->close(request->fd);
+  }
+  request->grant.release();
+  request->promise.set_exception(std::make_exception_ptr(StoreError(message)));
+}
+
+size_t Store::write_stream_async(int fd, std::istream& data, IoClass io_class, uint32_t& checksum) {
+  std::vector<std::vector<char>> buffers(RING_WRITE_DEPTH, std::vector<char>(RING_BUFFER_SIZE));
+  std::vector<std::future<int>> pending(RING_WRITE_DEPTH);
+  std::vector<size_t> lengths(RING_WRITE_DEPTH);
+  std::vector<uint64_t> offsets(RING_WRITE_DEPTH);
+
+  // Waits for a slot's write, finishing a short write synchronously
+  auto complete = [&](size_t slot) {
+    if (!pending[slot].valid()) {
+      return;
+    }
+    int n = pending[slot].get();
+    size_t done = 0;
+    while (n > 0 && (done += static_cast<size_t>(n)) < lengths[slot]) {
+      n = ring_->write(fd, buffers[slot].data() + done, lengths[slot] - done, offsets[slot] + done).get();
+    }
+    if (n <= 0) {
+      throw StoreError("Store: Failed to write data");
+    }
+  };
+
+  size_t bytes_written = 0;
+  size_t slot = 0;
+  try {
+    // Refill each buffer once its previous write completed while the others are in flight
+    while (true) {
+      complete(slot);
+      data.read(buffers[slot].data(), RING_BUFFER_SIZE);
+      size_t count = static_cast<size_t>(data.gcount());
+      if (count == 0) {
+        break;
+      }
+      checksum = Crc32c::update(checksum, buffers[slot].data(), count);
+      lengths[slot] = count;
+      offsets[slot] = bytes_written;
+      // The completion thread releases the grant, so waiting for the next one
+      // never depends on this thread finishing its earlier writes
+      auto grant = std::make_shared<IoScheduler::Grant>(scheduler_.acquire(io_class, count));
+      pending[slot] = ring_->write(fd, buffers[slot].data(), count, bytes_written,
+                                   [grant](int) { grant->release(); });
+      bytes_written += count;
+      slot = (slot + 1) % RING_WRITE_DEPTH;
+    }
+    for (size_t i = 0; i < RING_WRITE_DEPTH; ++i) {
+      complete(i);
+    }
+  } catch (...) {
+    // Buffers must outlive the writes still owned by the kernel
+    for (auto& write : pending) {
+      if (write.valid()) {
+        write.wait();
+      }
+    }
+    throw;
+  }
+
+  if (data.bad()) {
+    throw StoreError("Store: Failed to read input stream");
+  }
+  return bytes_written;
+}
+
+
+//==============================================
+// PACKED STORAGE SUPPORT
+//==============================================
+
+bool Store::read_small_object(std::istream& data, std::vector<char>& buffer) const {
+  // Unseekable streams cannot be rewound and always take the file layout
+  std::streampos start = data.tellg();
+  if (start == std::streampos(-1)) {
+    return false;
+  }
+
+  buffer.resize(PackStore::MAX_OBJECT_SIZE + 1);
+  data.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+  buffer.resize(static_cast<size_t>(data.gcount()));
+  if (data.bad()) {
+    throw StoreError("Store: Failed to read input stream");
+  }
+  if (buffer.size() <= PackStore::MAX_OBJECT_SIZE) {
+    return true;
+  }
+
+  data.clear();
+  data.seekg(start);
+  return false;
+}
+
+void Store::open_pack_store() {
+  std::filesystem::path pack_path = base_path_ / PACK_DIRECTORY;
+  if (!pack_ && (packing_enabled_ || std::filesystem::exists(pack_path))) {
+    pack_ = std::make_unique<PackStore>(pack_path, &scheduler_);
+  }
+}
+
+bool Store::remove_object(const std::string& hash, uint32_t flags) {
+  if (flags & INDEX_FLAG_PACKED) {
+    return pack_ && pack_->remove(hash);
+  }
+  uint32_t volume = flags >> INDEX_VOLUME_SHIFT;
+  return bury(get_path_for_hash(hash, volume), volume);
+}
+
+
+//==============================================
+// DURABLE WRITE SUPPORT
+//==============================================
+
+size_t Store::write_stream(int fd, std::istream& data, IoClass io_class, uint32_t& checksum) {
+  if (ring_) {
+    return write_stream_async(fd, data, io_class, checksum);
+  }
+
+  size_t bytes_written = 0;
+  char buffer[65536];
+
+  // Read input stream in chunks and write to file, including the final partial chunk
+  while (data.read(buffer, sizeof(buffer)) || data.gcount() > 0) {
+    checksum = Crc32c::update(checksum, buffer, static_cast<size_t>(data.gcount()));
+    auto grant = scheduler_.acquire(io_class, static_cast<uint64_t>(data.gcount()));
+    if (!io::write_all(fd, buffer, static_cast<size_t>(data.gcount()))) {
+      throw StoreError("Store: Failed to write data");
+    }
+    bytes_written += data.gcount();
+  }
+  if (data.bad()) {
+    throw StoreError("Store: Failed to read input stream");
+  }
+  return bytes_written;
+}
+
+void Store::publish_temp_file(const std::string& key, const std::string& hash, int fd,
+                              const std::filesystem::path& temp_path, size_t size, uint32_t flags,
+                              ObjectOrigin origin, uint32_t checksum) {
+  std::optional<IndexEntry> previous = index_->lookup(key);
+  flags |= origin_flags(previous, origin);
+
+  // Publish the object and record it in the index once it is in place
+  uint32_t volume = flags >> INDEX_VOLUME_SHIFT;
+  commit_temp_file(fd, temp_path, get_path_for_hash(hash, volume), [this, key, hash, size, flags, checksum] {
+    index_object(key, hash, size, flags, checksum);
+  }).get();
+  if (previous && ((previous->flags & INDEX_FLAG_PACKED) || previous->volume() != volume)) {
+    remove_object(hash, previous->flags);
+  }
+  cache_.invalidate(key);
+}
+
+void Store::publish_written_object(const std::string& key, const std::string& hash, int fd,
+                                   const std::filesystem::path& temp_path, size_t size, uint32_t volume,
+                                   ObjectOrigin origin, uint32_t checksum) {
+  {
+    auto lock = locks_.lock_exclusive(hash);
+    publish_temp_file(key, hash, fd, temp_path, size, volume << INDEX_VOLUME_SHIFT, origin, checksum);
+  }
+  access_.record(key);
+  enforce_capacity();
+}
+
+int Store::open_temp_file(const std::filesystem::path& final_path, std::filesystem::path& temp_path) const {
+  // Process id plus a process-wide counter keeps names unique across threads and stores
+  static std::atomic<uint64_t> temp_counter{0};
+  temp_path = final_path;
+  temp_path += TEMP_SUFFIX + std::to_string(::getpid()) + "." + std::to_string(temp_counter++);
+
+  // The reclaimer may prune the fan-out directory after it was checked, and
+  // again after it was recreated, so retry for as long as it goes missing
+  int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  while (fd < 0 && errno == ENOENT) {
+    std::filesystem::create_directories(temp_path.parent_path());
+    fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, 0644);
+  }
+  if (fd < 0) {
+    BOOST_LOG_TRIVIAL(error) << "Store: Failed to create file: " << temp_path.string();
+    throw StoreError("Store: Failed to create file: " + temp_path.string());
+  }
+  return fd;
+}
+
+std::future<void> Store::commit_temp_file(int fd, const std::filesystem::path& temp_path,
+                                          const std::filesystem::path& final_path,
+                                          std::function<void()> on_commit) {
+  if (durability_ == Durability::GroupCommit) {
+    return committer_->submit(fd, temp_path, final_path, std::move(on_commit));
+  }
+
+  // Atomic mode publishes immediately and leaves flushing to the kernel
+  ::close(fd);
+  std::error_code ec;
+  std::filesystem::rename(temp_path, final_path, ec);
+  if (ec) {
+    std::filesystem::remove(temp_path, ec);
+    throw StoreError("Store: Failed to publish file: " + final_path.string());
+  }
+  if (on_commit) {
+    on_commit();
+  }
+  std::promise<void> done;
+  done.set_value();
+  return done.get_future();
+}
+
+
+//==============================================
+// UTILITY METHODS 
+//==============================================
+  
+void Store::check_directory_exists(const std::filesystem::path& path) const {
+  if (!std::filesystem::exists(path)) {
+    std::filesystem::create_directories(path);
+  }
+}
+
+bool Store::is_orphaned_temp_file(const std::filesystem::path& path) const {
+  // Temp names end in TEMP_SUFFIX, the writer's pid and a counter
+  std::string name = path.filename().string();
+  size_t start = name.rfind(TEMP_SUFFIX);
+  if (start == std::string::npos) {
+    return false;
+  }
+  start += sizeof(TEMP_SUFFIX) - 1;
+  pid_t pid = static_cast<pid_t>(std::strtol(name.c_str() + start, nullptr, 10));
+  return pid <= 0 || (::kill(pid, 0) != 0 && errno == ESRCH);
+}
+
+std::string Store::lookup_hash(const std::string& key) const {
+  if (std::optional<IndexEntry> entry = index_->lookup(key)) {
+    return entry->hash;
+  }
+  return hash_key(key);
+}
+
+IndexEntry Store::lookup_entry(const std::string& key) const {
+  std::optional<IndexEntry> entry = index_->lookup(key);
+  if (!entry && !index_->is_authoritative()) {
+    entry = learn_object(key);
+  }
+  if (!entry) {
+    BOOST_LOG_TRIVIAL(error) << "Store: File not found for key: " << key;
+    throw StoreError("Store: File not found");
+  }
+  return *entry;
+}
+
+void Store::index_object(const std::string& key, const std::string& hash, 
+                         std::uintmax_t size, uint32_t flags, uint32_t checksum) {
+  IndexEntry entry;
+  entry.hash = hash;
+  entry.size = size;
+  entry.mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::system_clock::now().time_since_epoch()).count();
+  entry.flags = flags | INDEX_FLAG_CHECKSUM;
+  entry.checksum = checksum;
+  index_->put(key, entry);
+  if (flags & INDEX_FLAG_REPLICA) {
+    replica_writes_++;
+  }
+
+  // New content supersedes a corrupt copy
+  if (corruptions_ > 0) {
+    std::lock_guard<std::mutex> lock(corrupt_mutex_);
+    corrupt_keys_.erase(key);
+  }
+}
+
+std::optional<IndexEntry> Store::learn_object(const std::string& key) const {
+  std::string hash = hash_key(key);
+
+  // Packed objects are found through the pack store's own map
+  if (std::optional<uint64_t> packed_size = pack_ ? pack_->size_of(hash) : std::nullopt) {
+    IndexEntry entry;
+    entry.hash = hash;
+    entry.size = *packed_size;
+    entry.flags = INDEX_FLAG_PACKED;
+    index_->put(key, entry);
+    return entry;
+  }
+  std::optional<uint32_t> volume = find_volume(hash);
+  if (!volume) {
+    return std::nullopt;
+  }
+  std::filesystem::path file_path = get_path_for_hash(hash, *volume);
+
+  IndexEntry entry;
+  entry.hash = hash;
+  entry.flags = *volume << INDEX_VOLUME_SHIFT;
+  entry.size = std::filesystem::file_size(file_path);
+  entry.mtime = std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::filesystem::last_write_time(file_path).time_since_epoch()).count();
+
+  // Objects written before the index existed may still be chunk manifests.
+  // Compressed objects are always indexed, so content is never sniffed for them
+  std::ifstream file(file_path, std::ios::binary);
+  Manifest manifest;
+  if (file && read_manifest(file, manifest)) {
+    entry.size = manifest.total_size;
+    entry.flags |= INDEX_FLAG_CHUNKED;
+  }
+
+  BOOST_LOG_TRIVIAL(debug) << "Store: Indexed existing object for key: " << key;
+  index_->put(key, entry);
+  return entry;
+}
+
+void Store::check_range(const std::string& key, std::uintmax_t offset, std::uintmax_t size) const {
+  if (offset > size) {
+    BOOST_LOG_TRIVIAL(error) << "Store: Range offset " << offset << " past end of key: " << key;
+    throw StoreError("Store: Range offset past end of object");
+  }
 }
 
 void Store::verify_file_exists(const std::filesystem::path& file_path) const {
@@ -0,0 +1,459 @@
+#include "store/store_index.hpp"
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <boost/log/trivial.hpp>
+#include "store/posix_io.hpp"
+#include "store/store.hpp"
+
+namespace dfs {
+namespace store {
+
+namespace {
+
+constexpr char SNAPSHOT_MAGIC[8] = {'D', 'F', 'S', 'I', 'D', 'X', '0', '2'};
+// Snapshots before the header flags never recorded a scan, so they load as non-authoritative
+constexpr char LEGACY_SNAPSHOT_MAGIC[8] = {'D', 'F', 'S', 'I', 'D', 'X', '0', '1'};
+constexpr uint32_t SNAPSHOT_FLAG_AUTHORITATIVE = 1u << 0;
+constexpr uint8_t JOURNAL_PUT = 1;
+constexpr uint8_t JOURNAL_ERASE = 2;
+// key length, hash length, size, mtime, flags. Entries with a checksum
+// append it after the hash, so records written before checksums still decode
+constexpr size_t RECORD_HEADER_SIZE = 4 + 4 + 8 + 8 + 4;
+
+template<typename T>
+void append_value(std::string& out, T value) {
+  out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+template<typename T>
+T read_value(const char* data) {
+  T value;
+  std::memcpy(&value, data, sizeof(value));
+  return value;
+}
+
+} // namespace
+
+//==============================================
+// CONSTRUCTOR AND DESTRUCTOR
+//==============================================
+
+StoreIndex::StoreIndex(const std::filesystem::path& directory) : directory_(directory) {
+  BOOST_LOG_TRIVIAL(info) << "Store index: Loading index from: " << directory_;
+
+  bool has_snapshot = std::filesystem::exists(directory_ / SNAPSHOT_FILENAME);
+  bool has_journal = std::filesystem::exists(directory_ / JOURNAL_FILENAME);
+
+  // A fresh directory holds nothing the index could miss. Otherwise only a
+  // snapshot written after a complete scan proves the index covers every object
+  bool fresh = !has_snapshot && !has_journal && std::filesystem::is_empty(directory_);
+  authoritative_ = fresh;
+
+  load_snapshot();
+  replay_journal();
+  for_each([this](const std::string& key, const IndexEntry& entry) {
+    total_bytes_ += entry.size;
+    count_file_bytes(entry, true);
+    catalog_.insert(key);
+  });
+
+  // Fold replayed records into a fresh snapshot, which also drops any torn
+  // tail. A fresh index persists its authoritative state right away
+  if (fresh || (has_journal && std::filesystem::file_size(directory_ / JOURNAL_FILENAME) > 0)) {
+    write_snapshot();
+  } else {
+    open_journal(false);
+  }
+
+  BOOST_LOG_TRIVIAL(info) << "Store index: Loaded " << size() << " entries"
+                          << (authoritative_ ? "" : " (non-authoritative, falling back to filesystem)");
+}
+
+StoreIndex::~StoreIndex() {
+  try {
+    compact();
+  } catch (const std::exception& e) {
+    BOOST_LOG_TRIVIAL(error) << "Store index: Failed to write snapshot on shutdown: " << e.what();
+  }
+  if (journal_fd_ >= 0) {
+    ::close(journal_fd_);
+  }
+}
+
+
+//==============================================
+// INDEX OPERATIONS
+//==============================================
+
+std::optional<IndexEntry> StoreIndex::lookup(const std::string& key) const {
+  const Shard& shard = shard_for(key);
+  std::shared_lock<std::shared_mutex> lock(shard.mutex);
+  auto it = shard.entries.find(key);
+  if (it == shard.entries.end()) {
+    return std::nullopt;
+  }
+  return it->second;
+}
+
+void StoreIndex::put(const std::string& key, const IndexEntry& entry) {
+  // The journal lock orders map updates with their journal records
+  std::lock_guard<std::mutex> journal_lock(journal_mutex_);
+  {
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    IndexEntry& slot = shard.entries[key];
+    total_bytes_ += entry.size - slot.size;
+    count_file_bytes(slot, false);
+    count_file_bytes(entry, true);
+    slot = entry;
+  }
+  {
+    std::unique_lock<std::shared_mutex> lock(catalog_mutex_);
+    catalog_.insert(key);
+  }
+  append_journal(JOURNAL_PUT, key, entry);
+}
+
+void StoreIndex::erase(const std::string& key) {
+  std::lock_guard<std::mutex> journal_lock(journal_mutex_);
+  {
+    Shard& shard = shard_for(key);
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    auto it = shard.entries.find(key);
+    if (it == shard.entries.end()) {
+      return;
+    }
+    total_bytes_ -= it->second.size;
+    count_file_bytes(it->second, false);
+    shard.entries.erase(it);
+  }
+  {
+    std::unique_lock<std::shared_mutex> lock(catalog_mutex_);
+    catalog_.erase(key);
+  }
+  append_journal(JOURNAL_ERASE, key, IndexEntry{});
+}
+
+void StoreIndex::clear() {
+  std::lock_guard<std::mutex> journal_lock(journal_mutex_);
+  for (auto& shard : shards_) {
+    std::unique_lock<std::shared_mutex> lock(shard.mutex);
+    shard.entries.clear();
+  }
+  {
+    std::unique_lock<std::shared_mutex> lock(catalog_mutex_);
+    catalog_.clear();
+  }
+  total_bytes_ = 0;
+  for (auto& bytes : file_bytes_) {
+    bytes = 0;
+  }
+  authoritative_ = true;
+  write_snapshot();
+}
+
+void StoreIndex::compact() {
+  std::lock_guard<std::mutex> journal_lock(journal_mutex_);
+  write_snapshot();
+}
+
+void StoreIndex::set_authoritative(bool authoritative) {
+  std::lock_guard<std::mutex> journal_lock(journal_mutex_);
+  if (authoritative_ != authoritative) {
+    authoritative_ = authoritative;
+    write_snapshot();
+  }
+}
+
+void StoreIndex::sync() {
+  std::lock_guard<std::mutex> journal_lock(journal_mutex_);
+  if (journal_fd_ >= 0 && ::fdatasync(journal_fd_) != 0) {
+    throw StoreError("Store index: Failed to sync journal");
+  }
+}
+
+void StoreIndex::for_each(const std::function<void(const std::string&, const IndexEntry&)>& visit) const {
+  for (const auto& shard : shards_) {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    for (const auto& [key, entry] : shard.entries) {
+      visit(key, entry);
+    }
+  }
+}
+
+ListPage StoreIndex::list(const std::string& prefix, const std::string& cursor, size_t limit) const {
+  ListPage page;
+  if (limit == 0) {
+    return page;
+  }
+
+  // Collect one name beyond the page to learn whether another page follows
+  std::vector<std::string> names;
+  {
+    std::shared_lock<std::shared_mutex> lock(catalog_mutex_);
+    auto it = cursor > prefix ? catalog_.upper_bound(cursor) : catalog_.lower_bound(prefix);
+    for (; it != catalog_.end() && names.size() <= limit && it->starts_with(prefix); ++it) {
+      names.push_back(*it);
+    }
+  }
+
+  bool more = names.size() > limit;
+  if (more) {
+    names.pop_back();
+    page.next_cursor = names.back();
+  }
+
+  // A name erased since the catalog was read is skipped
+  page.entries.reserve(names.size());
+  for (auto& name : names) {
+    if (auto entry = lookup(name)) {
+      page.entries.push_back(ListEntry{std::move(name), entry->size, entry->mtime});
+    }
+  }
+  return page;
+}
+
+
+//==============================================
+// GETTERS
+//==============================================
+
+std::size_t StoreIndex::size() const {
+  std::size_t total = 0;
+  for (const auto& shard : shards_) {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    total += shard.entries.size();
+  }
+  return total;
+}
+
+
+//==============================================
+// PERSISTENCE
+//==============================================
+
+void StoreIndex::write_snapshot() {
+  std::string buffer(SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC));
+  uint64_t count = 0;
+  append_value(buffer, count);
+  append_value<uint32_t>(buffer, authoritative_ ? SNAPSHOT_FLAG_AUTHORITATIVE : 0);
+  for (const auto& shard : shards_) {
+    std::shared_lock<std::shared_mutex> lock(shard.mutex);
+    for (const auto& [key, entry] : shard.entries) {
+      encode_record(buffer, key, entry);
+      ++count;
+    }
+  }
+  std::memcpy(buffer.data() + sizeof(SNAPSHOT_MAGIC), &count, sizeof(count));
+
+  // Write beside the snapshot and rename so a crash never leaves a torn snapshot
+  std::filesystem::path snapshot_path = directory_ / SNAPSHOT_FILENAME;
+  std::filesystem::path temp_path = snapshot_path;
+  temp_path += ".tmp";
+  int fd = ::open(temp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    throw StoreError("Store index: Failed to create snapshot: " + temp_path.string());
+  }
+  bool written = io::write_all(fd, buffer.data(), buffer.size()) && ::fsync(fd) == 0;
+  ::close(fd);
+  if (!written) {
+    throw StoreError("Store index: Failed to write snapshot: " + temp_path.string());
+  }
+  std::filesystem::rename(temp_path, snapshot_path);
+
+  // The journal may only be truncated once the renamed snapshot is durable
+  int dir_fd = ::open(directory_.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  bool synced = dir_fd >= 0 && ::fsync(dir_fd) == 0;
+  if (dir_fd >= 0) {
+    ::close(dir_fd);
+  }
+  if (!synced) {
+    throw StoreError("Store index: Failed to sync snapshot directory: " + directory_.string());
+  }
+
+  snapshot_records_ = count;
+  open_journal(true);
+  BOOST_LOG_TRIVIAL(debug) << "Store index: Compacted " << count << " entries into snapshot";
+}
+
+void StoreIndex::load_snapshot() {
+  std::filesystem::path snapshot_path = directory_ / SNAPSHOT_FILENAME;
+  int fd = ::open(snapshot_path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return;
+  }
+
+  struct stat st;
+  if (::fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(SNAPSHOT_MAGIC) + sizeof(uint64_t) + sizeof(uint32_t))) {
+    ::close(fd);
+    BOOST_LOG_TRIVIAL(warning) << "Store index: Ignoring truncated snapshot";
+    authoritative_ = false;
+    return;
+  }
+
+  size_t length = static_cast<size_t>(st.st_size);
+  void* addr = ::mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if (addr == MAP_FAILED) {
+    throw StoreError("Store index: Failed to map snapshot: " + snapshot_path.string());
+  }
+
+  const char* data = static_cast<const char*>(addr);
+  bool legacy = std::memcmp(data, LEGACY_SNAPSHOT_MAGIC, sizeof(LEGACY_SNAPSHOT_MAGIC)) == 0;
+  if (!legacy && std::memcmp(data, SNAPSHOT_MAGIC, sizeof(SNAPSHOT_MAGIC)) != 0) {
+    ::munmap(addr, length);
+    BOOST_LOG_TRIVIAL(warning) << "Store index: Ignoring snapshot with unknown format";
+    authoritative_ = false;
+    return;
+  }
+
+  uint64_t count = read_value<uint64_t>(data + sizeof(SNAPSHOT_MAGIC));
+  size_t offset = sizeof(SNAPSHOT_MAGIC) + sizeof(uint64_t);
+  authoritative_ = false;
+  if (!legacy) {
+    authoritative_ = (read_value<uint32_t>(data + offset) & SNAPSHOT_FLAG_AUTHORITATIVE) != 0;
+    offset += sizeof(uint32_t);
+  }
+  for (uint64_t i = 0; i < count; ++i) {
+    std::string key;
+    IndexEntry entry;
+    size_t consumed = decode_record(data + offset, length - offset, key, entry);
+    if (consumed == 0) {
+      BOOST_LOG_TRIVIAL(warning) << "Store index: Snapshot truncated after " << i << " entries";
+      authoritative_ = false;
+      break;
+    }
+    shard_for(key).entries[key] = std::move(entry);
+    offset += consumed;
+    ++snapshot_records_;
+  }
+  ::munmap(addr, length);
+}
+
+void StoreIndex::replay_journal() {
+  std::filesystem::path journal_path = directory_ / JOURNAL_FILENAME;
+  std::ifstream file(journal_path, std::ios::binary);
+  if (!file) {
+    return;
+  }
+  std::string data((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+
+  size_t offset = 0;
+  while (offset < data.size()) {
+    uint8_t op = static_cast<uint8_t>(data[offset]);
+    std::string key;
+    IndexEntry entry;
+    size_t consumed = decode_record(data.data() + offset + 1, data.size() - offset - 1, key, entry);
+    if (consumed == 0 || (op != JOURNAL_PUT && op != JOURNAL_ERASE)) {
+      // A torn tail record is expected after a crash and simply dropped
+      BOOST_LOG_TRIVIAL(warning) << "Store index: Dropping incomplete journal tail at offset " << offset;
+      break;
+    }
+    if (op == JOURNAL_PUT) {
+      shard_for(key).entries[key] = std::move(entry);
+    } else {
+      shard_for(key).entries.erase(key);
+    }
+    offset += 1 + consumed;
+    ++journal_records_;
+  }
+}
+
+void StoreIndex::open_journal(bool truncate) {
+  if (journal_fd_ >= 0) {
+    ::close(journal_fd_);
+  }
+  std::filesystem::path journal_path = directory_ / JOURNAL_FILENAME;
+  int flags = O_WRONLY | O_CREAT | O_APPEND | O_CLOEXEC | (truncate ? O_TRUNC : 0);
+  journal_fd_ = ::open(journal_path.c_str(), flags, 0644);
+  if (journal_fd_ < 0) {
+    throw StoreError("Store index: Failed to open journal: " + journal_path.string());
+  }
+  if (truncate) {
+    journal_records_ = 0;
+  }
+}
+
+void StoreIndex::append_journal(uint8_t op, const std::string& key, const IndexEntry& entry) {
+  std::string record(1, static_cast<char>(op));
+  encode_record(record, key, entry);
+  if (!io::write_all(journal_fd_, record.data(), record.size())) {
+    BOOST_LOG_TRIVIAL(error) << "Store index: Failed to append journal record for key: " << key;
+    throw StoreError("Store index: Failed to append journal record");
+  }
+
+  ++journal_records_;
+  if (journal_records_ >= COMPACT_THRESHOLD && journal_records_ * COMPACT_RATIO >= snapshot_records_) {
+    write_snapshot();
+  }
+}
+
+size_t StoreIndex::decode_record(const char* data, size_t length, std::string& key, IndexEntry& entry) {
+  if (length < RECORD_HEADER_SIZE) {
+    return 0;
+  }
+  uint32_t key_length = read_value<uint32_t>(data);
+  uint32_t hash_length = read_value<uint32_t>(data + 4);
+  if (length < RECORD_HEADER_SIZE + key_length + hash_length) {
+    return 0;
+  }
+  entry.size = read_value<uint64_t>(data + 8);
+  entry.mtime = read_value<int64_t>(data + 16);
+  entry.flags = read_value<uint32_t>(data + 24);
+  size_t record_size = RECORD_HEADER_SIZE + key_length + hash_length;
+  if (entry.flags & INDEX_FLAG_CHECKSUM) {
+    if (length < record_size + sizeof(uint32_t)) {
+      return 0;
+    }
+    entry.checksum = read_value<uint32_t>(data + record_size);
+    record_size += sizeof(uint32_t);
+  }
+  key.assign(data + RECORD_HEADER_SIZE, key_length);
+  entry.hash.assign(data + RECORD_HEADER_SIZE + key_length, hash_length);
+  return record_size;
+}
+
+void StoreIndex::encode_record(std::string& out, const std::string& key, const IndexEntry& entry) {
+  append_value<uint32_t>(out, static_cast<uint32_t>(key.size()));
+  append_value<uint32_t>(out, static_cast<uint32_t>(entry.hash.size()));
+  append_value<uint64_t>(out, static_cast<uint64_t>(entry.size));
+  append_value<int64_t>(out, entry.mtime);
+  append_value<uint32_t>(out, entry.flags);
+  out += key;
+  out += entry.hash;
+  if (entry.flags & INDEX_FLAG_CHECKSUM) {
+    append_value<uint32_t>(out, entry.checksum);
+  }
+}
+
+
+//==============================================
+// UTILITY METHODS
+//==============================================
+
+void StoreIndex::count_file_bytes(const IndexEntry& entry, bool add) {
+  if (entry.flags & (INDEX_FLAG_CHUNKED | INDEX_FLAG_PACKED)) {
+    return;
+  }
+  if (add) {
+    file_bytes_[entry.volume()] += entry.size;
+  } else {
+    file_bytes_[entry.volume()] -= entry.size;
+  }
+}
+
+StoreIndex::Shard& StoreIndex::shard_for(const std::string& key) {
+  return shards_[std::hash<std::string>{}(key) % SHARD_COUNT];
+}
+
+const StoreIndex::Shard& StoreIndex::shard_for(const std::string& key) const {
+  return shards_[std::hash<std::string>{}(key) % SHARD_COUNT];
+}
+
+} // namespace store
+} // namespace dfs
@@ -0,0 +1,200 @@
+#include "store/store_scanner.hpp"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include <boost/log/trivial.hpp>
+
+namespace dfs {
+namespace store {
+
+//==============================================
+// CONSTRUCTOR AND DESTRUCTOR
+//==============================================
+
+StoreScanner::StoreScanner(const std::vector<std::filesystem::path>& roots, const std::string& temp_marker,
+                           const std::string& chunk_extension, const std::vector<std::string>& skip_directories,
+                           size_t thread_count)
+  : roots_(roots)
+  , temp_marker_(temp_marker)
+  , chunk_extension_(chunk_extension)
+  , skip_directories_(skip_directories)
+  , thread_count_(thread_count ? thread_count : std::max(1u, std::thread::hardware_concurrency())) {
+  for (size_t i = 0; i < thread_count_; ++i) {
+    workers_.push_back(std::make_unique<Worker>());
+  }
+}
+
+
+//==============================================
+// SCAN OPERATIONS
+//==============================================
+
+ScanReport StoreScanner::scan() {
+  auto start = std::chrono::steady_clock::now();
+
+  // Seed the roots round-robin so every device is read from the start
+  for (uint32_t volume = 0; volume < roots_.size(); ++volume) {
+    push_task(volume % thread_count_, Task{roots_[volume], 0, volume, ""});
+  }
+  std::vector<std::thread> threads;
+  for (size_t i = 1; i < thread_count_; ++i) {
+    threads.emplace_back(&StoreScanner::run_worker, this, i);
+  }
+  run_worker(0);
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Merge the per-worker results
+  ScanReport report;
+  for (auto& worker : workers_) {
+    ScanReport& part = worker->report;
+    report.directories += part.directories;
+    report.objects += part.objects;
+    report.object_bytes += part.object_bytes;
+    report.chunks += part.chunks;
+    report.chunk_bytes += part.chunk_bytes;
+    report.object_hashes.insert(report.object_hashes.end(),
+                                std::make_move_iterator(part.object_hashes.begin()),
+                                std::make_move_iterator(part.object_hashes.end()));
+    report.object_volumes.insert(report.object_volumes.end(), part.object_volumes.begin(),
+                                 part.object_volumes.end());
+    report.temp_files.insert(report.temp_files.end(), part.temp_files.begin(), part.temp_files.end());
+    report.empty_directories.insert(report.empty_directories.end(),
+                                    part.empty_directories.begin(), part.empty_directories.end());
+    part = ScanReport{};
+  }
+  report.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  BOOST_LOG_TRIVIAL(debug) << "Store scanner: Walked " << report.directories << " directories with "
+                           << thread_count_ << " threads in " << report.seconds << "s";
+  return report;
+}
+
+
+//==============================================
+// WORK DISTRIBUTION
+//==============================================
+
+void StoreScanner::run_worker(size_t id) {
+  Task task;
+  while (true) {
+    if (pop_task(id, task) || steal_task(id, task)) {
+      try {
+        process_directory(id, task);
+      } catch (const std::exception& e) {
+        BOOST_LOG_TRIVIAL(warning) << "Store scanner: Failed to scan " << task.directory.string()
+                                   << ": " << e.what();
+      }
+      if (--pending_ == 0) {
+        notify_idle(true);
+      }
+      continue;
+    }
+
+    // Sleep until a busy worker queues a directory or the last one is done
+    std::unique_lock<std::mutex> lock(idle_mutex_);
+    idle_cv_.wait(lock, [this] { return pending_ == 0 || queued_ > 0; });
+    if (pending_ == 0) {
+      return;
+    }
+  }
+}
+
+void StoreScanner::notify_idle(bool all) {
+  // Taking the mutex orders the notification after a waiter's predicate check
+  { std::lock_guard<std::mutex> lock(idle_mutex_); }
+  if (all) {
+    idle_cv_.notify_all();
+  } else {
+    idle_cv_.notify_one();
+  }
+}
+
+void StoreScanner::push_task(size_t id, Task task) {
+  pending_++;
+  {
+    std::lock_guard<std::mutex> lock(workers_[id]->mutex);
+    workers_[id]->tasks.push_back(std::move(task));
+  }
+  queued_++;
+  notify_idle(false);
+}
+
+bool StoreScanner::pop_task(size_t id, Task& task) {
+  Worker& worker = *workers_[id];
+  std::lock_guard<std::mutex> lock(worker.mutex);
+  if (worker.tasks.empty()) {
+    return false;
+  }
+  task = std::move(worker.tasks.back());
+  worker.tasks.pop_back();
+  queued_--;
+  return true;
+}
+
+bool StoreScanner::steal_task(size_t id, Task& task) {
+  // Steal the oldest, shallowest directory so each theft carries the most work
+  for (size_t offset = 1; offset < thread_count_; ++offset) {
+    Worker& victim = *workers_[(id + offset) % thread_count_];
+    std::lock_guard<std::mutex> lock(victim.mutex);
+    if (!victim.tasks.empty()) {
+      task = std::move(victim.tasks.front());
+      victim.tasks.pop_front();
+      queued_--;
+      return true;
+    }
+  }
+  return false;
+}
+
+
+//==============================================
+// DIRECTORY PROCESSING
+//==============================================
+
+void StoreScanner::process_directory(size_t id, const Task& task) {
+  ScanReport& report = workers_[id]->report;
+  report.directories++;
+
+  size_t entries = 0;
+  for (const auto& entry : std::filesystem::directory_iterator(task.directory)) {
+    entries++;
+    std::string name = entry.path().filename().string();
+
+    if (entry.is_directory()) {
+      if (task.depth == 0 &&
+          std::find(skip_directories_.begin(), skip_directories_.end(), name) != skip_directories_.end()) {
+        continue;
+      }
+      if (task.depth + 1 < StoreScanner::OBJECT_DEPTH) {
+        push_task(id, Task{entry.path(), task.depth + 1, task.volume, task.hash_prefix + name});
+      }
+      continue;
+    }
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+
+    if (name.find(temp_marker_) != std::string::npos) {
+      report.temp_files.push_back(entry.path());
+    } else if (task.depth + 1 != OBJECT_DEPTH) {
+      continue;  // Index files and other metadata outside the fan-out tree
+    } else if (entry.path().extension() == chunk_extension_) {
+      report.chunks++;
+      report.chunk_bytes += entry.file_size();
+    } else {
+      report.objects++;
+      report.object_bytes += entry.file_size();
+      report.object_hashes.push_back(task.hash_prefix + name);
+      report.object_volumes.push_back(task.volume);
+    }
+  }
+
+  if (entries == 0 && task.depth > 0) {
+    report.empty_directories.push_back(task.directory);
+  }
+}
+
+} // namespace store
+} // namespace dfs
@@ -2,9 +2,11 @@
 #include <thread>
 #include <chrono>
 #include <sstream>
+#include <filesystem>
 #include "network/bootstrap.hpp"
 #include "network/peer_manager.hpp"
 #include "file_server/file_server.hpp"
+#include "crypto/cipher_benchmark.hpp"
 
 using namespace dfs::network;
 
@@ -38,10 +40,35 @@ protected:
   void TearDown() override {
     // First cleanup files while peers are still valid
     cleanup_all_files();
+    // Remember the store directories, the index and journal outlive clear()
+    std::vector<std::filesystem::path> store_dirs = collect_store_dirs();
     // Then shutdown peers
     shutdown_peers();
     // Sleep briefly to ensure file handles are released
     std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    remove_store_dirs(store_dirs);
+  }
+
+  std::vector<std::filesystem::path> collect_store_dirs() {
+    std::vector<std::filesystem::path> store_dirs;
+    for (const auto& peer : peers) {
+      if (peer && peer->bootstrap) {
+        for (const auto& volume : peer->bootstrap->get_file_server().get_store().get_volumes()) {
+          store_dirs.push_back(volume);
+        }
+      }
+    }
+    return store_dirs;
+  }
+
+  void remove_store_dirs(const std::vector<std::filesystem::path>& store_dirs) {
+    for (const auto& dir : store_dirs) {
+      std::error_code ec;
+      std::filesystem::remove_all(dir, ec);
+      if (ec) {
+        BOOST_LOG_TRIVIAL(error) << "Failed to remove store directory " << dir << ": " << ec.message();
+      }
+    }
   }
     
   void cleanup_all_files() {
@@ -301,4 +328,76 @@ TEST_F(BootstrapTest, LargeGetFile) {
 
   verify_peer_connections({peer1, peer2});
   verify_file_content("large_test.txt", file_content.str(), {peer1, peer2});
-}
\ No newline at end of file
+}
+
+TEST_F(BootstrapTest, RangedGetFile) {
+  auto peer1 = create_peer(1, 3001);
+  auto peer2 = create_peer(2, 3002, {ADDRESS + ":3001"});
+
+  start_peer(peer1);
+
+  auto file_content = create_large_file();
+  peer1->bootstrap->get_file_server().store_file("large_test.txt", file_content);
+  std::string expected = file_content.str();
+
+  start_peer(peer2);
+  std::this_thread::sleep_for(std::chrono::seconds(3));
+
+  // Request a block from the middle and the tail of the remote file
+  auto& file_server = peer2->bootstrap->get_file_server();
+  auto block = file_server.get_file_range("large_test.txt", 1024 * 1024, 4096);
+  ASSERT_TRUE(block.has_value());
+  EXPECT_EQ(*block, expected.substr(1024 * 1024, 4096));
+
+  auto tail = file_server.get_file_range("large_test.txt", expected.size() - 100, 1000);
+  ASSERT_TRUE(tail.has_value());
+  EXPECT_EQ(*tail, expected.substr(expected.size() - 100));
+
+  // A range past the end is answered at once with no bytes
+  auto start = std::chrono::steady_clock::now();
+  auto past_end = file_server.get_file_range("large_test.txt", expected.size() + 10, 100);
+  ASSERT_TRUE(past_end.has_value());
+  EXPECT_TRUE(past_end->empty());
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+
+  // Only the ranges crossed the network, the file itself was not copied
+  verify_peer_connections({peer1, peer2});
+  EXPECT_FALSE(file_server.get_store().has("large_test.txt"));
+  EXPECT_FALSE(file_server.get_file_range("missing.txt", 0, 10).has_value());
+}
+
+TEST_F(BootstrapTest, CipherNegotiation) {
+  auto peer1 = create_peer(1, 3001);
+  auto peer2 = create_peer(2, 3002, {ADDRESS + ":3001"});
+
+  start_peer(peer1);
+  start_peer(peer2);
+
+  std::this_thread::sleep_for(std::chrono::seconds(3));
+  verify_peer_connections({peer1, peer2});
+
+  // Both ends pick the same authenticated suite and know the other's measurements
+  auto remote1 = peer1->bootstrap->get_peer_manager().get_peer(2);
+  auto remote2 = peer2->bootstrap->get_peer_manager().get_peer(1);
+  ASSERT_TRUE(remote1 && remote2);
+  EXPECT_EQ(remote1->get_negotiated_cipher(), remote2->get_negotiated_cipher());
+  EXPECT_TRUE(dfs::crypto::CryptoStream::isAuthenticated(remote1->get_negotiated_cipher()));
+  EXPECT_EQ(remote1->get_remote_suites().size(), dfs::crypto::CipherBenchmark::shared().get_results().size());
+  EXPECT_EQ(peer1->bootstrap->get_peer_manager().get_broadcast_cipher(), remote1->get_negotiated_cipher());
+
+  // Frames sent under the negotiated suite still arrive
+  std::stringstream file_content;
+  file_content << TEST_FILE_CONTENT;
+  peer2->bootstrap->get_file_server().store_file(TEST_FILENAME, file_content);
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  verify_file_content(TEST_FILENAME, TEST_FILE_CONTENT, {peer1, peer2});
+
+  // Frames still arrive when the sender pins an unauthenticated cipher
+  const std::string pinned_filename = "pinned.txt";
+  peer2->bootstrap->get_file_server().set_cipher(Codec::Cipher::Aes256Cbc);
+  std::stringstream pinned_content;
+  pinned_content << TEST_FILE_CONTENT;
+  peer2->bootstrap->get_file_server().store_file(pinned_filename, pinned_content);
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+  verify_file_content(pinned_filename, TEST_FILE_CONTENT, {peer1, peer2});
+}
@@ -125,4 +125,58 @@ TEST_F(CodecTest, LargePayloadChunkedProcessing) {
 TEST_F(CodecTest, EmptySourceId) {
   MessageFrame frame = createBasicFrame(0);
   verifySerializeDeserialize(frame);
-}
\ No newline at end of file
+}
+
+TEST_F(CodecTest, GcmSerializeDeserialize) {
+  // Test the reported size matches the bytes written, including block aligned CBC payloads
+  for (auto cipher : {Codec::Cipher::Aes256Cbc, Codec::Cipher::Aes256Gcm, Codec::Cipher::ChaCha20Poly1305}) {
+    codec.set_cipher(cipher);
+    for (size_t size : {size_t{16}, size_t{1000}, dfs::crypto::CryptoStream::RECORD_SIZE * 3 + 7}) {
+      MessageFrame frame = createBasicFrame(4, 0, 5);
+      addPayload(frame, generate_random_data(size));
+      std::stringstream output_stream;
+      std::size_t written = codec.serialize(frame, output_stream);
+      EXPECT_EQ(written, output_stream.str().size()) << "Payload size: " << size;
+      verifySerializeDeserialize(frame);
+    }
+  }
+}
+
+TEST_F(CodecTest, GcmRejectsTamperedFrames) {
+  MessageFrame frame = createBasicFrame(5, 0, 6);
+  addPayload(frame, generate_random_data(100000));
+
+  Channel sender_channel;
+  Codec gcm_sender(test_key, sender_channel, Codec::Cipher::Aes256Gcm);
+  Codec cbc_sender(test_key, sender_channel);
+  std::stringstream gcm_frame, cbc_frame;
+  gcm_sender.serialize(frame, gcm_frame);
+  cbc_sender.serialize(frame, cbc_frame);
+
+  auto deserialize = [this](const std::string& data) {
+    std::stringstream input(data);
+    codec.deserialize(input);
+  };
+
+  // Test a CBC codec still accepts authenticated frames
+  deserialize(gcm_frame.str());
+  MessageFrame output_frame;
+  ASSERT_TRUE(channel.consume(output_frame));
+  verifyFramesMatch(frame, output_frame);
+
+  // Test a GCM codec refuses unauthenticated frames
+  codec.set_cipher(Codec::Cipher::Aes256Gcm);
+  EXPECT_THROW(deserialize(cbc_frame.str()), std::runtime_error);
+
+  // Test a modified clear header fails at the filename length
+  std::string modified_header = gcm_frame.str();
+  modified_header[dfs::crypto::CryptoStream::IV_SIZE + 2] ^= 0x01;
+  EXPECT_THROW(deserialize(modified_header), dfs::crypto::DecryptionError);
+
+  // Test a modified payload byte fails its record
+  std::string modified_payload = gcm_frame.str();
+  modified_payload[modified_payload.size() - 50] ^= 0x01;
+  EXPECT_THROW(deserialize(modified_payload), dfs::crypto::DecryptionError);
+
+  EXPECT_TRUE(channel.empty());
+}
@@ -2,7 +2,11 @@
 #include <sstream>
 #include <vector>
 #include <cstring>
+#include <algorithm>
+#include <atomic>
 #include "crypto/crypto_stream.hpp"
+#include "crypto/worker_pool.hpp"
+#include "crypto/cipher_benchmark.hpp"
 
 using namespace dfs::crypto;
 
@@ -168,4 +172,355 @@ TEST_F(CryptoStreamTest, IVGeneration) {
 
   ASSERT_EQ(decrypted.str(), test_data)
       << "Data encrypted with generated IV should decrypt correctly";
-}
\ No newline at end of file
+}
+// Test GCM record sizes and round trips across record boundaries
+TEST_F(CryptoStreamTest, GcmRecords) {
+  // CBC ciphertext sizes include the full padding block of aligned input
+  for (size_t size : {0, 15, 16, 17}) {
+    std::stringstream input(std::string(size, 'c')), encrypted;
+    crypto.encrypt(input, encrypted);
+    EXPECT_EQ(encrypted.str().size(), crypto.getCiphertextSize(size)) << "CBC size: " << size;
+  }
+
+  CryptoStream sender, receiver;
+  sender.setCipher(CryptoStream::Cipher::Aes256Gcm);
+  receiver.setCipher(CryptoStream::Cipher::Aes256Gcm);
+  sender.initialize(key, iv);
+  receiver.initialize(key, iv);
+
+  const size_t record = CryptoStream::RECORD_SIZE;
+  for (size_t size : {size_t{0}, size_t{1}, record - 1, record, record + 1, 3 * record + 5}) {
+    std::string plaintext(size, '\0');
+    for (size_t i = 0; i < size; ++i) {
+      plaintext[i] = static_cast<char>(i * 31 + size);
+    }
+    std::stringstream input(plaintext), encrypted, decrypted;
+    sender.encrypt(input, encrypted);
+    EXPECT_EQ(encrypted.str().size(), sender.getCiphertextSize(size)) << "GCM size: " << size;
+    receiver.decrypt(encrypted, decrypted);
+    EXPECT_EQ(decrypted.str(), plaintext) << "GCM size: " << size;
+  }
+}
+
+// Test GCM rejects modified, truncated and misattributed ciphertext
+TEST_F(CryptoStreamTest, GcmTamperDetection) {
+  const size_t record = CryptoStream::RECORD_SIZE;
+  const std::string plaintext(2 * record + 100, 'g');
+  const std::vector<uint8_t> header = {1, 2, 3};
+
+  auto encrypt = [&]() {
+    CryptoStream sender;
+    sender.setCipher(CryptoStream::Cipher::Aes256Gcm);
+    sender.initialize(key, iv);
+    sender.setAssociatedData(header);
+    std::stringstream input(plaintext), encrypted;
+    sender.encrypt(input, encrypted);
+    return encrypted.str();
+  };
+  auto decrypt = [&](const std::string& ciphertext, const std::vector<uint8_t>& associated_data) {
+    CryptoStream receiver;
+    receiver.setCipher(CryptoStream::Cipher::Aes256Gcm);
+    receiver.initialize(key, iv);
+    receiver.setAssociatedData(associated_data);
+    std::stringstream encrypted(ciphertext), decrypted;
+    receiver.decrypt(encrypted, decrypted);
+    return decrypted.str();
+  };
+
+  const std::string ciphertext = encrypt();
+  EXPECT_EQ(decrypt(ciphertext, header), plaintext);
+
+  // A flipped bit in the second record fails its tag
+  std::string modified = ciphertext;
+  modified[record + CryptoStream::TAG_SIZE + 10] ^= 0x01;
+  EXPECT_THROW(decrypt(modified, header), DecryptionError);
+
+  // Dropping the final record leaves a full record that was not sealed as final
+  std::string truncated = ciphertext.substr(0, 2 * (record + CryptoStream::TAG_SIZE));
+  EXPECT_THROW(decrypt(truncated, header), DecryptionError);
+  EXPECT_THROW(decrypt(ciphertext.substr(0, CryptoStream::TAG_SIZE - 1), header), DecryptionError);
+
+  // Different associated data fails even with untouched ciphertext
+  EXPECT_THROW(decrypt(ciphertext, {1, 2, 4}), DecryptionError);
+
+  // GCM nonces need at least NONCE_SIZE bytes of IV
+  CryptoStream short_iv;
+  short_iv.setCipher(CryptoStream::Cipher::Aes256Gcm);
+  short_iv.initialize(key, std::vector<uint8_t>(CryptoStream::NONCE_SIZE - 1, 0x24));
+  std::stringstream input("data"), output;
+  EXPECT_THROW(short_iv.encrypt(input, output), InitializationError);
+}
+
+// Test GCM records processed in parallel match the sequential output
+TEST_F(CryptoStreamTest, ParallelRecords) {
+  // The pool runs every index once and rethrows a task's exception
+  WorkerPool& pool = WorkerPool::shared();
+  std::vector<std::atomic<int>> runs(100);
+  pool.parallel_for(runs.size(), [&](size_t index) { runs[index]++; });
+  for (const auto& count : runs) {
+    EXPECT_EQ(count.load(), 1);
+  }
+  EXPECT_THROW(pool.parallel_for(10, [](size_t index) {
+    if (index == 7) {
+      throw std::runtime_error("task failed");
+    }
+  }), std::runtime_error);
+
+  std::string plaintext(20 * CryptoStream::RECORD_SIZE + 123, '\0');
+  for (size_t i = 0; i < plaintext.size(); ++i) {
+    plaintext[i] = static_cast<char>(i * 131 + (i >> 12));
+  }
+  auto encrypt = [&](size_t threads) {
+    CryptoStream sender;
+    sender.setCipher(CryptoStream::Cipher::Aes256Gcm);
+    sender.setThreads(threads);
+    sender.initialize(key, iv);
+    std::stringstream input(plaintext), encrypted;
+    sender.encrypt(input, encrypted);
+    return encrypted.str();
+  };
+
+  // Batches of records are sealed identically whatever the thread count
+  const std::string sequential = encrypt(1);
+  EXPECT_EQ(encrypt(4), sequential);
+  EXPECT_EQ(encrypt(0), sequential);
+
+  // One stream encrypts and decrypts in parallel, switching direction between calls
+  CryptoStream parallel;
+  parallel.setCipher(CryptoStream::Cipher::Aes256Gcm);
+  parallel.setThreads(4);
+  parallel.initialize(key, iv);
+  std::stringstream encrypted(sequential), decrypted;
+  parallel.decrypt(encrypted, decrypted);
+  EXPECT_EQ(decrypted.str(), plaintext);
+
+  // A tampered record in the middle of a batch fails the whole batch
+  std::string modified = sequential;
+  modified[6 * (CryptoStream::RECORD_SIZE + CryptoStream::TAG_SIZE) + 5] ^= 0x01;
+  std::stringstream tampered(modified), rejected;
+  parallel.initialize(key, iv);
+  EXPECT_THROW(parallel.decrypt(tampered, rejected), DecryptionError);
+}
+
+TEST_F(CryptoStreamTest, ContextPooling) {
+  const std::string plaintext = "Frames of one peer reuse their cipher contexts";
+  auto round_trip = [&](const std::vector<uint8_t>& stream_key) {
+    CryptoStream sender, receiver;
+    sender.initialize(stream_key, iv);
+    receiver.initialize(stream_key, iv);
+    std::stringstream input(plaintext), encrypted, decrypted;
+    sender.encrypt(input, encrypted);
+    receiver.decrypt(encrypted, decrypted);
+    return decrypted.str();
+  };
+
+  // The first frame keys one context per direction, later frames only reset the IV
+  ASSERT_EQ(round_trip(key), plaintext);
+  CryptoStream::ContextPoolStats before = CryptoStream::getContextPoolStats();
+  for (int frame = 0; frame < 10; ++frame) {
+    ASSERT_EQ(round_trip(key), plaintext);
+  }
+  CryptoStream::ContextPoolStats after = CryptoStream::getContextPoolStats();
+  EXPECT_EQ(after.hits - before.hits, 20u);
+  EXPECT_EQ(after.misses, before.misses);
+  EXPECT_GE(after.pooled, 2u);
+  EXPECT_LE(after.pooled, CryptoStream::POOL_CAPACITY);
+
+  // A different key never gets a context keyed with another
+  std::vector<uint8_t> other_key(key);
+  other_key[0] ^= 0xFF;
+  EXPECT_EQ(round_trip(other_key), plaintext);
+  EXPECT_EQ(CryptoStream::getContextPoolStats().misses - after.misses, 2u);
+
+  // A reused context resets its IV, so the ciphertext only depends on the IV
+  CryptoStream first, second;
+  first.initialize(key, iv);
+  second.initialize(key, iv);
+  std::stringstream first_input(plaintext), second_input(plaintext), first_output, second_output;
+  first.encrypt(first_input, first_output);
+  second.encrypt(second_input, second_output);
+  EXPECT_EQ(first_output.str(), second_output.str());
+
+  // Decrypting with the wrong key still fails on a pooled context
+  CryptoStream wrong;
+  wrong.initialize(other_key, iv);
+  std::stringstream encrypted(first_output.str()), decrypted;
+  EXPECT_THROW(wrong.decrypt(encrypted, decrypted), DecryptionError);
+}
+
+TEST_F(CryptoStreamTest, BufferOperations) {
+  for (auto cipher : {CryptoStream::Cipher::Aes256Cbc, CryptoStream::Cipher::Aes256Gcm}) {
+    crypto.setCipher(cipher);
+    for (size_t size : {size_t{0}, size_t{4}, size_t{16}, CryptoStream::RECORD_SIZE, CryptoStream::RECORD_SIZE * 3 + 7}) {
+      std::vector<uint8_t> plaintext(size);
+      for (size_t i = 0; i < size; ++i) {
+        plaintext[i] = static_cast<uint8_t>(i * 7 + (i >> 10));
+      }
+
+      // Buffers and streams produce the same message, GCM record numbers restart with initialize()
+      std::stringstream input(std::string(plaintext.begin(), plaintext.end())), streamed;
+      crypto.encrypt(input, streamed);
+      crypto.initialize(key, iv);
+      std::vector<uint8_t> ciphertext(crypto.getCiphertextSize(size));
+      ASSERT_EQ(crypto.encrypt(plaintext, ciphertext), ciphertext.size());
+      EXPECT_EQ(std::string(ciphertext.begin(), ciphertext.end()), streamed.str());
+
+      std::vector<uint8_t> decrypted(crypto.getPlaintextSize(ciphertext.size()));
+      ASSERT_EQ(crypto.decrypt(ciphertext, decrypted), size);
+      EXPECT_TRUE(std::equal(plaintext.begin(), plaintext.end(), decrypted.begin()));
+
+      // In place, the buffer holds the plaintext followed by room for the ciphertext
+      std::vector<uint8_t> buffer(plaintext);
+      buffer.resize(crypto.getCiphertextSize(size));
+      crypto.initialize(key, iv);
+      ASSERT_EQ(crypto.encryptInPlace(buffer, size), buffer.size());
+      EXPECT_EQ(buffer, ciphertext);
+      ASSERT_EQ(crypto.decryptInPlace(buffer), size);
+      EXPECT_TRUE(std::equal(plaintext.begin(), plaintext.end(), buffer.begin()));
+      crypto.initialize(key, iv);
+    }
+
+    // Too small an output buffer throws before anything is written
+    std::vector<uint8_t> plaintext(100, 0x11);
+    std::vector<uint8_t> small(crypto.getCiphertextSize(plaintext.size()) - 1);
+    EXPECT_THROW(crypto.encrypt(plaintext, small), EncryptionError);
+    EXPECT_THROW(crypto.encryptInPlace(plaintext, plaintext.size()), EncryptionError);
+  }
+
+  // A record that fails authentication leaves no plaintext behind
+  std::vector<uint8_t> plaintext(2 * CryptoStream::RECORD_SIZE, 0x5A);
+  std::vector<uint8_t> ciphertext(crypto.getCiphertextSize(plaintext.size()));
+  crypto.encrypt(plaintext, ciphertext);
+  ciphertext.back() ^= 0x01;
+  std::vector<uint8_t> decrypted(crypto.getPlaintextSize(ciphertext.size()));
+  EXPECT_THROW(crypto.decrypt(ciphertext, decrypted), DecryptionError);
+  EXPECT_TRUE(std::all_of(decrypted.begin(), decrypted.end(), [](uint8_t byte) { return byte == 0; }));
+}
+
+TEST_F(CryptoStreamTest, IncrementalOperations) {
+  std::vector<uint8_t> plaintext(2 * CryptoStream::RECORD_SIZE + 999);
+  for (size_t i = 0; i < plaintext.size(); ++i) {
+    plaintext[i] = static_cast<uint8_t>(i * 13);
+  }
+
+  // Feeds a message through update() in pieces of the given size
+  auto feed = [&](CryptoStream::Mode mode, const std::vector<uint8_t>& input, size_t piece) {
+    std::vector<uint8_t> output;
+    std::vector<uint8_t> buffer;
+    crypto.initialize(key, iv);
+    crypto.begin(mode);
+    for (size_t offset = 0; offset < input.size(); offset += piece) {
+      size_t length = std::min(piece, input.size() - offset);
+      buffer.resize(crypto.getUpdateSize(length));
+      size_t written = crypto.update({input.data() + offset, length}, buffer);
+      output.insert(output.end(), buffer.begin(), buffer.begin() + written);
+    }
+    buffer.resize(crypto.getFinishSize());
+    size_t written = crypto.finish(buffer);
+    output.insert(output.end(), buffer.begin(), buffer.begin() + written);
+    return output;
+  };
+
+  for (auto cipher : {CryptoStream::Cipher::Aes256Cbc, CryptoStream::Cipher::Aes256Gcm}) {
+    crypto.setCipher(cipher);
+    std::vector<uint8_t> ciphertext(crypto.getCiphertextSize(plaintext.size()));
+    crypto.initialize(key, iv);
+    crypto.encrypt(plaintext, ciphertext);
+
+    // Any split of the message gives the one-shot result
+    for (size_t piece : {size_t{1000}, CryptoStream::RECORD_SIZE, CryptoStream::RECORD_SIZE + 1, plaintext.size()}) {
+      EXPECT_EQ(feed(CryptoStream::Mode::Encrypt, plaintext, piece), ciphertext);
+      EXPECT_EQ(feed(CryptoStream::Mode::Decrypt, ciphertext, piece), plaintext);
+    }
+  }
+
+  // The record held back by update() is sealed as final by finish()
+  crypto.setCipher(CryptoStream::Cipher::Aes256Gcm);
+  std::vector<uint8_t> record(CryptoStream::RECORD_SIZE, 0x33);
+  std::vector<uint8_t> sealed = feed(CryptoStream::Mode::Encrypt, record, record.size());
+  EXPECT_EQ(sealed.size(), CryptoStream::RECORD_SIZE + CryptoStream::TAG_SIZE);
+  EXPECT_EQ(feed(CryptoStream::Mode::Decrypt, sealed, 100), record);
+
+  // update() and finish() need a message started by begin()
+  std::vector<uint8_t> output(64);
+  EXPECT_THROW(crypto.update(record, output), InitializationError);
+  EXPECT_THROW(crypto.finish(output), InitializationError);
+}
+
+// Test ChaCha20-Poly1305 uses the GCM record layout with its own cipher
+TEST_F(CryptoStreamTest, ChaChaRecords) {
+  const std::vector<uint8_t> header = {7, 8, 9};
+  std::vector<uint8_t> plaintext(2 * CryptoStream::RECORD_SIZE + 77);
+  for (size_t i = 0; i < plaintext.size(); ++i) {
+    plaintext[i] = static_cast<uint8_t>(i * 11);
+  }
+
+  auto seal = [&](CryptoStream::Cipher cipher) {
+    CryptoStream sender;
+    sender.setCipher(cipher);
+    sender.initialize(key, iv);
+    sender.setAssociatedData(header);
+    std::vector<uint8_t> ciphertext(sender.getCiphertextSize(plaintext.size()));
+    sender.encrypt(plaintext, ciphertext);
+    return ciphertext;
+  };
+  auto open = [&](const std::vector<uint8_t>& ciphertext) {
+    CryptoStream receiver;
+    receiver.setCipher(CryptoStream::Cipher::ChaCha20Poly1305);
+    receiver.initialize(key, iv);
+    receiver.setAssociatedData(header);
+    std::vector<uint8_t> decrypted(receiver.getPlaintextSize(ciphertext.size()));
+    decrypted.resize(receiver.decrypt(ciphertext, decrypted));
+    return decrypted;
+  };
+
+  std::vector<uint8_t> ciphertext = seal(CryptoStream::Cipher::ChaCha20Poly1305);
+  EXPECT_TRUE(CryptoStream::isAuthenticated(CryptoStream::Cipher::ChaCha20Poly1305));
+  EXPECT_EQ(ciphertext.size(), seal(CryptoStream::Cipher::Aes256Gcm).size());
+  EXPECT_NE(ciphertext, seal(CryptoStream::Cipher::Aes256Gcm));
+  EXPECT_EQ(open(ciphertext), plaintext);
+
+  // Streams produce the same records as buffers
+  CryptoStream sender;
+  sender.setCipher(CryptoStream::Cipher::ChaCha20Poly1305);
+  sender.initialize(key, iv);
+  sender.setAssociatedData(header);
+  std::stringstream input(std::string(plaintext.begin(), plaintext.end())), streamed;
+  sender.encrypt(input, streamed);
+  EXPECT_EQ(streamed.str(), std::string(ciphertext.begin(), ciphertext.end()));
+
+  // Tags are checked per record, and GCM records do not open as ChaCha ones
+  std::vector<uint8_t> modified = ciphertext;
+  modified[CryptoStream::RECORD_SIZE + CryptoStream::TAG_SIZE + 3] ^= 0x01;
+  EXPECT_THROW(open(modified), DecryptionError);
+  EXPECT_THROW(open(seal(CryptoStream::Cipher::Aes256Gcm)), DecryptionError);
+}
+
+// Test the benchmark measures every suite and selection favours the slowest participant
+TEST_F(CryptoStreamTest, CipherSelection) {
+  const CipherBenchmark& benchmark = CipherBenchmark::shared();
+  ASSERT_EQ(benchmark.get_results().size(), CipherBenchmark::SUITES.size());
+  for (auto cipher : CipherBenchmark::SUITES) {
+    EXPECT_GT(benchmark.get_throughput(cipher), 0u) << CipherBenchmark::get_name(cipher);
+  }
+  EXPECT_EQ(benchmark.get_throughput(CryptoStream::Cipher::Aes256Cbc), 0u);
+
+  using C = CryptoStream::Cipher;
+  const std::vector<SuiteSpeed> fast_aes = {{C::Aes256Gcm, 4000}, {C::ChaCha20Poly1305, 1500}};
+  const std::vector<SuiteSpeed> slow_aes = {{C::Aes256Gcm, 300}, {C::ChaCha20Poly1305, 900}};
+  const std::vector<SuiteSpeed> gcm_only = {{C::Aes256Gcm, 100}};
+
+  // Two AES machines keep GCM, one without AES instructions moves both to ChaCha
+  EXPECT_EQ(CipherBenchmark::select({fast_aes, fast_aes}), C::Aes256Gcm);
+  EXPECT_EQ(CipherBenchmark::select({fast_aes, slow_aes}), C::ChaCha20Poly1305);
+  EXPECT_EQ(CipherBenchmark::select({slow_aes, fast_aes}), C::ChaCha20Poly1305);
+
+  // Only suites every participant offers are considered
+  EXPECT_EQ(CipherBenchmark::select({slow_aes, gcm_only}), C::Aes256Gcm);
+  EXPECT_EQ(CipherBenchmark::select({gcm_only, {{C::ChaCha20Poly1305, 900}}}), std::nullopt);
+  EXPECT_EQ(CipherBenchmark::select({}), std::nullopt);
+
+  // Ties go to the lower cipher id regardless of offer order
+  const std::vector<SuiteSpeed> tied = {{C::ChaCha20Poly1305, 500}, {C::Aes256Gcm, 500}};
+  EXPECT_EQ(CipherBenchmark::select({tied, tied}), C::Aes256Gcm);
+}
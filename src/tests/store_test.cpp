@@ -1,11 +1,16 @@
 #include <gtest/gtest.h>
+#include <iostream>
 #include <sstream>
 #include <filesystem>
 #include "store/store.hpp"
+#include "store/ingester.hpp"
 #include <chrono>
 #include <thread>
 #include <atomic>
 #include <set>
+#include <map>
+#include <fstream>
+#include <unistd.h>
 
 using namespace dfs::store;
 
@@ -136,18 +141,54 @@ TEST_F(StoreTest, AdvancedOperations) {
 }
 
 TEST_F(StoreTest, ConcurrentAccess) {
-  const size_t num_threads = 5;
-  const size_t ops_per_thread = 50;
+  const size_t num_threads = 8;
+  const size_t ops_per_thread = 200;
+  const size_t hot_keys = 4;
+  const size_t object_size = 16 * 1024;
   std::atomic<size_t> successful_ops{0};
+  std::atomic<size_t> torn_reads{0};
   std::vector<std::thread> threads;
 
+  // Bypass the cache so every read takes the key lock and hits disk
+  store->set_cache_capacity(0);
+
+  // Every version of a hot key is one repeated character, so a mixed
+  // object can only come from a read overlapping a write
+  auto version = [object_size](size_t v) { return std::string(object_size, 'a' + v % 26); };
+  for (size_t k = 0; k < hot_keys; ++k) {
+    store_and_verify("hot_" + std::to_string(k), version(k));
+  }
+
+  auto start = std::chrono::steady_clock::now();
   for (size_t i = 0; i < num_threads; ++i) {
-    threads.emplace_back([this, i, ops_per_thread, &successful_ops]() {
+    threads.emplace_back([&, i]() {
       for (size_t j = 0; j < ops_per_thread; ++j) {
         try {
-          std::string key = "concurrent_" + std::to_string(i) + "_" + std::to_string(j);
-          std::string data = "Data for " + key;
-          store_and_verify(key, data);
+          std::string hot_key = "hot_" + std::to_string((i + j) % hot_keys);
+          switch (j % 4) {
+            case 0: {
+              // Writer contending with readers of the same key
+              std::stringstream input(version(i * ops_per_thread + j));
+              store->store(hot_key, input);
+              break;
+            }
+            case 1: {
+              // Writer of an unrelated key
+              std::string key = "concurrent_" + std::to_string(i) + "_" + std::to_string(j);
+              store_and_verify(key, "Data for " + key);
+              break;
+            }
+            default: {
+              // Readers of a shared key
+              std::stringstream output;
+              store->get(hot_key, output);
+              std::string content = output.str();
+              if (content.size() != object_size ||
+                  content.find_first_not_of(content[0]) != std::string::npos) {
+                torn_reads++;
+              }
+            }
+          }
           successful_ops++;
         } catch (const std::exception& e) {
           ADD_FAILURE() << "Thread " << i << " failed: " << e.what();
@@ -159,6 +200,1257 @@ TEST_F(StoreTest, ConcurrentAccess) {
   for (auto& thread : threads) {
       thread.join();
   }
+  auto elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+  // Report throughput so runs can be compared
+  double ops_per_second = successful_ops / elapsed;
+  RecordProperty("ops_per_second", std::to_string(static_cast<uint64_t>(ops_per_second)));
+  RecordProperty("lock_contention", std::to_string(store->get_lock_contention()));
 
   EXPECT_EQ(successful_ops, num_threads * ops_per_thread);
-}
\ No newline at end of file
+  EXPECT_EQ(torn_reads, 0);
+}
+
+TEST_F(StoreTest, ChunkedDeduplication) {
+  store->set_chunking(true);
+
+  // Pseudo-random content so the chunker finds natural boundaries
+  std::string data(512 * 1024, '\0');
+  uint32_t state = 12345;
+  for (auto& c : data) {
+    state = state * 1103515245 + 12345;
+    c = static_cast<char>(state >> 16);
+  }
+
+  auto count_chunks = [this]() {
+    size_t count = 0;
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(test_dir)) {
+      if (entry.path().extension() == ".chunk") {
+        ++count;
+      }
+    }
+    return count;
+  };
+
+  // Test chunked round trip and logical size reporting
+  store_and_verify("chunked_a", data);
+  ASSERT_EQ(store->get_file_size("chunked_a"), data.size());
+  const size_t initial_chunks = count_chunks();
+  ASSERT_GT(initial_chunks, 1u);
+
+  // Test identical content adds no chunks
+  store_and_verify("chunked_b", data);
+  EXPECT_EQ(count_chunks(), initial_chunks);
+
+  // Test an insert near the start only adds a few chunks
+  std::string edited = "inserted prefix" + data;
+  store_and_verify("chunked_c", edited);
+  EXPECT_LE(count_chunks(), initial_chunks + 3);
+
+  // Test garbage collection only reclaims unreferenced chunks
+  store->remove("chunked_a");
+  EXPECT_EQ(store->collect_garbage(), 0u);
+  store->remove("chunked_b");
+  store->remove("chunked_c");
+  EXPECT_GT(store->collect_garbage(), 0u);
+  EXPECT_EQ(count_chunks(), 0u);
+
+  // Test raw content that starts like a manifest is served as stored
+  store->set_chunking(false);
+  const std::string lookalike = std::string("\0DFS-MANIFEST 1\n", 16) + "not a manifest";
+  store_and_verify("lookalike", lookalike);
+  std::stringstream range;
+  EXPECT_EQ(store->get_range("lookalike", 1, 12, range), 12u);
+  EXPECT_EQ(range.str(), lookalike.substr(1, 12));
+  EXPECT_EQ(store->collect_garbage(), 0u);
+
+  // Test chunk sizes that leave no hash bits for boundaries are rejected
+  EXPECT_THROW(Chunker(1, 1, 1), StoreError);
+  EXPECT_NO_THROW(Chunker(1, 2, 4));
+}
+
+TEST_F(StoreTest, ObjectViews) {
+  const std::string key = "view_key";
+  const std::string data(256 * 1024, 'V');
+  store_and_verify(key, data);
+
+  // Test mapped view exposes the stored bytes
+  auto view = store->open_view(key);
+  ASSERT_TRUE(view->is_mapped());
+  ASSERT_EQ(view->size(), data.size());
+  ASSERT_EQ(std::string(view->bytes().data(), view->bytes().size()), data);
+
+  // Test view stays readable after the object is removed
+  store->remove(key);
+  char tail[4];
+  ASSERT_EQ(view->read(data.size() - 2, tail, sizeof(tail)), 2u);
+  EXPECT_EQ(std::string(tail, 2), "VV");
+
+  // Test pread fallback when the object exceeds the mapping limit
+  const std::filesystem::path raw_path = std::filesystem::path(test_dir) / "raw_object";
+  std::ofstream(raw_path, std::ios::binary) << "positioned read content";
+  auto unmapped = ObjectView::open(raw_path, 0);
+  EXPECT_FALSE(unmapped->is_mapped());
+  EXPECT_TRUE(unmapped->bytes().empty());
+  std::stringstream output;
+  unmapped->write_to(output);
+  EXPECT_EQ(output.str(), "positioned read content");
+
+  // Test an unmapped view admits each read on its own and holds no slot in between
+  IoScheduler scheduler;
+  auto governed = ObjectView::open(raw_path, 0, &scheduler, IoClass::Background);
+  EXPECT_EQ(scheduler.get_in_flight(), 0u);
+  std::stringstream governed_output;
+  EXPECT_EQ(governed->write_range_to(governed_output, 0, 10), 10u);
+  EXPECT_EQ(governed_output.str(), "positioned");
+  EXPECT_EQ(scheduler.get_stats(IoClass::Background).operations, 1u);
+  EXPECT_EQ(scheduler.get_stats(IoClass::Background).bytes, 10u);
+  EXPECT_EQ(scheduler.get_in_flight(), 0u);
+
+  // Test a mapped view performs no scheduled reads
+  auto lazy = ObjectView::open(raw_path, ObjectView::MMAP_LIMIT, &scheduler, IoClass::Background);
+  EXPECT_TRUE(lazy->is_mapped());
+  lazy->write_to(governed_output);
+  EXPECT_EQ(scheduler.get_stats(IoClass::Background).operations, 1u);
+
+  // Test empty objects and missing keys
+  store_and_verify("empty_view", "");
+  EXPECT_EQ(store->open_view("empty_view")->size(), 0u);
+  EXPECT_THROW(store->open_view("missing_view"), StoreError);
+}
+
+TEST_F(StoreTest, IndexPersistence) {
+  store_and_verify("persisted_key", "Persisted content");
+  store_and_verify("removed_key", "Removed content");
+  store->remove("removed_key");
+
+  // Test a restarted store recovers the index from its snapshot
+  store.reset();
+  ASSERT_TRUE(std::filesystem::exists(std::filesystem::path(test_dir) / StoreIndex::SNAPSHOT_FILENAME));
+  store = std::make_unique<Store>(test_dir);
+  EXPECT_TRUE(store->has("persisted_key"));
+  EXPECT_EQ(store->get_file_size("persisted_key"), std::string("Persisted content").size());
+  expect_retrieval_fails("removed_key");
+
+  // Test journal replay restores changes not yet folded into a snapshot
+  const std::filesystem::path dir(test_dir);
+  store_and_verify("journaled_key", "Journaled content");
+  std::filesystem::copy_file(dir / StoreIndex::JOURNAL_FILENAME, dir / "journal_copy");
+  store.reset();
+  std::filesystem::remove(dir / StoreIndex::SNAPSHOT_FILENAME);
+  std::filesystem::rename(dir / "journal_copy", dir / StoreIndex::JOURNAL_FILENAME);
+  store = std::make_unique<Store>(test_dir);
+  EXPECT_TRUE(store->has("journaled_key"));
+
+  // Test objects are still found when the index files are lost
+  store.reset();
+  std::filesystem::remove(std::filesystem::path(test_dir) / StoreIndex::SNAPSHOT_FILENAME);
+  std::filesystem::remove(std::filesystem::path(test_dir) / StoreIndex::JOURNAL_FILENAME);
+  store = std::make_unique<Store>(test_dir);
+  EXPECT_TRUE(store->has("persisted_key"));
+  EXPECT_EQ(store->get_file_size("persisted_key"), std::string("Persisted content").size());
+  expect_retrieval_fails("removed_key");
+
+  // Test objects of a store that predates the index stay visible across reopens
+  store_and_verify("pre_index_key", "Pre-index content");
+  store.reset();
+  std::filesystem::remove(std::filesystem::path(test_dir) / StoreIndex::SNAPSHOT_FILENAME);
+  std::filesystem::remove(std::filesystem::path(test_dir) / StoreIndex::JOURNAL_FILENAME);
+  store = std::make_unique<Store>(test_dir);
+  store_and_verify("post_index_key", "Post-index content");
+  for (int reopen = 0; reopen < 2; ++reopen) {
+    store = std::make_unique<Store>(test_dir);
+    EXPECT_TRUE(store->has("pre_index_key"));
+    EXPECT_EQ(store->get_file_size("pre_index_key"), std::string("Pre-index content").size());
+    EXPECT_TRUE(store->has("post_index_key"));
+  }
+
+  // Test the authoritative state confirmed by a repairing scan is persisted
+  store.reset();
+  EXPECT_FALSE(StoreIndex(test_dir).is_authoritative());
+  store = std::make_unique<Store>(test_dir);
+  EXPECT_TRUE(store->has("persisted_key"));
+  EXPECT_TRUE(store->has("journaled_key"));
+  EXPECT_EQ(store->scan(true).unindexed_objects, 0u);
+  store.reset();
+  EXPECT_TRUE(StoreIndex(test_dir).is_authoritative());
+  store = std::make_unique<Store>(test_dir);
+  EXPECT_TRUE(store->has("pre_index_key"));
+
+  // Test the journal compacts at the threshold, then grows with the snapshot
+  const std::filesystem::path index_dir = test_dir + "_index";
+  std::filesystem::create_directories(index_dir);
+  {
+    StoreIndex index(index_dir);
+    IndexEntry entry;
+    entry.flags = INDEX_FLAG_COMPRESSED | INDEX_FLAG_REPLICA;
+    size_t next = 0;
+    auto put_entries = [&](size_t count) {
+      for (size_t i = 0; i < count; ++i, ++next) {
+        index.put("index_key_" + std::to_string(next), entry);
+      }
+    };
+    put_entries(StoreIndex::COMPACT_THRESHOLD);
+    EXPECT_EQ(std::filesystem::file_size(index_dir / StoreIndex::JOURNAL_FILENAME), 0u);
+    put_entries(2 * StoreIndex::COMPACT_THRESHOLD);
+    EXPECT_EQ(std::filesystem::file_size(index_dir / StoreIndex::JOURNAL_FILENAME), 0u);
+    put_entries(StoreIndex::COMPACT_THRESHOLD);
+    EXPECT_GT(std::filesystem::file_size(index_dir / StoreIndex::JOURNAL_FILENAME), 0u);
+    EXPECT_EQ(index.size(), 4 * StoreIndex::COMPACT_THRESHOLD);
+    index.compact();
+  }
+
+  // Test a compacted snapshot alone restores every entry once the journal is lost
+  std::filesystem::remove(index_dir / StoreIndex::JOURNAL_FILENAME);
+  {
+    StoreIndex index(index_dir);
+    EXPECT_TRUE(index.is_authoritative());
+    EXPECT_EQ(index.size(), 4 * StoreIndex::COMPACT_THRESHOLD);
+    auto restored = index.lookup("index_key_0");
+    ASSERT_TRUE(restored.has_value());
+    EXPECT_EQ(restored->flags, INDEX_FLAG_COMPRESSED | INDEX_FLAG_REPLICA);
+  }
+  std::filesystem::remove_all(index_dir);
+}
+
+TEST_F(StoreTest, DurableGroupCommit) {
+  store->set_commit_window(std::chrono::milliseconds(20));
+  store->set_durability(Durability::GroupCommit);
+  ASSERT_NE(store->get_group_committer(), nullptr);
+
+  // Test concurrent writers share fsync batches
+  const int num_threads = 8;
+  std::vector<std::thread> threads;
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([this, i]() {
+      std::stringstream input("Durable content " + std::to_string(i));
+      store->store("durable_key_" + std::to_string(i), input);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  const GroupCommitter* committer = store->get_group_committer();
+  EXPECT_EQ(committer->get_file_count(), static_cast<uint64_t>(num_threads));
+  EXPECT_LT(committer->get_batch_count(), committer->get_file_count());
+
+  // Test every object is readable and indexed once store() returns
+  for (int i = 0; i < num_threads; ++i) {
+    std::string key = "durable_key_" + std::to_string(i);
+    EXPECT_TRUE(store->has(key));
+    std::stringstream output;
+    store->get(key, output);
+    EXPECT_EQ(output.str(), "Durable content " + std::to_string(i));
+  }
+
+  // Test chunked objects are committed through the same path
+  store->set_chunking(true);
+  store_and_verify("durable_chunked", std::string(100000, 'd'));
+
+  // Test packed objects are committed in shared batches as well
+  store->set_chunking(false);
+  store->set_packing(true);
+  uint64_t batches_before = committer->get_batch_count();
+  uint64_t files_before = committer->get_file_count();
+  threads.clear();
+  for (int i = 0; i < num_threads; ++i) {
+    threads.emplace_back([this, i]() {
+      std::stringstream input("Packed content " + std::to_string(i));
+      store->store("durable_packed_" + std::to_string(i), input);
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(committer->get_file_count() - files_before, static_cast<uint64_t>(num_threads));
+  EXPECT_LT(committer->get_batch_count() - batches_before, static_cast<uint64_t>(num_threads));
+  for (int i = 0; i < num_threads; ++i) {
+    std::stringstream output;
+    store->get("durable_packed_" + std::to_string(i), output);
+    EXPECT_EQ(output.str(), "Packed content " + std::to_string(i));
+  }
+
+  // Test no temp files are left behind
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(test_dir)) {
+    EXPECT_EQ(entry.path().filename().string().find(".tmp."), std::string::npos) << entry.path();
+  }
+
+  // Test a failed sync hook is counted without failing commits that are already recorded
+  GroupCommitter failing(std::chrono::milliseconds(1));
+  failing.set_sync_hook([]() { throw StoreError("sync failed"); });
+  bool recorded = false;
+  auto pending = failing.submit([&recorded]() { recorded = true; });
+  EXPECT_NO_THROW(pending.get());
+  EXPECT_TRUE(recorded);
+  EXPECT_EQ(failing.get_sync_failure_count(), 1u);
+}
+
+TEST_F(StoreTest, PackedSmallObjects) {
+  store->set_packing(true);
+  ASSERT_NE(store->get_pack_store(), nullptr);
+
+  // Test small objects are packed and large ones keep their own file
+  const int num_objects = 100;
+  for (int i = 0; i < num_objects; ++i) {
+    store_and_verify("packed_key_" + std::to_string(i), "Packed content " + std::to_string(i));
+  }
+  std::string large_data(PackStore::MAX_OBJECT_SIZE + 1, 'L');
+  store_and_verify("large_key", large_data);
+  EXPECT_EQ(store->get_pack_store()->object_count(), static_cast<size_t>(num_objects));
+
+  // Test overwriting moves an object between layouts
+  store_and_verify("packed_key_0", large_data);
+  store_and_verify("large_key", "Now small");
+  EXPECT_EQ(store->get_pack_store()->object_count(), static_cast<size_t>(num_objects));
+
+  // Test compaction reclaims removed objects and keeps the rest readable,
+  // whether the background compactor or the explicit call does the work
+  uint64_t bytes_before_removal = store->get_pack_store()->disk_bytes();
+  for (int i = 1; i < num_objects; ++i) {
+    if (i % 4 != 0) {
+      store->remove("packed_key_" + std::to_string(i));
+    }
+  }
+  expect_retrieval_fails("packed_key_1");
+  store->compact_packs();
+  EXPECT_LT(store->get_pack_store()->disk_bytes(), bytes_before_removal);
+  for (int i = 4; i < num_objects; i += 4) {
+    std::stringstream output;
+    store->get("packed_key_" + std::to_string(i), output);
+    EXPECT_EQ(output.str(), "Packed content " + std::to_string(i));
+  }
+
+  // Test a restarted store rebuilds the pack map from its segments
+  store = std::make_unique<Store>(test_dir);
+  ASSERT_NE(store->get_pack_store(), nullptr);
+  EXPECT_TRUE(store->has("packed_key_4"));
+  EXPECT_EQ(store->get_file_size("large_key"), std::string("Now small").size());
+  expect_retrieval_fails("packed_key_3");
+  std::stringstream output;
+  store->get("packed_key_96", output);
+  EXPECT_EQ(output.str(), "Packed content 96");
+
+  // Test deleted packed objects stay deleted across restarts
+  store->delete_file("packed_key_4");
+  store = std::make_unique<Store>(test_dir);
+  expect_retrieval_fails("packed_key_4");
+
+  // Test unindexed packed objects are found and deleted once the index files are lost
+  store.reset();
+  std::filesystem::remove(std::filesystem::path(test_dir) / StoreIndex::SNAPSHOT_FILENAME);
+  std::filesystem::remove(std::filesystem::path(test_dir) / StoreIndex::JOURNAL_FILENAME);
+  store = std::make_unique<Store>(test_dir);
+  store->delete_file("packed_key_8");
+  expect_retrieval_fails("packed_key_8");
+
+  // Test objects replaced while compaction copies their segment keep the newer content
+  const std::filesystem::path pack_dir = test_dir + "_packs";
+  {
+    PackStore packs(pack_dir);
+    std::string content(1000, 'c');
+    for (int i = 0; i < num_objects; ++i) {
+      packs.put("hash_" + std::to_string(i), content.data(), content.size());
+    }
+    for (int i = 0; i < num_objects; i += 2) {
+      packs.remove("hash_" + std::to_string(i));
+    }
+    std::thread compactor([&packs]() { packs.compact(); });
+    std::string replaced(500, 'r');
+    for (int i = 1; i < num_objects; i += 2) {
+      packs.put("hash_" + std::to_string(i), replaced.data(), replaced.size());
+      EXPECT_EQ(packs.read("hash_" + std::to_string(i)).size(), replaced.size());
+    }
+    compactor.join();
+    EXPECT_EQ(packs.object_count(), static_cast<size_t>(num_objects / 2));
+  }
+  {
+    PackStore packs(pack_dir);
+    for (int i = 1; i < num_objects; i += 2) {
+      std::vector<char> data = packs.read("hash_" + std::to_string(i));
+      EXPECT_EQ(std::string(data.begin(), data.end()), std::string(500, 'r'));
+    }
+    EXPECT_FALSE(packs.contains("hash_0"));
+  }
+  std::filesystem::remove_all(pack_dir);
+}
+
+TEST_F(StoreTest, RangeReads) {
+  std::string data;
+  for (int i = 0; i < 20000; ++i) {
+    data += "line " + std::to_string(i) + "\n";
+  }
+  auto read_range = [this](const std::string& key, std::uintmax_t offset, std::uintmax_t length) {
+    std::stringstream output;
+    std::uintmax_t written = store->get_range(key, offset, length, output);
+    EXPECT_EQ(written, output.str().size());
+    return output.str();
+  };
+
+  // Test ranges of a raw object, including ranges clamped at the end
+  store_and_verify("raw_key", data);
+  EXPECT_EQ(read_range("raw_key", 0, 10), data.substr(0, 10));
+  EXPECT_EQ(read_range("raw_key", 12345, 5000), data.substr(12345, 5000));
+  EXPECT_EQ(read_range("raw_key", data.size() - 7, 100), data.substr(data.size() - 7));
+  EXPECT_EQ(read_range("raw_key", data.size(), 100), "");
+  std::stringstream output;
+  EXPECT_THROW(store->get_range("raw_key", data.size() + 1, 1, output), StoreError);
+
+  // Test ranges spanning several chunks of a chunked object
+  store->set_chunking(true);
+  store_and_verify("chunked_key", data);
+  EXPECT_EQ(read_range("chunked_key", 1000, 50000), data.substr(1000, 50000));
+  EXPECT_EQ(read_range("chunked_key", data.size() - 3000, 3000), data.substr(data.size() - 3000));
+
+  // Test ranges of a packed object
+  store->set_packing(true);
+  store_and_verify("packed_key", "Small packed content");
+  EXPECT_EQ(read_range("packed_key", 6, 6), "packed");
+
+  EXPECT_THROW(store->get_range("missing_key", 0, 1, output), StoreError);
+}
+
+TEST_F(StoreTest, ObjectCaching) {
+  // Test repeated reads are served from the cache
+  store_and_verify("cached_key", "Cached content");
+  CacheStats before = store->get_cache_stats();
+  for (int i = 0; i < 5; ++i) {
+    std::stringstream output;
+    store->get("cached_key", output);
+    EXPECT_EQ(output.str(), "Cached content");
+  }
+  CacheStats after = store->get_cache_stats();
+  EXPECT_GE(after.hits - before.hits, 5u);
+  EXPECT_GE(after.entries, 1u);
+
+  // Test writes and removes invalidate cached objects
+  store_and_verify("cached_key", "Updated content");
+  std::stringstream range;
+  store->get_range("cached_key", 0, 7, range);
+  EXPECT_EQ(range.str(), "Updated");
+  store->remove("cached_key");
+  expect_retrieval_fails("cached_key");
+
+  // Test a small budget evicts or rejects entries and stays within bounds
+  const std::size_t capacity = 16 * 1024;
+  store->set_cache_capacity(capacity);
+  for (int i = 0; i < 64; ++i) {
+    store_and_verify("bulk_key_" + std::to_string(i), std::string(512, static_cast<char>('a' + i % 26)));
+  }
+  CacheStats bounded = store->get_cache_stats();
+  EXPECT_LE(bounded.bytes, capacity);
+  EXPECT_GT(bounded.evictions + bounded.rejections, 0u);
+
+  // Test a disabled cache never serves hits
+  store->set_cache_capacity(0);
+  EXPECT_EQ(store->get_cache_stats().entries, 0u);
+  uint64_t hits = store->get_cache_stats().hits;
+  std::stringstream output;
+  store->get("bulk_key_1", output);
+  store->get("bulk_key_1", output);
+  EXPECT_EQ(store->get_cache_stats().hits, hits);
+}
+
+TEST_F(StoreTest, AsyncIoBackend) {
+  if (!IoRing::is_supported()) {
+    GTEST_SKIP() << "io_uring is not available on this kernel";
+  }
+  store->set_io_backend(IoBackend::Uring);
+  ASSERT_EQ(store->get_io_backend(), IoBackend::Uring);
+  store->set_cache_capacity(0);
+
+  // Test streamed writes spanning several ring buffers round-trip intact
+  std::string large(3 * 1024 * 1024 + 123, '\0');
+  for (size_t i = 0; i < large.size(); ++i) {
+    large[i] = static_cast<char>((i * 31 + i / 7) & 0xFF);
+  }
+  store_and_verify("async_large", large);
+  EXPECT_GT(store->get_io_ring()->get_submitted_count(), 0u);
+
+  // Test many concurrent reads are in flight on one ring
+  const size_t num_objects = 64;
+  for (size_t i = 0; i < num_objects; ++i) {
+    std::stringstream input("Async object " + std::to_string(i));
+    store->store("async_" + std::to_string(i), input);
+  }
+  std::vector<std::future<ObjectViewPtr>> reads;
+  for (size_t i = 0; i < num_objects; ++i) {
+    reads.push_back(store->read_async("async_" + std::to_string(i)));
+  }
+  reads.push_back(store->read_async("async_large"));
+  for (size_t i = 0; i < num_objects; ++i) {
+    ObjectViewPtr view = reads[i].get();
+    EXPECT_EQ(std::string(view->bytes().data(), view->size()), "Async object " + std::to_string(i));
+  }
+  ObjectViewPtr large_view = reads.back().get();
+  EXPECT_EQ(std::string(large_view->bytes().data(), large_view->size()), large);
+
+  // Test a missing key fails through the future
+  auto missing = store->read_async("async_missing");
+  EXPECT_THROW(missing.get(), StoreError);
+
+  // Test other layouts and the blocking backend complete before returning
+  store->set_packing(true);
+  store_and_verify("async_packed", "Packed data");
+  EXPECT_EQ(store->read_async("async_packed").get()->size(), 11u);
+  store->set_io_backend(IoBackend::Blocking);
+  EXPECT_EQ(store->get_io_ring(), nullptr);
+  ObjectViewPtr blocking = store->read_async("async_large").get();
+  EXPECT_EQ(blocking->size(), large.size());
+}
+
+TEST_F(StoreTest, StreamingWriter) {
+  std::string data(1024 * 1024 + 17, '\0');
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = static_cast<char>((i * 13) & 0xFF);
+  }
+
+  // Test appended buffers are invisible until the writer commits
+  store_and_verify("stream_key", "Old content");
+  auto writer = store->open_writer("stream_key", 2 * data.size());
+  for (size_t offset = 0; offset < data.size(); offset += 100000) {
+    writer->append(data.data() + offset, std::min<size_t>(100000, data.size() - offset));
+  }
+  EXPECT_EQ(writer->bytes_written(), data.size());
+  std::stringstream before;
+  store->get("stream_key", before);
+  EXPECT_EQ(before.str(), "Old content");
+
+  // Test commit publishes the data and trims the overestimated preallocation
+  writer->commit();
+  std::stringstream after;
+  store->get("stream_key", after);
+  EXPECT_EQ(after.str(), data);
+  EXPECT_EQ(store->get_file_size("stream_key"), data.size());
+  EXPECT_THROW(writer->append("x", 1), StoreError);
+
+  // Test a writer dropped without commit leaves the key and no temp files behind
+  {
+    auto discarded = store->open_writer("stream_key", 64);
+    discarded->append("Discarded", 9);
+  }
+  std::stringstream kept;
+  store->get("stream_key", kept);
+  EXPECT_EQ(kept.str(), data);
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(test_dir)) {
+    EXPECT_EQ(entry.path().filename().string().find(".tmp."), std::string::npos);
+  }
+
+  // Test streaming over a packed object replaces its packed copy
+  store->set_packing(true);
+  store_and_verify("stream_packed", "Small packed");
+  std::stringstream input(data);
+  auto replacing = store->open_writer("stream_packed", data.size());
+  replacing->append(input);
+  replacing->commit();
+  std::stringstream replaced;
+  store->get("stream_packed", replaced);
+  EXPECT_EQ(replaced.str(), data);
+  EXPECT_EQ(store->get_pack_store()->object_count(), 0u);
+}
+
+TEST_F(StoreTest, StartupScan) {
+  for (int i = 0; i < 50; ++i) {
+    store_and_verify("scan_key_" + std::to_string(i), "Scan data " + std::to_string(i));
+  }
+  store->set_packing(true);
+  store_and_verify("scan_packed", "Packed");
+
+  // Test a clean tree reports every object and nothing to repair
+  ScanReport clean = store->scan(false);
+  EXPECT_EQ(clean.objects, 50u);
+  EXPECT_EQ(clean.object_hashes.size(), 50u);
+  EXPECT_EQ(clean.dangling_entries, 0u);
+  EXPECT_EQ(clean.unindexed_objects, 0u);
+  EXPECT_TRUE(clean.orphaned_temp_files.empty());
+  EXPECT_GT(clean.objects_per_second(), 0.0);
+
+  // Damage the tree behind the store's back
+  std::filesystem::path victim = std::filesystem::path(test_dir) / clean.object_hashes[0].substr(0, 2) /
+                                 clean.object_hashes[0].substr(2, 2) / clean.object_hashes[0].substr(4, 2) /
+                                 clean.object_hashes[0].substr(6);
+  std::filesystem::remove(victim);
+  std::filesystem::path fanout = std::filesystem::path(test_dir) / "zz" / "zz" / "zz";
+  std::filesystem::create_directories(fanout);
+  std::filesystem::path orphan = fanout.parent_path() / "object.tmp.999999999.0";
+  std::ofstream(orphan) << "partial";
+  std::filesystem::path live = fanout.parent_path() / ("object.tmp." + std::to_string(::getpid()) + ".0");
+  std::ofstream(live) << "in progress";
+
+  ScanReport damaged = store->scan(false);
+  EXPECT_EQ(damaged.objects, 49u);
+  EXPECT_EQ(damaged.dangling_entries, 1u);
+  EXPECT_EQ(damaged.temp_files.size(), 2u);
+  ASSERT_EQ(damaged.orphaned_temp_files.size(), 1u);
+  EXPECT_EQ(damaged.orphaned_temp_files[0], orphan);
+  EXPECT_EQ(damaged.empty_directories.size(), 2u);  // The victim's directory and zz/zz/zz
+
+  // Test a plain reopen leaves the tree alone
+  store.reset();
+  store = std::make_unique<Store>(test_dir);
+  EXPECT_TRUE(std::filesystem::exists(orphan));
+
+  // Test reopening the store with a startup scan repairs the tree
+  store.reset();
+  store = std::make_unique<Store>(test_dir, true);
+  EXPECT_FALSE(std::filesystem::exists(orphan));
+  EXPECT_TRUE(std::filesystem::exists(live));
+  EXPECT_FALSE(std::filesystem::exists(fanout));
+  EXPECT_FALSE(std::filesystem::exists(victim.parent_path()));
+  ScanReport repaired = store->scan(false);
+  EXPECT_EQ(repaired.dangling_entries, 0u);
+  EXPECT_TRUE(repaired.empty_directories.empty());
+  EXPECT_EQ(store->get_file_size("scan_packed"), 6u);
+  std::filesystem::remove(live);
+
+  // Test objects unknown to the index stay reachable with or without a startup scan
+  store.reset();
+  std::filesystem::remove(std::filesystem::path(test_dir) / StoreIndex::SNAPSHOT_FILENAME);
+  std::filesystem::remove(std::filesystem::path(test_dir) / StoreIndex::JOURNAL_FILENAME);
+  store = std::make_unique<Store>(test_dir);
+  store = std::make_unique<Store>(test_dir);
+  EXPECT_TRUE(store->has("scan_key_10"));
+  store.reset();
+  store = std::make_unique<Store>(test_dir, true);
+  store = std::make_unique<Store>(test_dir);
+  EXPECT_TRUE(store->has("scan_key_20"));
+}
+
+TEST_F(StoreTest, ReplicaEviction) {
+  const std::string local_data(4096, 'L');
+  const std::string replica_data(1024, 'R');
+  store_and_verify("local_key", local_data);
+
+  // Test replicas are tagged and counted against the budget
+  for (int i = 0; i < 8; ++i) {
+    std::stringstream input(replica_data);
+    store->store("replica_" + std::to_string(i), input, ObjectOrigin::Replica);
+  }
+  EXPECT_EQ(store->get_used_bytes(), local_data.size() + 8 * replica_data.size());
+
+  // Make some replicas hot, a local copy of a replica key makes it local
+  for (int round = 0; round < 5; ++round) {
+    for (int i : {1, 3, 5}) {
+      std::stringstream output;
+      store->get("replica_" + std::to_string(i), output);
+    }
+  }
+  store_and_verify("replica_7", replica_data);
+
+  // Test shrinking the budget evicts cold replicas only
+  const uint64_t capacity = 10 * 1024;
+  store->set_capacity(capacity);
+  EXPECT_LE(store->get_used_bytes(), capacity);
+  EXPECT_GT(store->get_eviction_count(), 0u);
+  EXPECT_TRUE(store->has("local_key"));
+  EXPECT_TRUE(store->has("replica_7"));
+  for (int i : {1, 3, 5}) {
+    EXPECT_TRUE(store->has("replica_" + std::to_string(i)));
+  }
+  EXPECT_FALSE(store->has("replica_0"));
+
+  // Test storing past the budget keeps usage bounded
+  for (int i = 8; i < 20; ++i) {
+    std::stringstream input(replica_data);
+    store->store("replica_" + std::to_string(i), input, ObjectOrigin::Replica);
+    EXPECT_LE(store->get_used_bytes(), capacity);
+  }
+  std::stringstream local;
+  store->get("local_key", local);
+  EXPECT_EQ(local.str(), local_data);
+
+  // Test local data is never evicted, even over budget
+  store->set_capacity(1024);
+  EXPECT_TRUE(store->has("local_key"));
+  EXPECT_TRUE(store->has("replica_7"));
+  EXPECT_EQ(store->get_used_bytes(), local_data.size() + replica_data.size());
+}
+
+TEST_F(StoreTest, FilenameCatalog) {
+  for (int i = 0; i < 25; ++i) {
+    char name[32];
+    std::snprintf(name, sizeof(name), "docs/report_%02d.txt", i);
+    store_and_verify(name, "Report " + std::to_string(i));
+  }
+  store_and_verify("images/logo.png", "PNG");
+  store_and_verify("docs_archive", "Archive");
+
+  // Test paging through a prefix returns every name once, in sorted order
+  std::vector<std::string> names;
+  std::string cursor;
+  int pages = 0;
+  do {
+    ListPage page = store->list("docs/", cursor, 10);
+    EXPECT_LE(page.entries.size(), 10u);
+    for (const auto& entry : page.entries) {
+      names.push_back(entry.name);
+      EXPECT_EQ(entry.size, store->get_file_size(entry.name));
+      EXPECT_GT(entry.mtime, 0);
+    }
+    cursor = page.next_cursor;
+    pages++;
+  } while (!cursor.empty());
+  EXPECT_EQ(pages, 3);
+  ASSERT_EQ(names.size(), 25u);
+  EXPECT_TRUE(std::is_sorted(names.begin(), names.end()));
+  EXPECT_EQ(names.front(), "docs/report_00.txt");
+  EXPECT_EQ(names.back(), "docs/report_24.txt");
+
+  // Test an empty prefix lists the whole namespace
+  ListPage all = store->list("");
+  EXPECT_EQ(all.entries.size(), 27u);
+  EXPECT_TRUE(all.next_cursor.empty());
+  EXPECT_TRUE(store->list("videos/").entries.empty());
+
+  // Test removed names leave the catalog and it survives a restart
+  store->remove("docs/report_00.txt");
+  store.reset();
+  store = std::make_unique<Store>(test_dir);
+  ListPage reopened = store->list("docs/", "", 1);
+  ASSERT_EQ(reopened.entries.size(), 1u);
+  EXPECT_EQ(reopened.entries[0].name, "docs/report_01.txt");
+  EXPECT_EQ(reopened.next_cursor, "docs/report_01.txt");
+  EXPECT_EQ(store->list("docs").entries.size(), 25u);
+}
+
+TEST_F(StoreTest, BackgroundDeletion) {
+  store->set_reclaim_interval(std::chrono::milliseconds(1));
+  for (int i = 0; i < 300; ++i) {
+    store_and_verify("delete_key_" + std::to_string(i), "Delete me " + std::to_string(i));
+  }
+
+  // Test deleted names disappear as soon as the call returns
+  for (int i = 0; i < 300; ++i) {
+    store->delete_file("delete_key_" + std::to_string(i));
+    EXPECT_FALSE(store->has("delete_key_" + std::to_string(i)));
+  }
+  EXPECT_THROW(store->delete_file("delete_key_0"), StoreError);
+
+  // Test the reclaimer unlinks every file and prunes the emptied fan-out tree
+  store->flush_deletes();
+  EXPECT_EQ(store->get_pending_deletes(), 0u);
+  std::filesystem::path trash = std::filesystem::path(test_dir) / ".trash";
+  EXPECT_TRUE(std::filesystem::is_empty(trash));
+  for (const auto& entry : std::filesystem::directory_iterator(test_dir)) {
+    EXPECT_FALSE(entry.is_directory() && entry.path() != trash) << entry.path();
+  }
+
+  // Test clearing returns before the old tree is gone and new writes are unaffected
+  for (int i = 0; i < 50; ++i) {
+    store_and_verify("clear_key_" + std::to_string(i), "Cleared " + std::to_string(i));
+  }
+  store->clear();
+  EXPECT_FALSE(store->has("clear_key_0"));
+  store_and_verify("after_clear", "Fresh data");
+  store->flush_deletes();
+  EXPECT_TRUE(std::filesystem::is_empty(trash));
+  std::stringstream fresh;
+  store->get("after_clear", fresh);
+  EXPECT_EQ(fresh.str(), "Fresh data");
+
+  // Test tombstones left behind at shutdown are reclaimed after a restart
+  std::filesystem::create_directories(trash / "leftover" / "ab");
+  std::ofstream(trash / "leftover" / "ab" / "object") << "stale";
+  store.reset();
+  store = std::make_unique<Store>(test_dir);
+  store->flush_deletes();
+  EXPECT_FALSE(std::filesystem::exists(trash / "leftover"));
+  EXPECT_TRUE(store->has("after_clear"));
+}
+
+TEST_F(StoreTest, MultipleVolumes) {
+  std::vector<std::string> disks = {test_dir + "_disk1", test_dir + "_disk2"};
+  for (const auto& disk : disks) {
+    store->add_volume(disk);
+  }
+  ASSERT_EQ(store->get_volumes().size(), 3u);
+  EXPECT_EQ(store->get_volumes()[0], std::filesystem::path(test_dir));
+  EXPECT_THROW(store->add_volume(disks[0]), StoreError);
+
+  // Test objects are spread over every volume and read back
+  for (int i = 0; i < 300; ++i) {
+    store_and_verify("volume_key_" + std::to_string(i), "Volume data " + std::to_string(i));
+  }
+  ScanReport report = store->scan(false);
+  EXPECT_EQ(report.objects, 300u);
+  EXPECT_EQ(report.dangling_entries, 0u);
+  EXPECT_EQ(report.unindexed_objects, 0u);
+  std::vector<size_t> per_volume(3);
+  for (uint32_t volume : report.object_volumes) {
+    per_volume[volume]++;
+  }
+  for (size_t count : per_volume) {
+    EXPECT_GT(count, 0u);
+  }
+
+  // Test overwrites and streamed objects keep a single copy
+  store_and_verify("volume_key_0", "Rewritten");
+  auto writer = store->open_writer("volume_stream", 6);
+  writer->append("Stream", 6);
+  writer->commit();
+  EXPECT_EQ(store->scan(false).objects, 301u);
+
+  // Test deletes reclaim files on their own volume
+  for (int i = 0; i < 100; ++i) {
+    store->delete_file("volume_key_" + std::to_string(i));
+  }
+  store->flush_deletes();
+  EXPECT_EQ(store->scan(false).objects, 201u);
+
+  // Test the volumes are reopened with the store
+  store.reset();
+  store = std::make_unique<Store>(test_dir);
+  ASSERT_EQ(store->get_volumes().size(), 3u);
+  for (int i = 100; i < 300; ++i) {
+    std::stringstream output;
+    store->get("volume_key_" + std::to_string(i), output);
+    EXPECT_EQ(output.str(), "Volume data " + std::to_string(i));
+  }
+  std::stringstream streamed;
+  store->get("volume_stream", streamed);
+  EXPECT_EQ(streamed.str(), "Stream");
+
+  // Test removes find objects on every volume once the index files are lost
+  store.reset();
+  std::filesystem::remove(std::filesystem::path(test_dir) / StoreIndex::SNAPSHOT_FILENAME);
+  std::filesystem::remove(std::filesystem::path(test_dir) / StoreIndex::JOURNAL_FILENAME);
+  store = std::make_unique<Store>(test_dir);
+  for (int i = 100; i < 300; ++i) {
+    store->remove("volume_key_" + std::to_string(i));
+  }
+  store->flush_deletes();
+  EXPECT_EQ(store->scan(false).objects, 1u);
+
+  store.reset();
+  for (const auto& disk : disks) {
+    std::filesystem::remove_all(disk);
+  }
+}
+
+TEST_F(StoreTest, TieredStorage) {
+  std::string slow_disk = test_dir + "_slow";
+  store->add_volume(slow_disk, StorageTier::Slow);
+  ASSERT_EQ(store->get_volume_tier(1), StorageTier::Slow);
+  std::string payload(1000, 'x');
+
+  // Test new objects are placed on the fast tier only
+  for (int i = 0; i < 20; ++i) {
+    store_and_verify("tier_key_" + std::to_string(i), payload + std::to_string(i));
+  }
+  EXPECT_EQ(store->get_tier_bytes(StorageTier::Slow), 0u);
+  EXPECT_EQ(store->migrate_cold_objects(), 0u);
+
+  // Test cold objects are demoted until the fast tier is under its low water mark
+  for (int round = 0; round < 5; ++round) {
+    std::stringstream output;
+    store->get("tier_key_3", output);
+  }
+  TieringPolicy policy;
+  policy.fast_capacity = 10000;
+  policy.low_water = 0.5;
+  policy.min_age = std::chrono::seconds(0);
+  policy.interval = std::chrono::hours(1);
+  store->set_tiering(policy);
+  EXPECT_GT(store->migrate_cold_objects(), 0u);
+  EXPECT_LE(store->get_tier_bytes(StorageTier::Fast), 5000u);
+  EXPECT_EQ(store->get_tier(std::string("tier_key_3")), StorageTier::Fast);
+
+  // Test demoted objects leave a single copy on the slow volume and read back
+  store->flush_deletes();
+  ScanReport report = store->scan(false);
+  EXPECT_EQ(report.objects, 20u);
+  EXPECT_EQ(static_cast<uint64_t>(std::count(report.object_volumes.begin(), report.object_volumes.end(), 1u)),
+            store->get_demotion_count());
+  for (int i = 0; i < 20; ++i) {
+    std::stringstream output;
+    store->get("tier_key_" + std::to_string(i), output);
+    EXPECT_EQ(output.str(), payload + std::to_string(i));
+  }
+
+  // Test an overwrite brings a demoted object back to the fast tier
+  ASSERT_EQ(store->get_tier(std::string("tier_key_0")), StorageTier::Slow);
+  store_and_verify("tier_key_0", "Rewritten");
+  EXPECT_EQ(store->get_tier(std::string("tier_key_0")), StorageTier::Fast);
+  store->flush_deletes();
+  EXPECT_EQ(store->scan(false).objects, 20u);
+
+  // Test a slow object read often enough is promoted while the fast tier has room
+  std::string hot_key;
+  for (int i = 1; i < 20 && hot_key.empty(); ++i) {
+    if (store->get_tier("tier_key_" + std::to_string(i)) == StorageTier::Slow) {
+      hot_key = "tier_key_" + std::to_string(i);
+    }
+  }
+  ASSERT_FALSE(hot_key.empty());
+  store->set_cache_capacity(0);
+  for (uint32_t round = 0; round <= policy.promote_score; ++round) {
+    std::stringstream output;
+    store->get(hot_key, output);
+  }
+  store->migrate_cold_objects();
+  EXPECT_EQ(store->get_tier(hot_key), StorageTier::Fast);
+  EXPECT_EQ(store->get_promotion_count(), 1u);
+  EXPECT_LE(store->get_tier_bytes(StorageTier::Fast), policy.fast_capacity);
+  std::stringstream promoted;
+  store->get(hot_key, promoted);
+  EXPECT_EQ(promoted.str(), payload + hot_key.substr(std::string("tier_key_").size()));
+
+  // Test the background migrator demotes without being asked
+  policy.fast_capacity = 1;
+  policy.low_water = 0;
+  policy.interval = std::chrono::milliseconds(10);
+  store->set_tiering(policy);
+  for (int attempt = 0; attempt < 500 && store->get_tier_bytes(StorageTier::Fast) > 0; ++attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_EQ(store->get_tier_bytes(StorageTier::Fast), 0u);
+  policy.fast_capacity = 0;
+  store->set_tiering(policy);
+
+  // Test tiers are reopened with the store
+  store.reset();
+  store = std::make_unique<Store>(test_dir);
+  EXPECT_EQ(store->get_volume_tier(1), StorageTier::Slow);
+  EXPECT_EQ(store->get_tier(std::string("tier_key_3")), StorageTier::Slow);
+  std::stringstream output;
+  store->get("tier_key_3", output);
+  EXPECT_EQ(output.str(), payload + "3");
+
+  store.reset();
+  std::filesystem::remove_all(slow_disk);
+}
+
+TEST_F(StoreTest, IoScheduling) {
+  // Queues one request per class behind a held slot and records admission order
+  auto admission_order = [](IoScheduler& scheduler, const std::vector<IoClass>& classes) {
+    auto held = scheduler.acquire(IoClass::Background, 0);
+    std::vector<IoClass> order;
+    std::mutex order_mutex;
+    std::vector<std::thread> threads;
+    for (IoClass io_class : classes) {
+      threads.emplace_back([&, io_class] {
+        auto grant = scheduler.acquire(io_class, 0);
+        std::lock_guard<std::mutex> lock(order_mutex);
+        order.push_back(io_class);
+      });
+      while (scheduler.get_queued() < threads.size()) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+      }
+    }
+    held.release();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+    return order;
+  };
+
+  // Test queued requests are admitted by priority class
+  IoScheduler priority(1);
+  std::vector<IoClass> expected = {IoClass::Foreground, IoClass::Replication, IoClass::Background};
+  EXPECT_EQ(admission_order(priority, {IoClass::Background, IoClass::Replication, IoClass::Foreground}), expected);
+  EXPECT_EQ(priority.get_in_flight(), 0u);
+
+  // Test a request past its deadline overtakes higher classes
+  IoScheduler deadline(1);
+  IoBudget overdue = deadline.get_budget(IoClass::Background);
+  overdue.deadline = std::chrono::microseconds(0);
+  deadline.set_budget(IoClass::Background, overdue);
+  expected = {IoClass::Background, IoClass::Foreground};
+  EXPECT_EQ(admission_order(deadline, {IoClass::Background, IoClass::Foreground}), expected);
+  EXPECT_GT(deadline.get_stats(IoClass::Background).deadline_misses, 0u);
+
+  // Test a bandwidth budget delays its own class but not foreground requests
+  IoScheduler budgeted;
+  IoBudget replication = budgeted.get_budget(IoClass::Replication);
+  replication.bytes_per_second = 100000;
+  budgeted.set_budget(IoClass::Replication, replication);
+  budgeted.acquire(IoClass::Replication, 150000);
+  auto start = std::chrono::steady_clock::now();
+  budgeted.acquire(IoClass::Foreground, 150000);
+  EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(100));
+  budgeted.acquire(IoClass::Replication, 1);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(400));
+
+  // Test Store I/O is classified by origin and background work is admitted too
+  store_and_verify("local_key", "Local data");
+  store->store("replica_key", *create_test_stream("Replica data"), ObjectOrigin::Replica);
+  store->delete_file("replica_key");
+  store->flush_deletes();
+  const IoScheduler& scheduler = store->get_io_scheduler();
+  EXPECT_GT(scheduler.get_stats(IoClass::Foreground).operations, 0u);
+  EXPECT_EQ(scheduler.get_stats(IoClass::Replication).bytes, 12u);
+  EXPECT_GT(scheduler.get_stats(IoClass::Background).operations, 0u);
+  EXPECT_EQ(scheduler.get_in_flight(), 0u);
+}
+
+TEST_F(StoreTest, CompressedStorage) {
+  // Test the codec round trips runs, short inputs and rejects corrupt blocks
+  std::vector<std::string> samples = {"", "abc", std::string(100000, 'a'), "abcabcabcabcabcabcabcabcabcabcxyz"};
+  for (const auto& sample : samples) {
+    std::vector<char> packed(LzCodec::max_compressed_size(sample.size()));
+    size_t packed_size = LzCodec::compress(sample.data(), sample.size(), packed.data(), packed.size());
+    ASSERT_GT(packed_size, 0u);
+    std::vector<char> unpacked(sample.size());
+    ASSERT_TRUE(LzCodec::decompress(packed.data(), packed_size, unpacked.data(), unpacked.size()));
+    EXPECT_EQ(std::string(unpacked.begin(), unpacked.end()), sample);
+  }
+  std::vector<char> unpacked(10);
+  EXPECT_FALSE(LzCodec::decompress("\x0f\x01", 2, unpacked.data(), unpacked.size()));
+
+  // Test compressible text is stored smaller and read back whole
+  store->set_compression(true);
+  std::string text;
+  for (int i = 0; text.size() < 500000; ++i) {
+    text += "{\"id\": " + std::to_string(i) + ", \"name\": \"object\", \"tags\": [\"log\", \"json\"]}\n";
+  }
+  store_and_verify("text_key", text);
+  CompressionStats stats = store->get_compression_stats();
+  EXPECT_EQ(stats.compressed_objects, 1u);
+  EXPECT_EQ(stats.input_bytes, text.size());
+  EXPECT_LT(stats.stored_bytes, text.size() / 2);
+  EXPECT_EQ(store->get_file_size("text_key"), text.size());
+
+  // Test range reads within and across blocks
+  std::vector<std::pair<std::uintmax_t, std::uintmax_t>> ranges = {
+    {0, 10}, {65530, 20}, {100000, 200000}, {text.size() - 5, 100}, {text.size(), 10}};
+  for (const auto& [offset, length] : ranges) {
+    std::stringstream output;
+    EXPECT_EQ(store->get_range("text_key", offset, length, output), std::min(length, text.size() - offset));
+    EXPECT_EQ(output.str(), text.substr(offset, length));
+  }
+  std::stringstream output;
+  EXPECT_THROW(store->get_range("text_key", text.size() + 1, 1, output), StoreError);
+
+  // Test incompressible data is detected from its first blocks and stored raw
+  std::string noise(300000, '\0');
+  uint64_t state = 88172645463325252ull;
+  for (auto& byte : noise) {
+    state ^= state << 13;
+    state ^= state >> 7;
+    state ^= state << 17;
+    byte = static_cast<char>(state);
+  }
+  store_and_verify("noise_key", noise);
+  stats = store->get_compression_stats();
+  EXPECT_EQ(stats.compressed_objects, 1u);
+  EXPECT_EQ(stats.incompressible_objects, 1u);
+
+  // Test raw content starting with the compressed header is served unchanged,
+  // also once the index files are lost and the object is found on disk again
+  store->set_compression(false);
+  std::string lookalike = std::string("\0DFS-COMPRESS 1\n", 16) + std::string(64, 'L');
+  store_and_verify("lookalike_key", lookalike);
+  store.reset();
+  std::filesystem::remove(std::filesystem::path(test_dir) / StoreIndex::SNAPSHOT_FILENAME);
+  std::filesystem::remove(std::filesystem::path(test_dir) / StoreIndex::JOURNAL_FILENAME);
+  store = std::make_unique<Store>(test_dir);
+  EXPECT_EQ(store->get_file_size("lookalike_key"), lookalike.size());
+  std::stringstream reopened;
+  store->get("lookalike_key", reopened);
+  EXPECT_EQ(reopened.str(), lookalike);
+  std::stringstream range;
+  store->get_range("noise_key", 1000, 10, range);
+  EXPECT_EQ(range.str(), noise.substr(1000, 10));
+}
+
+TEST_F(StoreTest, IntegrityScrubbing) {
+  // Flips one byte of the object file holding content, which must be stored raw
+  auto corrupt_object_file = [this](const std::string& content) {
+    for (const auto& entry : std::filesystem::recursive_directory_iterator(test_dir)) {
+      if (!entry.is_regular_file() || entry.file_size() != content.size()) {
+        continue;
+      }
+      std::fstream file(entry.path(), std::ios::in | std::ios::out | std::ios::binary);
+      std::string existing(content.size(), '\0');
+      file.read(existing.data(), existing.size());
+      if (existing == content) {
+        file.seekp(content.size() / 2);
+        file.put(static_cast<char>(content[content.size() / 2] ^ 0x01));
+        return true;
+      }
+    }
+    return false;
+  };
+
+  // Test CRC-32C matches the standard check value and chains across calls
+  const std::string check = "123456789";
+  EXPECT_EQ(Crc32c::compute(check.data(), check.size()), 0xE3069283u);
+  EXPECT_EQ(Crc32c::update(Crc32c::compute(check.data(), 4), check.data() + 4, 5), 0xE3069283u);
+  EXPECT_EQ(Crc32c::compute(nullptr, 0), 0u);
+
+  // Test every write path records the content checksum, and it survives a reopen
+  store->set_cache_capacity(0);
+  std::string payload(10000, 'p');
+  for (int i = 0; i < 3; ++i) {
+    payload[0] = static_cast<char>('0' + i);
+    store_and_verify("paced_key_" + std::to_string(i), payload);
+  }
+  EXPECT_EQ(store->get_checksum("paced_key_2"), Crc32c::compute(payload.data(), payload.size()));
+  store->set_chunking(true);
+  store_and_verify("chunked_key", payload);
+  store->set_chunking(false);
+  EXPECT_EQ(store->get_checksum("chunked_key"), store->get_checksum("paced_key_2"));
+  auto writer = store->open_writer("streamed_key", payload.size());
+  writer->append(payload.data(), payload.size());
+  writer->commit();
+  EXPECT_EQ(store->get_checksum("streamed_key"), store->get_checksum("paced_key_2"));
+  store.reset();
+  store = std::make_unique<Store>(test_dir);
+  store->set_cache_capacity(0);
+  EXPECT_EQ(store->get_checksum("paced_key_2"), Crc32c::compute(payload.data(), payload.size()));
+  EXPECT_FALSE(store->get_checksum("missing_key").has_value());
+
+  // Test a scrub pass is paced to the policy's rate and finds intact objects clean
+  ScrubPolicy policy;
+  policy.bytes_per_second = 100000;
+  store->set_scrubbing(policy);
+  auto start = std::chrono::steady_clock::now();
+  EXPECT_EQ(store->scrub_objects(), 0u);
+  EXPECT_GE(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(400));
+  ScrubStats stats = store->get_scrub_stats();
+  EXPECT_EQ(stats.passes, 1u);
+  EXPECT_EQ(stats.objects, 5u);
+  EXPECT_EQ(stats.bytes, 5 * payload.size());
+
+  // Test verified reads refuse corrupt content that plain reads would serve
+  std::string local = "Local content that rots on disk";
+  store_and_verify("local_key", local);
+  ASSERT_TRUE(corrupt_object_file(local));
+  std::stringstream unverified;
+  store->get("local_key", unverified);
+  EXPECT_NE(unverified.str(), local);
+  store->set_verify_reads(true);
+  std::stringstream verified;
+  EXPECT_THROW(store->get("local_key", verified), StoreError);
+  EXPECT_EQ(store->get_corrupt_objects(), std::vector<std::string>{"local_key"});
+
+  // Test the scrubber drops corrupt replicas and reports corrupt local objects
+  std::string replica = "Replica content that rots on disk";
+  store->store("replica_key", *create_test_stream(replica), ObjectOrigin::Replica);
+  ASSERT_TRUE(corrupt_object_file(replica));
+  policy.bytes_per_second = 0;
+  store->set_scrubbing(policy);
+  EXPECT_EQ(store->scrub_objects(), 2u);
+  EXPECT_FALSE(store->has("replica_key"));
+  EXPECT_TRUE(store->has("local_key"));
+  std::vector<std::string> expected = {"local_key", "replica_key"};
+  EXPECT_EQ(store->get_corrupt_objects(), expected);
+
+  // Test rewriting an object clears its corruption
+  store_and_verify("local_key", local);
+  EXPECT_EQ(store->get_corrupt_objects(), std::vector<std::string>{"replica_key"});
+
+  // Test an object that cannot be read is reported without ending the pass
+  std::string vanishing = "Vanishing content";
+  store_and_verify("vanishing_key", vanishing);
+  store_and_verify("rotting_key", "Rotting content");
+  ASSERT_TRUE(corrupt_object_file("Rotting content"));
+  for (const auto& entry : std::filesystem::recursive_directory_iterator(test_dir)) {
+    if (entry.is_regular_file() && entry.file_size() == vanishing.size()) {
+      std::filesystem::remove(entry.path());
+      break;
+    }
+  }
+  EXPECT_EQ(store->scrub_objects(), 2u);
+  expected = {"replica_key", "rotting_key", "vanishing_key"};
+  EXPECT_EQ(store->get_corrupt_objects(), expected);
+
+  // Test the background scrubber runs passes without being asked
+  policy.interval = std::chrono::milliseconds(10);
+  store->set_scrubbing(policy);
+  for (int attempt = 0; attempt < 500 && store->get_scrub_stats().passes < 4; ++attempt) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+  }
+  EXPECT_GE(store->get_scrub_stats().passes, 4u);
+  policy.interval = std::chrono::milliseconds(0);
+  store->set_scrubbing(policy);
+}
+
+TEST_F(StoreTest, BulkIngest) {
+  // Builds a source tree of nested directories with empty, small and multi-block files
+  std::filesystem::path source = test_dir + "_source";
+  std::map<std::string, std::string> files;
+  for (int i = 0; i < 40; ++i) {
+    std::string relative = "dir_" + std::to_string(i % 3) + "/sub_" + std::to_string(i % 2) +
+                           "/file_" + std::to_string(i);
+    size_t size = i == 0 ? 0 : (i % 5 == 0 ? 200000 + i : 100 * i);
+    std::string content(size, '\0');
+    for (size_t j = 0; j < size; ++j) {
+      content[j] = static_cast<char>('a' + (i * 7 + j) % 26);
+    }
+    files[relative] = content;
+  }
+  files["top_level"] = "top level file";
+  for (const auto& [relative, content] : files) {
+    std::filesystem::create_directories((source / relative).parent_path());
+    std::ofstream(source / relative, std::ios::binary) << content;
+  }
+
+  // Test a non-directory source is rejected
+  EXPECT_THROW(Ingester(*store, source / "top_level"), StoreError);
+
+  // Test a multi-threaded run stores every file under its relative path
+  store->set_packing(true);
+  IngestOptions options;
+  options.threads = 4;
+  IngestStats stats;
+  {
+    Ingester ingester(*store, source, options);
+    EXPECT_EQ(ingester.get_checkpoint_path(), std::filesystem::path(test_dir) / Ingester::CHECKPOINT_FILENAME);
+    stats = ingester.run();
+    EXPECT_EQ(ingester.get_checkpointed_count(), files.size());
+  }
+  EXPECT_EQ(stats.files, files.size());
+  EXPECT_EQ(stats.skipped, 0u);
+  EXPECT_EQ(stats.failed, 0u);
+  uint64_t total = 0;
+  for (const auto& [relative, content] : files) {
+    std::stringstream output;
+    ASSERT_NO_THROW(store->get(relative, output)) << relative;
+    EXPECT_EQ(output.str(), content) << relative;
+    EXPECT_EQ(store->get_checksum(relative), Crc32c::compute(content.data(), content.size()));
+    total += content.size();
+  }
+  EXPECT_EQ(stats.bytes, total);
+  EXPECT_NE(store->get_pack_store(), nullptr);
+
+  // Test the checkpoint stays out of the object tree
+  ScanReport report = store->scan(false);
+  EXPECT_EQ(report.unindexed_objects, 0u);
+  EXPECT_EQ(report.dangling_entries, 0u);
+
+  // Test a second run over the same tree skips everything
+  stats = Ingester(*store, source, options).run();
+  EXPECT_EQ(stats.files, 0u);
+  EXPECT_EQ(stats.skipped, files.size());
+
+  // Test a resumed run redoes removed objects, changed files and torn records
+  store->remove("dir_1/sub_1/file_1");
+  files["dir_2/sub_0/file_2"] += "appended";
+  std::ofstream(source / "dir_2/sub_0/file_2", std::ios::binary | std::ios::app) << "appended";
+  std::filesystem::path checkpoint = std::filesystem::path(test_dir) / Ingester::CHECKPOINT_FILENAME;
+  std::ofstream(checkpoint, std::ios::binary | std::ios::app) << "dir_0/sub_1/file_3";
+  {
+    Ingester ingester(*store, source, options);
+    EXPECT_EQ(ingester.get_checkpointed_count(), files.size());
+    stats = ingester.run();
+  }
+  EXPECT_EQ(stats.files, 2u);
+  EXPECT_EQ(stats.skipped, files.size() - 2);
+  std::stringstream output;
+  store->get("dir_2/sub_0/file_2", output);
+  EXPECT_EQ(output.str(), files["dir_2/sub_0/file_2"]);
+  EXPECT_TRUE(store->has("dir_1/sub_1/file_1"));
+
+  // Test keys take the prefix and a custom checkpoint path
+  options.prefix = "seed/";
+  options.checkpoint = test_dir + "_checkpoint";
+  options.threads = 1;
+  stats = Ingester(*store, source, options).run();
+  EXPECT_EQ(stats.files, files.size());
+  EXPECT_TRUE(store->has("seed/top_level"));
+  EXPECT_TRUE(std::filesystem::exists(options.checkpoint));
+
+  std::filesystem::remove_all(source);
+  std::filesystem::remove(options.checkpoint);
+}